@@ -0,0 +1,371 @@
+#include "benchmarkrunner.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QSet>
+#include <QTextStream>
+#include <QtDebug>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "morphology.h"
+#include "datatypes/generation.h"
+#include "returns/lexicalsteminsertresult.h"
+#include "nodes/xmlstemlist.h"
+#include "resourceusage.h"
+
+using namespace ME;
+
+BenchmarkRunner::BenchmarkRunner(const BenchmarkWorkload &workload) :
+    mWorkload(workload),
+    mMorphology(nullptr),
+    mRepetitions(1),
+    mSyntheticStems(0),
+    mSyntheticStemsAdded(0),
+    mLoadMs(0)
+{
+    mOperations << Parse << WellFormed << GuessStem << Generate << Transduce;
+}
+
+BenchmarkRunner::~BenchmarkRunner()
+{
+    delete mMorphology;
+}
+
+void BenchmarkRunner::setRepetitions(int repetitions)
+{
+    mRepetitions = qMax( 1, repetitions );
+}
+
+void BenchmarkRunner::setOperations(const QList<Operation> &operations)
+{
+    mOperations = operations;
+}
+
+void BenchmarkRunner::setTransduceTo(const QString &lang)
+{
+    mTransduceTo = lang;
+}
+
+void BenchmarkRunner::setSyntheticStems(int count)
+{
+    mSyntheticStems = count;
+}
+
+bool BenchmarkRunner::load()
+{
+    delete mMorphology;
+    mMorphology = new Morphology;
+
+    QElapsedTimer timer;
+    timer.start();
+    try {
+        mMorphology->readXmlFile( mWorkload.morphologyFile() );
+    } catch (const std::runtime_error &e) {
+        qCritical() << e.what() << "(" << mWorkload.morphologyFile() << ")";
+        return false;
+    }
+    mLoadMs = timer.elapsed();
+
+    if( mSyntheticStems > 0 )
+    {
+        mSyntheticStemsAdded = addSyntheticStems( mSyntheticStems );
+    }
+
+    mForms.clear();
+    mParsings.clear();
+    const QList< QPair<QString,QString> > words = mWorkload.words();
+    for(int i=0; i < words.count(); i++)
+    {
+        const WritingSystem ws = mMorphology->writingSystem( words.at(i).first );
+        if( ws.isNull() )
+        {
+            qWarning() << "BenchmarkRunner::load()" << "Unknown writing system:" << words.at(i).first;
+            continue;
+        }
+        mForms << Form( ws, words.at(i).second );
+    }
+
+    return true;
+}
+
+QJsonObject BenchmarkRunner::run(QTextStream &out)
+{
+    QJsonObject result;
+    result.insert( "label", mWorkload.label() );
+    result.insert( "morphology", mWorkload.morphologyFile() );
+    result.insert( "load_ms", mLoadMs );
+    result.insert( "words", mForms.count() );
+    result.insert( "repetitions", mRepetitions );
+    result.insert( "synthetic_stems", mSyntheticStemsAdded );
+
+    out << QString("%1 [%2]: %3 words, loaded in %4 ms").arg( mWorkload.label(), mWorkload.morphologyFile() ).arg( mForms.count() ).arg( mLoadMs );
+    if( mSyntheticStemsAdded > 0 )
+    {
+        out << QString(", %1 synthetic stems").arg( mSyntheticStemsAdded );
+    }
+    out << Qt::endl;
+
+    QJsonArray operations;
+    foreach( Operation operation, mOperations )
+    {
+        if( operation == Transduce && mTransduceTo.isEmpty() )
+        {
+            continue;
+        }
+        operations.append( time( operation, out ) );
+    }
+    result.insert( "operations", operations );
+
+    return result;
+}
+
+QJsonObject BenchmarkRunner::time(Operation operation, QTextStream &out)
+{
+    if( operation == Generate && mParsings.count() != mForms.count() )
+    {
+        mParsings.clear();
+        foreach( Form f, mForms )
+        {
+            mParsings << mMorphology->possibleParsings( f );
+        }
+    }
+
+    QList<qint64> latencies;
+    latencies.reserve( mForms.count() * mRepetitions );
+    qint64 results = 0;
+
+    const qint64 allocationsBefore = ResourceUsage::allocations();
+    const qint64 bytesBefore = ResourceUsage::allocatedBytes();
+    QElapsedTimer total;
+    total.start();
+    for(int repetition = 0; repetition < mRepetitions; repetition++)
+    {
+        for(int i=0; i < mForms.count(); i++)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            results += perform( operation, i );
+            latencies << timer.nsecsElapsed();
+        }
+    }
+    const qint64 totalNs = total.nsecsElapsed();
+    /// QList's own allocations are reserved beforehand, so these are those of the operation
+    const qint64 allocations = ResourceUsage::allocations() - allocationsBefore;
+    const qint64 bytes = ResourceUsage::allocatedBytes() - bytesBefore;
+
+    std::sort( latencies.begin(), latencies.end() );
+    const int count = latencies.count();
+    const double wordsPerSecond = totalNs > 0 ? count * 1000000000.0 / totalNs : 0.0;
+    const double p50 = percentile( latencies, 0.50 ) / 1000.0;
+    const double p99 = percentile( latencies, 0.99 ) / 1000.0;
+    const qint64 peakRss = ResourceUsage::peakResidentSetKb();
+
+    QJsonObject result;
+    result.insert( "operation", operationName(operation) );
+    result.insert( "calls", count );
+    result.insert( "results", results );
+    result.insert( "total_ms", totalNs / 1000000.0 );
+    result.insert( "words_per_second", wordsPerSecond );
+    result.insert( "p50_us", p50 );
+    result.insert( "p99_us", p99 );
+    result.insert( "allocations", allocations );
+    result.insert( "allocations_per_word", count > 0 ? static_cast<double>(allocations) / count : 0.0 );
+    result.insert( "allocated_bytes", bytes );
+    result.insert( "peak_rss_kb", peakRss );
+
+    out << QString("  %1: %2 words/s, p50 %3 us, p99 %4 us, %5 allocations/word, peak RSS %6 kB")
+           .arg( operationName(operation), -12 )
+           .arg( wordsPerSecond, 0, 'f', 1 )
+           .arg( p50, 0, 'f', 2 )
+           .arg( p99, 0, 'f', 2 )
+           .arg( count > 0 ? static_cast<double>(allocations) / count : 0.0, 0, 'f', 1 )
+           .arg( peakRss ) << Qt::endl;
+
+    return result;
+}
+
+int BenchmarkRunner::perform(Operation operation, int index) const
+{
+    const Form & form = mForms.at(index);
+    switch( operation )
+    {
+    case BenchmarkRunner::Parse:
+        return mMorphology->possibleParsings( form ).count();
+    case BenchmarkRunner::WellFormed:
+        return mMorphology->isWellFormed( form ) ? 1 : 0;
+    case BenchmarkRunner::GuessStem:
+        return mMorphology->guessStem( form ).count();
+    case BenchmarkRunner::Generate:
+    {
+        int count = 0;
+        foreach( Parsing p, mParsings.at(index) )
+        {
+            count += mMorphology->generateForms( form.writingSystem(), p ).count();
+        }
+        return count;
+    }
+    case BenchmarkRunner::Transduce:
+        return mMorphology->transduceInto( form, mMorphology->writingSystem( mTransduceTo ) ).count();
+    }
+    return 0;
+}
+
+QString BenchmarkRunner::operationName(Operation operation)
+{
+    switch( operation )
+    {
+    case BenchmarkRunner::Parse:
+        return "parse";
+    case BenchmarkRunner::WellFormed:
+        return "well-formed";
+    case BenchmarkRunner::GuessStem:
+        return "guess-stem";
+    case BenchmarkRunner::Generate:
+        return "generate";
+    case BenchmarkRunner::Transduce:
+        return "transduce";
+    }
+    return "";
+}
+
+bool BenchmarkRunner::operationFromName(const QString &name, Operation &operation)
+{
+    const QList<Operation> all = QList<Operation>() << Parse << WellFormed << GuessStem << Generate << Transduce;
+    foreach( Operation o, all )
+    {
+        if( operationName(o) == name )
+        {
+            operation = o;
+            return true;
+        }
+    }
+    return false;
+}
+
+QString BenchmarkRunner::syntheticSuffix(int n, const QList<QChar> &alphabet)
+{
+    if( alphabet.isEmpty() )
+    {
+        return QString();
+    }
+    else if( alphabet.count() == 1 )
+    {
+        return QString( n, alphabet.first() );
+    }
+
+    /// n written in the base of the alphabet, so that each copy of a stem is different
+    QString suffix;
+    while( n > 0 )
+    {
+        suffix.prepend( alphabet.at( n % alphabet.count() ) );
+        n /= alphabet.count();
+    }
+    return suffix;
+}
+
+qint64 BenchmarkRunner::percentile(const QList<qint64> &sorted, double fraction)
+{
+    if( sorted.isEmpty() )
+    {
+        return 0;
+    }
+    const int index = qBound( 0, static_cast<int>( fraction * sorted.count() + 0.5 ) - 1, static_cast<int>( sorted.count() ) - 1 );
+    return sorted.at( index );
+}
+
+int BenchmarkRunner::addSyntheticStems(int count)
+{
+    const QSet<AbstractStemList *> stemLists = mMorphology->stemLists();
+    QList<LexicalStem> templates;
+    QHash<WritingSystem, QSet<QChar> > letters;
+    qlonglong nextId = 0;
+    foreach( AbstractStemList * list, stemLists )
+    {
+        if( dynamic_cast<XmlStemList*>( list ) == nullptr )
+        {
+            qWarning() << "BenchmarkRunner::addSyntheticStems()" << "Synthetic stems are only added to models whose stem lists are all XML stem lists, so that no database is changed.";
+            return 0;
+        }
+        foreach( LexicalStem * stem, list->stems() )
+        {
+            templates << *stem;
+            nextId = qMax( nextId, stem->id() + 1 );
+            for(int i=0; i < stem->allomorphCount(); i++)
+            {
+                QHashIterator<WritingSystem,Form> f( stem->allomorph(i).forms() );
+                while( f.hasNext() )
+                {
+                    f.next();
+                    foreach( QChar c, f.value().text() )
+                    {
+                        letters[ f.key() ] << c;
+                    }
+                }
+            }
+        }
+    }
+    if( templates.isEmpty() )
+    {
+        return 0;
+    }
+
+    QHash<WritingSystem, QList<QChar> > alphabets;
+    QHashIterator<WritingSystem, QSet<QChar> > l( letters );
+    while( l.hasNext() )
+    {
+        l.next();
+        QList<QChar> alphabet = l.value().values();
+        std::sort( alphabet.begin(), alphabet.end() );
+        alphabets.insert( l.key(), alphabet );
+    }
+
+    QList<LexicalStem> stems;
+    stems.reserve( count );
+    for(int i=0; i < count; i++)
+    {
+        const LexicalStem & original = templates.at( i % templates.count() );
+        LexicalStem stem( original );
+        stem.setId( nextId + i );
+        for(int j=0; j < original.allomorphCount(); j++)
+        {
+            const Allomorph & a = original.allomorph(j);
+            stem.remove( a );
+            /// derived allomorphs are created again when the stem is inserted
+            if( !a.isOriginal() )
+            {
+                continue;
+            }
+            Allomorph lengthened( a );
+            QHashIterator<WritingSystem,Form> f( a.forms() );
+            while( f.hasNext() )
+            {
+                f.next();
+                lengthened.setForm( Form( f.key(), f.value().text() + syntheticSuffix( i / templates.count() + 1, alphabets.value( f.key() ) ) ) );
+            }
+            stem.insert( lengthened );
+        }
+        stems << stem;
+    }
+
+    /// only the stem lists that accept new stems (accepts-stems="true") take them
+    int added = 0;
+    foreach( LexicalStemInsertResult result, mMorphology->addLexicalStems( stems ) )
+    {
+        if( result.numberOfInsertions() > 0 )
+        {
+            added++;
+        }
+    }
+
+    if( added == 0 )
+    {
+        qWarning() << "BenchmarkRunner::addSyntheticStems()" << "No stem list of" << mWorkload.morphologyFile() << "accepted the synthetic stems. Set accepts-stems=\"true\" on an XML stem list to add them.";
+    }
+    else if( added < stems.count() )
+    {
+        qWarning() << "BenchmarkRunner::addSyntheticStems()" << "Only" << added << "of" << stems.count() << "synthetic stems were accepted by a stem list of" << mWorkload.morphologyFile();
+    }
+    return added;
+}
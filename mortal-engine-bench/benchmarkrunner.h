@@ -0,0 +1,85 @@
+/*!
+  \class BenchmarkRunner
+  \brief Loads the morphology of a BenchmarkWorkload and times each of the main Morphology functions on its words.
+
+  Each word is timed separately, so that the median and 99th percentile latencies can be reported along with the throughput. Allocations and the peak resident set size are taken from ResourceUsage. The results are returned as JSON, so that runs can be compared.
+*/
+
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+
+#include "benchmarkworkload.h"
+#include "datatypes/form.h"
+#include "datatypes/parsing.h"
+
+class QTextStream;
+
+namespace ME {
+
+class Morphology;
+
+class BenchmarkRunner
+{
+public:
+    enum Operation { Parse, WellFormed, GuessStem, Generate, Transduce };
+
+    explicit BenchmarkRunner(const BenchmarkWorkload & workload);
+    ~BenchmarkRunner();
+    BenchmarkRunner(const BenchmarkRunner &) = delete;
+    BenchmarkRunner &operator=(const BenchmarkRunner &) = delete;
+
+    //! \brief Sets the number of times the word list is replayed for each operation. The default is 1.
+    void setRepetitions(int repetitions);
+
+    //! \brief Sets the operations to time. The default is all of them; Transduce is skipped unless setTransduceTo() has been called.
+    void setOperations(const QList<Operation> & operations);
+
+    //! \brief Sets the writing system (by its lang attribute) that the words are transduced into
+    void setTransduceTo(const QString & lang);
+
+    //! \brief Sets the number of synthetic stems to add to the model after it is read. See addSyntheticStems().
+    void setSyntheticStems(int count);
+
+    //! \brief Reads the morphology and adds any synthetic stems. Returns false if the morphology could not be read.
+    bool load();
+
+    //! \brief Times each operation, printing a line for each to \a out, and returns the results
+    QJsonObject run(QTextStream & out);
+
+    static QString operationName(Operation operation);
+    //! \brief Sets \a operation to the operation named \a name, returning false if there is no such operation
+    static bool operationFromName(const QString & name, Operation & operation);
+
+private:
+    //! \brief Adds \a count copies of the stems of the model whose forms are lengthened with letters of the same writing system, and returns the number that a stem list accepted. Only stem lists with accepts-stems="true" take them, and this is only done when all of the stem lists are XML stem lists, since the stems would otherwise be written to the model's databases.
+    int addSyntheticStems(int count);
+
+    //! \brief Times \a operation on every word, returning the result object
+    QJsonObject time(Operation operation, QTextStream & out);
+    //! \brief Performs \a operation on the word at \a index, returning the number of results
+    int perform(Operation operation, int index) const;
+
+    //! \brief Returns the letters appended to the forms of the \a n th copy of a stem
+    static QString syntheticSuffix(int n, const QList<QChar> & alphabet);
+    static qint64 percentile(const QList<qint64> & sorted, double fraction);
+
+    BenchmarkWorkload mWorkload;
+    Morphology * mMorphology;
+    QList<Form> mForms;
+    /// the parsings of each word, which Generate generates from
+    QList< QList<Parsing> > mParsings;
+    QList<Operation> mOperations;
+    QString mTransduceTo;
+    int mRepetitions;
+    int mSyntheticStems;
+    int mSyntheticStemsAdded;
+    qint64 mLoadMs;
+};
+
+} // namespace ME
+
+#endif // BENCHMARKRUNNER_H
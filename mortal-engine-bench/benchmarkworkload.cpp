@@ -0,0 +1,164 @@
+#include "benchmarkworkload.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QXmlStreamReader>
+#include <QtDebug>
+
+using namespace ME;
+
+namespace {
+
+/// these are the element names of mortal-engine-test's HarnessXmlReader
+const QString XML_TESTS = "tests";
+const QString XML_SCHEMA = "schema";
+const QString XML_INCLUDE = "include";
+const QString XML_SRC = "src";
+const QString XML_LABEL = "label";
+const QString XML_MORPHOLOGY_FILE = "morphology-file";
+const QString XML_LANG = "lang";
+const QString XML_ACCEPT = "accept";
+const QString XML_REJECT = "reject";
+const QString XML_INPUT = "input";
+
+} // namespace
+
+BenchmarkWorkload::BenchmarkWorkload(const QString &label, const QString &morphologyFile) :
+    mLabel(label),
+    mMorphologyFile(morphologyFile)
+{
+
+}
+
+bool BenchmarkWorkload::isTestFile(const QString &filename)
+{
+    QFile file(filename);
+    if( !file.open( QFile::ReadOnly ) )
+    {
+        return false;
+    }
+
+    QXmlStreamReader in(&file);
+    while( !in.atEnd() )
+    {
+        in.readNext();
+        if( in.isStartElement() )
+        {
+            return in.name() == XML_TESTS || in.name() == XML_SCHEMA;
+        }
+    }
+    return false;
+}
+
+QList<BenchmarkWorkload> BenchmarkWorkload::readTestFile(const QString &filename)
+{
+    QList<BenchmarkWorkload> workloads;
+
+    QFile file(filename);
+    if( !file.open( QFile::ReadOnly ) )
+    {
+        qWarning() << "BenchmarkWorkload::readTestFile()" << "Could not open" << filename;
+        return workloads;
+    }
+
+    QXmlStreamReader in(&file);
+    while( !in.atEnd() )
+    {
+        in.readNext();
+        if( in.isStartElement() )
+        {
+            if( in.name() == XML_SCHEMA )
+            {
+                readSchema( in, workloads );
+            }
+            else if( in.name() == XML_INCLUDE )
+            {
+                workloads.append( readTestFile( in.attributes().value(XML_SRC).toString() ) );
+            }
+        }
+    }
+
+    if( in.hasError() )
+    {
+        qWarning() << "BenchmarkWorkload::readTestFile()" << filename << in.errorString();
+    }
+
+    return workloads;
+}
+
+void BenchmarkWorkload::readSchema(QXmlStreamReader &in, QList<BenchmarkWorkload> &workloads)
+{
+    Q_ASSERT( in.isStartElement() && in.name() == XML_SCHEMA );
+    BenchmarkWorkload workload( in.attributes().value(XML_LABEL).toString(), QString() );
+
+    while( !in.atEnd() && !( in.isEndElement() && in.name() == XML_SCHEMA ) )
+    {
+        in.readNext();
+        if( !in.isStartElement() )
+        {
+            continue;
+        }
+
+        if( in.name() == XML_MORPHOLOGY_FILE )
+        {
+            workload.mMorphologyFile = in.readElementText();
+        }
+        else if( ( in.name() == XML_ACCEPT || in.name() == XML_REJECT || in.name() == XML_INPUT ) && in.attributes().hasAttribute(XML_LANG) )
+        {
+            const QString lang = in.attributes().value(XML_LANG).toString();
+            workload.addWord( lang, in.readElementText() );
+        }
+    }
+
+    if( workload.mMorphologyFile.isEmpty() )
+    {
+        qWarning() << "BenchmarkWorkload::readSchema()" << "Schema without a morphology file:" << workload.mLabel;
+    }
+    else
+    {
+        workloads << workload;
+    }
+}
+
+bool BenchmarkWorkload::readWordList(const QString &filename, const QString &lang)
+{
+    QFile file(filename);
+    if( !file.open( QFile::ReadOnly | QFile::Text ) )
+    {
+        return false;
+    }
+
+    QTextStream in(&file);
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+    in.setCodec("UTF-8");
+#endif
+    while( !in.atEnd() )
+    {
+        addWord( lang, in.readLine() );
+    }
+    return true;
+}
+
+void BenchmarkWorkload::addWord(const QString &lang, const QString &text)
+{
+    const QString word = text.trimmed();
+    if( !word.isEmpty() )
+    {
+        mWords << QPair<QString,QString>( lang, word );
+    }
+}
+
+QString BenchmarkWorkload::label() const
+{
+    return mLabel;
+}
+
+QString BenchmarkWorkload::morphologyFile() const
+{
+    return mMorphologyFile;
+}
+
+QList<QPair<QString, QString> > BenchmarkWorkload::words() const
+{
+    return mWords;
+}
@@ -0,0 +1,51 @@
+/*!
+  \class BenchmarkWorkload
+  \brief A morphology file and the words to replay against it.
+
+  Workloads can be read from a test harness file (e.g., examples/all-examples.xml), in which case there is one workload per schema, whose words are the inputs of its tests; or they can be made from a morphology file and a word list.
+*/
+
+#ifndef BENCHMARKWORKLOAD_H
+#define BENCHMARKWORKLOAD_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+class QXmlStreamReader;
+
+namespace ME {
+
+class BenchmarkWorkload
+{
+public:
+    BenchmarkWorkload(const QString & label, const QString & morphologyFile);
+
+    //! \brief Returns true if \a filename is a test harness file (i.e., its root element is tests or schema)
+    static bool isTestFile(const QString & filename);
+
+    //! \brief Returns a workload for each schema in the test harness file \a filename, including those of included files
+    static QList<BenchmarkWorkload> readTestFile(const QString & filename);
+
+    //! \brief Adds the words in \a filename, one per line, in the writing system \a lang. Returns false if the file cannot be read.
+    bool readWordList(const QString & filename, const QString & lang);
+
+    void addWord(const QString & lang, const QString & text);
+
+    QString label() const;
+    QString morphologyFile() const;
+
+    //! \brief Returns the words of the workload, as (writing system, text) pairs, since the writing systems are only known once the morphology is read
+    QList< QPair<QString,QString> > words() const;
+
+private:
+    static void readSchema(QXmlStreamReader & in, QList<BenchmarkWorkload> & workloads);
+
+    QString mLabel;
+    QString mMorphologyFile;
+    QList< QPair<QString,QString> > mWords;
+};
+
+} // namespace ME
+
+#endif // BENCHMARKWORKLOAD_H
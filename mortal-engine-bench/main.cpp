@@ -0,0 +1,143 @@
+#include <QCoreApplication>
+
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QtDebug>
+
+#include "benchmarkworkload.h"
+#include "benchmarkrunner.h"
+#include "resourceusage.h"
+#include "morphology.h"
+#include "messages.h"
+
+using namespace ME;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("Mortal Engine Benchmark");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Program to measure the throughput of Mortal Engine models. The input is either a test harness file (e.g., all-examples.xml), whose test inputs are replayed against each schema's morphology, or a morphology file with --words and --lang.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Test harness file or morphology file."));
+    parser.addPositionalArgument("output", QCoreApplication::translate("main", "JSON output file (default: benchmark.json)."));
+
+    parser.addOption({"words", QCoreApplication::translate("main", "Word list, one per line, when the input is a morphology file."), "words"});
+    parser.addOption({"lang", QCoreApplication::translate("main", "Writing system of the word list."), "lang"});
+    parser.addOption({"repetitions", QCoreApplication::translate("main", "Number of times to replay the words for each operation."), "repetitions", "1"});
+    parser.addOption({"operations", QCoreApplication::translate("main", "Comma-separated operations: parse, well-formed, guess-stem, generate, transduce (default: all)."), "operations"});
+    parser.addOption({"transduce-to", QCoreApplication::translate("main", "Writing system to transduce into (the transduce operation is skipped without it)."), "lang"});
+    parser.addOption({"synthetic-stems", QCoreApplication::translate("main", "Number of synthetic stems to add to each model. They are only added to XML stem lists with accepts-stems=\"true\"."), "count", "0"});
+    parser.addOption({"log", QCoreApplication::translate("main", "File for debug output."), "log"});
+    parser.addOption({"path", QCoreApplication::translate("main", "Path with data files."), "path"});
+
+    parser.process(a);
+
+    const QString path = parser.value("path");
+    QString logfile = parser.value("log");
+
+    /// set the path here to read the files in the correct location
+    if (!path.isEmpty()) {
+        Morphology::setPath(path);
+    }
+
+    if(logfile.isEmpty())
+        logfile = "benchmark-log.txt";
+
+    const QStringList args = parser.positionalArguments();
+    if( args.count() == 0 )
+    {
+        parser.showHelp();
+    }
+    const QString inputFilename = args.at(0);
+    const QString outputFilename = args.length() > 1 ? args.at(1) : "benchmark.json";
+
+    QList<BenchmarkRunner::Operation> operations;
+    if( parser.isSet("operations") )
+    {
+        foreach( QString name, parser.value("operations").split(",", Qt::SkipEmptyParts) )
+        {
+            BenchmarkRunner::Operation operation;
+            if( !BenchmarkRunner::operationFromName( name.trimmed(), operation ) )
+            {
+                qCritical() << "Unknown operation:" << name;
+                return 1;
+            }
+            operations << operation;
+        }
+    }
+
+    QList<BenchmarkWorkload> workloads;
+    if( BenchmarkWorkload::isTestFile(inputFilename) )
+    {
+        workloads = BenchmarkWorkload::readTestFile(inputFilename);
+    }
+    else
+    {
+        if( !parser.isSet("words") || !parser.isSet("lang") )
+        {
+            qCritical() << "A morphology file needs a word list (--words) and its writing system (--lang).";
+            return 1;
+        }
+        BenchmarkWorkload workload( inputFilename, inputFilename );
+        if( !workload.readWordList( parser.value("words"), parser.value("lang") ) )
+        {
+            qCritical() << "Could not read word list:" << parser.value("words");
+            return 1;
+        }
+        workloads << workload;
+    }
+
+    Messages::redirectMessagesTo(logfile);
+
+    QTextStream out(stdout);
+    QJsonArray results;
+    foreach( BenchmarkWorkload workload, workloads )
+    {
+        BenchmarkRunner runner( workload );
+        runner.setRepetitions( parser.value("repetitions").toInt() );
+        runner.setSyntheticStems( parser.value("synthetic-stems").toInt() );
+        runner.setTransduceTo( parser.value("transduce-to") );
+        if( !operations.isEmpty() )
+        {
+            runner.setOperations( operations );
+        }
+        if( runner.load() )
+        {
+            results.append( runner.run(out) );
+        }
+    }
+
+    QJsonObject document;
+    document.insert( "input", inputFilename );
+    document.insert( "date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate) );
+    document.insert( "qt_version", QString(qVersion()) );
+    document.insert( "counts_malloc", ResourceUsage::countsMalloc() );
+    document.insert( "peak_rss_kb", ResourceUsage::peakResidentSetKb() );
+    document.insert( "schemata", results );
+
+    QFile outFile(outputFilename);
+    if( !outFile.open(QFile::WriteOnly) )
+    {
+        qCritical() << "Could not open output file:" << outputFilename;
+        return 1;
+    }
+    outFile.write( QJsonDocument(document).toJson() );
+    outFile.close();
+
+    qInfo().noquote() << QString("Completed in %1 ms").arg(timer.elapsed());
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <QCoreApplication>
+
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QtDebug>
+
+#include "benchmarkworkload.h"
+#include "microbenchmarksuite.h"
+#include "resourceusage.h"
+#include "morphology.h"
+#include "messages.h"
+
+using namespace ME;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("Mortal Engine Microbenchmarks");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Program to measure the primitives of Mortal Engine in isolation, with fixtures taken from real models. The input is either a test harness file (e.g., all-examples.xml) or a morphology file with --words and --lang.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Test harness file or morphology file."));
+    parser.addPositionalArgument("output", QCoreApplication::translate("main", "JSON output file (default: microbenchmarks.json)."));
+
+    parser.addOption({"words", QCoreApplication::translate("main", "Word list, one per line, when the input is a morphology file."), "words"});
+    parser.addOption({"lang", QCoreApplication::translate("main", "Writing system of the word list."), "lang"});
+    parser.addOption({"min-time", QCoreApplication::translate("main", "Minimum time to run each benchmark, in milliseconds."), "ms", "200"});
+    parser.addOption({"filter", QCoreApplication::translate("main", "Only run the benchmarks whose names contain this string."), "filter"});
+    parser.addOption({"log", QCoreApplication::translate("main", "File for debug output."), "log"});
+    parser.addOption({"path", QCoreApplication::translate("main", "Path with data files."), "path"});
+
+    parser.process(a);
+
+    const QString path = parser.value("path");
+    QString logfile = parser.value("log");
+
+    /// set the path here to read the files in the correct location
+    if (!path.isEmpty()) {
+        Morphology::setPath(path);
+    }
+
+    if(logfile.isEmpty())
+        logfile = "microbenchmark-log.txt";
+
+    const QStringList args = parser.positionalArguments();
+    if( args.count() == 0 )
+    {
+        parser.showHelp();
+    }
+    const QString inputFilename = args.at(0);
+    const QString outputFilename = args.length() > 1 ? args.at(1) : "microbenchmarks.json";
+
+    QList<BenchmarkWorkload> workloads;
+    if( BenchmarkWorkload::isTestFile(inputFilename) )
+    {
+        workloads = BenchmarkWorkload::readTestFile(inputFilename);
+    }
+    else
+    {
+        if( !parser.isSet("words") || !parser.isSet("lang") )
+        {
+            qCritical() << "A morphology file needs a word list (--words) and its writing system (--lang).";
+            return 1;
+        }
+        BenchmarkWorkload workload( inputFilename, inputFilename );
+        if( !workload.readWordList( parser.value("words"), parser.value("lang") ) )
+        {
+            qCritical() << "Could not read word list:" << parser.value("words");
+            return 1;
+        }
+        workloads << workload;
+    }
+
+    Messages::redirectMessagesTo(logfile);
+
+    MicrobenchmarkSuite suite;
+    foreach( BenchmarkWorkload workload, workloads )
+    {
+        suite.addWorkload( workload );
+    }
+
+    QTextStream out(stdout);
+    const qint64 minimumNs = parser.value("min-time").toLongLong() * 1000000;
+    const QJsonArray results = suite.run( out, minimumNs, parser.value("filter") );
+
+    QJsonObject document;
+    document.insert( "input", inputFilename );
+    document.insert( "date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate) );
+    document.insert( "qt_version", QString(qVersion()) );
+    document.insert( "counts_malloc", ResourceUsage::countsMalloc() );
+    document.insert( "benchmarks", results );
+
+    QFile outFile(outputFilename);
+    if( !outFile.open(QFile::WriteOnly) )
+    {
+        qCritical() << "Could not open output file:" << outputFilename;
+        return 1;
+    }
+    outFile.write( QJsonDocument(document).toJson() );
+    outFile.close();
+
+    qInfo().noquote() << QString("Completed in %1 ms").arg(timer.elapsed());
+
+    return 0;
+}
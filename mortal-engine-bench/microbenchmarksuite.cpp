@@ -0,0 +1,268 @@
+#include "microbenchmarksuite.h"
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QtDebug>
+
+#include <stdexcept>
+
+#include "morphology.h"
+#include "nodes/morphemenode.h"
+#include "nodes/abstractstemlist.h"
+#include "create-allomorphs/createallomorphs.h"
+#include "constraints/abstractconstraint.h"
+#include "benchmarkworkload.h"
+#include "resourceusage.h"
+
+using namespace ME;
+
+const int MicrobenchmarkSuite::MAXIMUM_STEMS_PER_LIST = 1000;
+
+namespace {
+
+/// the results of the cases are accumulated here so that the calls cannot be optimized away
+volatile int gSink = 0;
+
+} // namespace
+
+MicrobenchmarkSuite::MicrobenchmarkSuite()
+{
+
+}
+
+MicrobenchmarkSuite::~MicrobenchmarkSuite()
+{
+    /// the cases refer to the models
+    mCases.clear();
+    qDeleteAll(mMorphologies);
+}
+
+bool MicrobenchmarkSuite::addWorkload(const BenchmarkWorkload &workload)
+{
+    Morphology * morphology = new Morphology;
+    try {
+        morphology->readXmlFile( workload.morphologyFile() );
+    } catch (const std::runtime_error &e) {
+        qCritical() << e.what() << "(" << workload.morphologyFile() << ")";
+        delete morphology;
+        return false;
+    }
+    mMorphologies << morphology;
+
+    const QList< QPair<QString,QString> > words = workload.words();
+    for(int i=0; i < words.count(); i++)
+    {
+        const WritingSystem ws = morphology->writingSystem( words.at(i).first );
+        if( ws.isNull() )
+        {
+            continue;
+        }
+        const Form form( ws, words.at(i).second );
+
+        addCase( "Morphology::normalize", [morphology, form]() {
+            return morphology->normalize( form ).text().length();
+        });
+
+        foreach( Parsing p, morphology->possibleParsings( form ) )
+        {
+            addParsingFixtures( p );
+        }
+    }
+
+    addCreateAllomorphsFixtures( morphology );
+
+    return true;
+}
+
+void MicrobenchmarkSuite::addParsingFixtures(const Parsing &parsing)
+{
+    /// replay the steps of the parsing, recording the calls that the parser makes before each one is appended
+    const QList<ParsingStep> steps = parsing.steps();
+    Parsing prefix( parsing.form(), parsing.morphologicalModel() );
+    for(int i=0; i < steps.count(); i++)
+    {
+        const AbstractNode * node = steps.at(i).node();
+        const Allomorph allomorph = steps.at(i).allomorph();
+        const LexicalStem stem = steps.at(i).lexicalStem();
+        const bool isStem = steps.at(i).isStem();
+
+        addCase( "Parsing::allomorphMatchesSegmentally", [prefix, allomorph]() {
+            return prefix.allomorphMatchesSegmentally( allomorph );
+        });
+        /// a morpheme node tests all of its allomorphs, most of which don't match
+        if( node->isMorphemeNode() )
+        {
+            foreach( Allomorph other, static_cast<const MorphemeNode*>(node)->allomorphs() )
+            {
+                addCase( "Parsing::allomorphMatchesSegmentally", [prefix, other]() {
+                    return prefix.allomorphMatchesSegmentally( other );
+                });
+            }
+        }
+
+        /// copying the parsing is part of appending, so its cost is measured separately
+        addCase( "Parsing (copy)", [prefix]() {
+            Parsing p = prefix;
+            return p.isOngoing();
+        });
+        addCase( "Parsing::append", [prefix, node, allomorph, stem, isStem]() {
+            Parsing p = prefix;
+            p.append( node, allomorph, stem, isStem );
+            return p.isOngoing();
+        });
+
+        /// match conditions are checked before the allomorph is appended (see Parsing::allomorphMatchConditionsSatisfied)
+        foreach( const AbstractConstraint * c, allomorph.matchConditions() )
+        {
+            addConstraintCase( c, prefix, nullptr, allomorph );
+        }
+        /// the local constraints of the previous allomorph are checked against the next one (see Parsing::beginAppend)
+        if( i > 0 )
+        {
+            foreach( const AbstractConstraint * c, steps.at(i-1).allomorph().localConstraints() )
+            {
+                addConstraintCase( c, prefix, node, allomorph );
+            }
+        }
+
+        prefix.append( node, allomorph, stem, isStem );
+    }
+}
+
+void MicrobenchmarkSuite::addConstraintCase(const AbstractConstraint *constraint, const Parsing &parsing, const AbstractNode *node, const Allomorph &allomorph)
+{
+    addCase( QString("AbstractConstraint::matches (%1)").arg( constraintClassName(constraint) ), [constraint, parsing, node, allomorph]() {
+        return constraint->matches( &parsing, node, allomorph );
+    });
+}
+
+void MicrobenchmarkSuite::addCreateAllomorphsFixtures(const Morphology *morphology)
+{
+    foreach( const AbstractStemList * list, morphology->stemLists() )
+    {
+        const QList<CreateAllomorphs> cas = list->createAllomorphs();
+        if( cas.isEmpty() )
+        {
+            continue;
+        }
+        int stemCount = 0;
+        foreach( const LexicalStem * stem, list->stems() )
+        {
+            if( ++stemCount > MAXIMUM_STEMS_PER_LIST )
+            {
+                break;
+            }
+            for(int i=0; i < stem->allomorphCount(); i++)
+            {
+                const Allomorph a = stem->allomorph(i);
+                if( !a.isOriginal() )
+                {
+                    continue;
+                }
+                foreach( CreateAllomorphs ca, cas )
+                {
+                    addCase( "CreateAllomorphs::generateAllomorphs", [ca, a]() {
+                        return ca.generateAllomorphs( a ).count();
+                    });
+                }
+            }
+        }
+    }
+
+    foreach( const AbstractNode * node, morphology->nodes() )
+    {
+        if( !node->isMorphemeNode() )
+        {
+            continue;
+        }
+        const MorphemeNode * morpheme = static_cast<const MorphemeNode*>(node);
+        const QList<CreateAllomorphs> cas = morpheme->createAllomorphs();
+        foreach( Allomorph a, morpheme->allomorphs() )
+        {
+            if( !a.isOriginal() )
+            {
+                continue;
+            }
+            foreach( CreateAllomorphs ca, cas )
+            {
+                addCase( "CreateAllomorphs::generateAllomorphs", [ca, a]() {
+                    return ca.generateAllomorphs( a ).count();
+                });
+            }
+        }
+    }
+}
+
+void MicrobenchmarkSuite::addCase(const QString &benchmark, const std::function<bool()> &c)
+{
+    mCases[ benchmark ] << c;
+}
+
+QString MicrobenchmarkSuite::constraintClassName(const AbstractConstraint *constraint)
+{
+    /// each summary begins with the name of the class (e.g., "TagMatchCondition (...)"); this avoids RTTI on classes that the library does not export
+    const QString summary = constraint->summary();
+    int length = 0;
+    while( length < summary.length() && summary.at(length).isLetterOrNumber() )
+    {
+        length++;
+    }
+    return length > 0 ? summary.left(length) : constraint->typeString();
+}
+
+QJsonArray MicrobenchmarkSuite::run(QTextStream &out, qint64 minimumNs, const QString &filter) const
+{
+    QJsonArray results;
+
+    QMapIterator<QString, QList< std::function<bool()> > > i(mCases);
+    while( i.hasNext() )
+    {
+        i.next();
+        if( !filter.isEmpty() && !i.key().contains( filter ) )
+        {
+            continue;
+        }
+        const QList< std::function<bool()> > & cases = i.value();
+
+        /// one pass first, so that caches (e.g., of regular expressions) are warm
+        for(int j=0; j < cases.count(); j++)
+        {
+            gSink = gSink + cases.at(j)();
+        }
+
+        qint64 operations = 0;
+        const qint64 allocationsBefore = ResourceUsage::allocations();
+        QElapsedTimer timer;
+        timer.start();
+        do
+        {
+            for(int j=0; j < cases.count(); j++)
+            {
+                gSink = gSink + cases.at(j)();
+            }
+            operations += cases.count();
+        } while( timer.nsecsElapsed() < minimumNs );
+        const qint64 ns = timer.nsecsElapsed();
+        const qint64 allocations = ResourceUsage::allocations() - allocationsBefore;
+
+        const double nsPerOperation = static_cast<double>(ns) / operations;
+        const double allocationsPerOperation = static_cast<double>(allocations) / operations;
+
+        QJsonObject result;
+        result.insert( "benchmark", i.key() );
+        result.insert( "cases", cases.count() );
+        result.insert( "operations", operations );
+        result.insert( "ns_per_op", nsPerOperation );
+        result.insert( "allocations_per_op", allocationsPerOperation );
+        results.append( result );
+
+        out << QString("%1 %2 ns/op %3 allocations/op (%4 cases)")
+               .arg( i.key(), -60 )
+               .arg( nsPerOperation, 10, 'f', 1 )
+               .arg( allocationsPerOperation, 8, 'f', 2 )
+               .arg( cases.count() ) << Qt::endl;
+    }
+
+    return results;
+}
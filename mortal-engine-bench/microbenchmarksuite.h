@@ -0,0 +1,60 @@
+/*!
+  \class MicrobenchmarkSuite
+  \brief Isolated measurements of the primitives that dominate parsing profiles: Parsing::allomorphMatchesSegmentally, Parsing::append, AbstractConstraint::matches (by constraint class), Morphology::normalize, and CreateAllomorphs::generateAllomorphs.
+
+  The fixtures come from real models: the words of each BenchmarkWorkload are parsed, and the steps of each parsing are replayed one at a time, recording a case for each call that the parser makes at that point. Each benchmark then calls all of its cases repeatedly, until a minimum time has passed, and reports the time and the allocations per call.
+*/
+
+#ifndef MICROBENCHMARKSUITE_H
+#define MICROBENCHMARKSUITE_H
+
+#include <QJsonArray>
+#include <QList>
+#include <QMap>
+#include <QString>
+
+#include <functional>
+
+class QTextStream;
+
+namespace ME {
+
+class Morphology;
+class Parsing;
+class AbstractConstraint;
+class AbstractNode;
+class Allomorph;
+class BenchmarkWorkload;
+
+class MicrobenchmarkSuite
+{
+public:
+    MicrobenchmarkSuite();
+    ~MicrobenchmarkSuite();
+    MicrobenchmarkSuite(const MicrobenchmarkSuite &) = delete;
+    MicrobenchmarkSuite &operator=(const MicrobenchmarkSuite &) = delete;
+
+    //! \brief Reads the morphology of \a workload and adds fixtures from it. The morphology is kept until the suite is destroyed, since the fixtures refer to it. Returns false if the morphology could not be read.
+    bool addWorkload(const BenchmarkWorkload & workload);
+
+    //! \brief Runs each benchmark whose name contains \a filter for at least \a minimumNs nanoseconds, printing a line for each to \a out, and returns the results
+    QJsonArray run(QTextStream & out, qint64 minimumNs, const QString & filter = QString()) const;
+
+private:
+    void addParsingFixtures(const Parsing & parsing);
+    void addConstraintCase(const AbstractConstraint * constraint, const Parsing & parsing, const AbstractNode * node, const Allomorph & allomorph);
+    void addCreateAllomorphsFixtures(const Morphology * morphology);
+    void addCase(const QString & benchmark, const std::function<bool()> & c);
+
+    //! \brief Returns the name of the class of \a constraint, for the benchmark name
+    static QString constraintClassName(const AbstractConstraint * constraint);
+
+    QList<Morphology*> mMorphologies;
+    QMap<QString, QList< std::function<bool()> > > mCases;
+
+    static const int MAXIMUM_STEMS_PER_LIST;
+};
+
+} // namespace ME
+
+#endif // MICROBENCHMARKSUITE_H
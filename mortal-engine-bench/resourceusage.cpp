@@ -0,0 +1,152 @@
+#include "resourceusage.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace ME;
+
+namespace {
+
+std::atomic<qint64> gAllocations(0);
+std::atomic<qint64> gAllocatedBytes(0);
+
+inline void countAllocation(std::size_t size)
+{
+    gAllocations.fetch_add( 1, std::memory_order_relaxed );
+    gAllocatedBytes.fetch_add( static_cast<qint64>(size), std::memory_order_relaxed );
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+
+/// glibc exports its allocator under these names as well, so the process-wide
+/// functions can be replaced without looking them up with dlsym (which itself allocates)
+extern "C" {
+void * __libc_malloc(std::size_t size) noexcept;
+void * __libc_calloc(std::size_t count, std::size_t size) noexcept;
+void * __libc_realloc(void * pointer, std::size_t size) noexcept;
+
+void * malloc(std::size_t size) noexcept
+{
+    countAllocation( size );
+    return __libc_malloc( size );
+}
+
+void * calloc(std::size_t count, std::size_t size) noexcept
+{
+    countAllocation( count * size );
+    return __libc_calloc( count, size );
+}
+
+void * realloc(void * pointer, std::size_t size) noexcept
+{
+    countAllocation( size );
+    return __libc_realloc( pointer, size );
+}
+}
+
+bool ResourceUsage::countsMalloc()
+{
+    return true;
+}
+
+#else
+
+void * operator new(std::size_t size)
+{
+    countAllocation( size );
+    void * pointer = std::malloc( size == 0 ? 1 : size );
+    if( pointer == nullptr )
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void * operator new[](std::size_t size)
+{
+    return operator new( size );
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    countAllocation( size );
+    return std::malloc( size == 0 ? 1 : size );
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return operator new( size, std::nothrow );
+}
+
+void operator delete(void * pointer) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete[](void * pointer) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete(void * pointer, std::size_t) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete[](void * pointer, std::size_t) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete(void * pointer, const std::nothrow_t &) noexcept
+{
+    std::free( pointer );
+}
+
+void operator delete[](void * pointer, const std::nothrow_t &) noexcept
+{
+    std::free( pointer );
+}
+
+bool ResourceUsage::countsMalloc()
+{
+    return false;
+}
+
+#endif
+
+qint64 ResourceUsage::allocations()
+{
+    return gAllocations.load( std::memory_order_relaxed );
+}
+
+qint64 ResourceUsage::allocatedBytes()
+{
+    return gAllocatedBytes.load( std::memory_order_relaxed );
+}
+
+qint64 ResourceUsage::peakResidentSetKb()
+{
+#if defined(Q_OS_UNIX)
+    struct rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+    {
+        return -1;
+    }
+#if defined(Q_OS_DARWIN)
+    /// bytes on macOS
+    return static_cast<qint64>( usage.ru_maxrss ) / 1024;
+#else
+    return static_cast<qint64>( usage.ru_maxrss );
+#endif
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,36 @@
+/*!
+  \class ResourceUsage
+  \brief Process-wide allocation counts and peak memory use, for benchmarks.
+
+  Allocations are counted by interposing malloc, calloc and realloc where the C library allows it (glibc), so that the allocations of Qt containers are counted as well. Elsewhere only calls to operator new (in this executable, and in the library on platforms where the executable's operator new is used for the whole process) are counted.
+*/
+
+#ifndef RESOURCEUSAGE_H
+#define RESOURCEUSAGE_H
+
+#include <QtGlobal>
+
+namespace ME {
+
+class ResourceUsage
+{
+public:
+    //! \brief Returns the number of allocations made by the process so far
+    static qint64 allocations();
+
+    //! \brief Returns the number of bytes requested by those allocations
+    static qint64 allocatedBytes();
+
+    //! \brief Returns the peak resident set size of the process in kilobytes, or -1 if it is not available on this platform
+    static qint64 peakResidentSetKb();
+
+    //! \brief Returns true if allocations by malloc (and not only operator new) are counted
+    static bool countsMalloc();
+
+private:
+    ResourceUsage() = delete;
+};
+
+} // namespace ME
+
+#endif // RESOURCEUSAGE_H
@@ -0,0 +1,214 @@
+#include "corpusprocessor.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QStringList>
+#include <QTextStream>
+
+#include "morphology.h"
+
+using namespace ME;
+
+const int CorpusProcessor::DEFAULT_CHUNK_SIZE = 10000;
+
+CorpusProcessor::CorpusProcessor(const Morphology *morphology, const WritingSystem &ws) :
+    mMorphology(morphology),
+    mWritingSystem(ws),
+    mThreads(0),
+    mChunkSize(DEFAULT_CHUNK_SIZE),
+    mOutputFormat(CorpusProcessor::Json),
+    mFlags(Parsing::None),
+    mTokens(0),
+    mSkipped(0),
+    mParsed(0),
+    mUnparsed(0),
+    mElapsedMs(0)
+{
+
+}
+
+void CorpusProcessor::setThreads(int threads)
+{
+    mThreads = threads;
+}
+
+void CorpusProcessor::setChunkSize(int chunkSize)
+{
+    mChunkSize = qMax( 1, chunkSize );
+}
+
+void CorpusProcessor::setOutputFormat(OutputFormat format)
+{
+    mOutputFormat = format;
+}
+
+void CorpusProcessor::setFlags(Parsing::Flags flags)
+{
+    mFlags = flags;
+}
+
+void CorpusProcessor::process(QTextStream &in, QTextStream &out)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<Form> chunk;
+    chunk.reserve( mChunkSize );
+    QString token;
+    while( true )
+    {
+        in >> token;
+        if( token.isEmpty() )
+        {
+            /// the stream is exhausted
+            break;
+        }
+        mTokens++;
+
+        const Form form( mWritingSystem, token );
+        if( form.isWhitespaceAndNonWordCharacters() )
+        {
+            mSkipped++;
+            continue;
+        }
+
+        chunk << form;
+        if( chunk.count() == mChunkSize )
+        {
+            processChunk( chunk, out );
+            chunk.clear();
+        }
+    }
+    if( !chunk.isEmpty() )
+    {
+        processChunk( chunk, out );
+    }
+    out.flush();
+
+    mElapsedMs += timer.elapsed();
+}
+
+void CorpusProcessor::processChunk(const QList<Form> &tokens, QTextStream &out)
+{
+    /// corpora repeat the same words over and over, so each distinct token is only parsed once
+    QList<Form> distinct;
+    QHash<QString,int> indexOf;
+    QList<int> indices;
+    indices.reserve( tokens.count() );
+    foreach( Form token, tokens )
+    {
+        QHash<QString,int>::const_iterator i = indexOf.constFind( token.text() );
+        if( i == indexOf.constEnd() )
+        {
+            i = indexOf.insert( token.text(), distinct.count() );
+            distinct << token;
+        }
+        indices << i.value();
+    }
+
+    /// the parsings are written out before the next chunk, and the model isn't changed meanwhile, so they needn't be detached from it
+    const Parsing::Flags flags = static_cast<Parsing::Flags>( mFlags | Parsing::ReferenceModelObjects );
+    const QList< QList<Parsing> > parsings = mMorphology->possibleParsingsBatch( distinct, flags, mThreads );
+
+    for(int i=0; i < tokens.count(); i++)
+    {
+        const QList<Parsing> & tokenParsings = parsings.at( indices.at(i) );
+        if( tokenParsings.isEmpty() )
+        {
+            mUnparsed++;
+        }
+        else
+        {
+            mParsed++;
+        }
+        out << line( tokens.at(i), tokenParsings ) << "\n";
+    }
+}
+
+QString CorpusProcessor::line(const Form &token, const QList<Parsing> &parsings) const
+{
+    switch( mOutputFormat )
+    {
+    case CorpusProcessor::Json:
+        return jsonLine( token, parsings );
+    case CorpusProcessor::Tsv:
+        return tsvLine( token, parsings );
+    }
+    return QString();
+}
+
+QString CorpusProcessor::jsonLine(const Form &token, const QList<Parsing> &parsings) const
+{
+    QJsonArray analyses;
+    foreach( const Parsing & p, parsings )
+    {
+        QJsonArray stems;
+        ParsingStepChain::Iterator i( p.stepIterator() );
+        while( i.hasNext() )
+        {
+            const ParsingStep & step = i.next();
+            if( step.isStem() )
+            {
+                QJsonObject stem;
+                stem.insert( "id", step.lexicalStemRef().id() );
+                stem.insert( "form", step.allomorphRef().form( mWritingSystem ).text() );
+                stems.append( stem );
+            }
+        }
+
+        QJsonObject analysis;
+        analysis.insert( "labels", p.labelSummary() );
+        analysis.insert( "stems", stems );
+        analyses.append( analysis );
+    }
+
+    QJsonObject object;
+    object.insert( "token", token.text() );
+    object.insert( "count", parsings.count() );
+    object.insert( "parsings", analyses );
+    return QString::fromUtf8( QJsonDocument(object).toJson(QJsonDocument::Compact) );
+}
+
+QString CorpusProcessor::tsvLine(const Form &token, const QList<Parsing> &parsings) const
+{
+    QStringList labels;
+    QStringList stems;
+    foreach( const Parsing & p, parsings )
+    {
+        labels << p.labelSummary();
+
+        QStringList stemsOfParsing;
+        ParsingStepChain::Iterator i( p.stepIterator() );
+        while( i.hasNext() )
+        {
+            const ParsingStep & step = i.next();
+            if( step.isStem() )
+            {
+                stemsOfParsing << QString("%1:%2").arg( step.lexicalStemRef().id() ).arg( step.allomorphRef().form( mWritingSystem ).text() );
+            }
+        }
+        stems << stemsOfParsing.join(",");
+    }
+
+    /// token, number of parsings, then the label summaries and the stems of each parsing, separated by " | "
+    QStringList fields;
+    fields << token.text() << QString::number( parsings.count() ) << labels.join(" | ") << stems.join(" | ");
+    return fields.join("\t");
+}
+
+QString CorpusProcessor::report() const
+{
+    const double seconds = mElapsedMs / 1000.0;
+    const double tokensPerSecond = seconds > 0 ? mTokens / seconds : 0.0;
+    return QObject::tr("%1 tokens (%2 skipped, %3 parsed, %4 not parsed) in %5 s: %6 tokens/s")
+            .arg( mTokens )
+            .arg( mSkipped )
+            .arg( mParsed )
+            .arg( mUnparsed )
+            .arg( seconds, 0, 'f', 2 )
+            .arg( tokensPerSecond, 0, 'f', 1 );
+}
@@ -0,0 +1,67 @@
+/*!
+  \class CorpusProcessor
+  \brief Parses a stream of tokens with a Morphology that has already been read, writing one line of JSON or TSV per token, in input order.
+
+  The tokens are read in chunks of a fixed size, and each chunk is parsed with Morphology::possibleParsingsBatch() before the next is read, so the memory used does not depend on the size of the corpus. Within a chunk each distinct token is parsed only once. Tokens that are only whitespace, digits and punctuation (see Form::isWhitespaceAndNonWordCharacters()) are skipped.
+*/
+
+#ifndef CORPUSPROCESSOR_H
+#define CORPUSPROCESSOR_H
+
+#include <QList>
+#include <QString>
+
+#include "datatypes/parsing.h"
+#include "datatypes/writingsystem.h"
+
+class QTextStream;
+
+namespace ME {
+
+class Morphology;
+
+class CorpusProcessor
+{
+public:
+    enum OutputFormat { Json, Tsv };
+
+    CorpusProcessor(const Morphology * morphology, const WritingSystem & ws);
+
+    //! \brief Sets the number of threads to parse with (see Morphology::possibleParsingsBatch()). The default is QThread::idealThreadCount().
+    void setThreads(int threads);
+    //! \brief Sets the number of tokens that are read before they are parsed and written. The default is DEFAULT_CHUNK_SIZE.
+    void setChunkSize(int chunkSize);
+    void setOutputFormat(OutputFormat format);
+    void setFlags(Parsing::Flags flags);
+
+    //! \brief Reads whitespace-separated tokens from \a in until it is exhausted, writing a line to \a out for each token that is not skipped
+    void process(QTextStream & in, QTextStream & out);
+
+    //! \brief Returns a summary of the tokens processed and the throughput, for printing at the end of a run
+    QString report() const;
+
+    static const int DEFAULT_CHUNK_SIZE;
+
+private:
+    void processChunk(const QList<Form> & tokens, QTextStream & out);
+    QString line(const Form & token, const QList<Parsing> & parsings) const;
+    QString jsonLine(const Form & token, const QList<Parsing> & parsings) const;
+    QString tsvLine(const Form & token, const QList<Parsing> & parsings) const;
+
+    const Morphology * mMorphology;
+    WritingSystem mWritingSystem;
+    int mThreads;
+    int mChunkSize;
+    OutputFormat mOutputFormat;
+    Parsing::Flags mFlags;
+
+    qint64 mTokens;
+    qint64 mSkipped;
+    qint64 mParsed;
+    qint64 mUnparsed;
+    qint64 mElapsedMs;
+};
+
+} // namespace ME
+
+#endif // CORPUSPROCESSOR_H
@@ -0,0 +1,139 @@
+#include <QCoreApplication>
+
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QtDebug>
+
+#include <stdexcept>
+
+#include "corpusprocessor.h"
+#include "morphology.h"
+#include "messages.h"
+
+using namespace ME;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("Mortal Engine Corpus Processor");
+    QCoreApplication::setApplicationVersion("1.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Program to parse a corpus with a Mortal Engine model. Whitespace-separated tokens are read from the input (or standard input), and one line of JSON or TSV is written for each token, in input order.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("morphology", QCoreApplication::translate("main", "Morphology file."));
+    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Corpus file (default: standard input)."));
+
+    parser.addOption({"lang", QCoreApplication::translate("main", "Writing system of the corpus."), "lang"});
+    parser.addOption({"output", QCoreApplication::translate("main", "Output file (default: standard output)."), "output"});
+    parser.addOption({"format", QCoreApplication::translate("main", "Output format: json or tsv."), "format", "json"});
+    parser.addOption({"threads", QCoreApplication::translate("main", "Number of parsing threads (default: one per core)."), "threads", "0"});
+    parser.addOption({"chunk-size", QCoreApplication::translate("main", "Number of tokens to read before parsing them."), "tokens", QString::number(CorpusProcessor::DEFAULT_CHUNK_SIZE)});
+    parser.addOption({"cache", QCoreApplication::translate("main", "Number of forms to keep in the parse cache."), "forms", "0"});
+    parser.addOption({"parse-chart", QCoreApplication::translate("main", "Parse with a parse chart.")});
+    parser.addOption({"log", QCoreApplication::translate("main", "File for debug output."), "log"});
+    parser.addOption({"path", QCoreApplication::translate("main", "Path with data files."), "path"});
+
+    parser.process(a);
+
+    const QString path = parser.value("path");
+    QString logfile = parser.value("log");
+
+    /// set the path here to read the files in the correct location
+    if (!path.isEmpty()) {
+        Morphology::setPath(path);
+    }
+
+    if(logfile.isEmpty())
+        logfile = "corpus-log.txt";
+
+    const QStringList args = parser.positionalArguments();
+    if( args.count() == 0 || !parser.isSet("lang") )
+    {
+        parser.showHelp();
+    }
+    const QString morphologyFilename = args.at(0);
+    const QString inputFilename = args.length() > 1 ? args.at(1) : "";
+
+    CorpusProcessor::OutputFormat format;
+    if( parser.value("format") == "json" ) {
+        format = CorpusProcessor::Json;
+    } else if( parser.value("format") == "tsv" ) {
+        format = CorpusProcessor::Tsv;
+    } else {
+        qCritical() << "Unknown output format:" << parser.value("format");
+        return 1;
+    }
+
+    Messages::redirectMessagesTo(logfile);
+
+    QElapsedTimer timer;
+    timer.start();
+    Morphology morphology;
+    try {
+        morphology.readXmlFile(morphologyFilename);
+    } catch (const std::runtime_error &e) {
+        qCritical() << e.what() << "(" << morphologyFilename << ")";
+        return 1;
+    }
+    const qint64 loadMs = timer.elapsed();
+
+    const WritingSystem ws = morphology.writingSystem( parser.value("lang") );
+    if( ws.isNull() )
+    {
+        qCritical() << "Unknown writing system:" << parser.value("lang");
+        return 1;
+    }
+    morphology.setParseCacheSize( parser.value("cache").toInt() );
+
+    QFile inFile;
+    if( inputFilename.isEmpty() ) {
+        inFile.open(stdin, QFile::ReadOnly);
+    } else {
+        inFile.setFileName(inputFilename);
+        if( !inFile.open(QFile::ReadOnly | QFile::Text) ) {
+            qCritical() << "Could not open input file:" << inputFilename;
+            return 1;
+        }
+    }
+    QTextStream in(&inFile);
+
+    QFile outFile;
+    if( parser.isSet("output") ) {
+        outFile.setFileName(parser.value("output"));
+        if( !outFile.open(QFile::WriteOnly | QFile::Text) ) {
+            qCritical() << "Could not open output file:" << parser.value("output");
+            return 1;
+        }
+    } else {
+        outFile.open(stdout, QFile::WriteOnly);
+    }
+    QTextStream out(&outFile);
+
+#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
+    in.setCodec("UTF-8");
+    out.setCodec("UTF-8");
+#endif
+
+    CorpusProcessor processor( &morphology, ws );
+    processor.setOutputFormat( format );
+    processor.setThreads( parser.value("threads").toInt() );
+    processor.setChunkSize( parser.value("chunk-size").toInt() );
+    if( parser.isSet("parse-chart") )
+    {
+        processor.setFlags( Parsing::UseParseChart );
+    }
+
+    processor.process( in, out );
+    outFile.close();
+
+    /// the report goes to standard error, so that it doesn't mix with the output
+    QTextStream err(stderr);
+    err << QString("Model loaded in %1 ms").arg(loadMs) << Qt::endl;
+    err << processor.report() << Qt::endl;
+
+    return 0;
+}
@@ -30,8 +30,8 @@ void AbstractTest::evaluate()
 
     mMorphology->setDebugOutput(mShowDebug);
     mMorphology->setStemDebugOutput(mShowStemDebug);
-    Debug::indentLevel = 0;
-    Debug::atBeginning = true;
+    Debug::setIndentLevel(0);
+    Debug::setAtBeginning(true);
 
     runTest();
 
@@ -0,0 +1,75 @@
+#include "addstemstest.h"
+
+#include <QObject>
+
+#include "returns/lexicalsteminsertresult.h"
+
+using namespace ME;
+
+AddStemsTest::AddStemsTest(Morphology *morphology) : AbstractTest(morphology)
+{
+
+}
+
+AddStemsTest::~AddStemsTest()
+{
+
+}
+
+bool AddStemsTest::succeeds() const
+{
+    return mInsertions == mExpectedInsertions;
+}
+
+QString AddStemsTest::message() const
+{
+    if( succeeds() )
+    {
+        return QObject::tr("%1Each of the %2 stem(s) was inserted into the expected number of stem lists.")
+                .arg( summaryStub() )
+                .arg( mStems.count() );
+    }
+    else
+    {
+        QStringList problems;
+        for(int i=0; i < mStems.count(); i++)
+        {
+            const int insertions = i < mInsertions.count() ? mInsertions.at(i) : 0;
+            if( insertions != mExpectedInsertions.at(i) )
+            {
+                problems << QObject::tr("%1 was inserted into %2 stem list(s) instead of %3")
+                            .arg( mStems.at(i).oneLineSummary() )
+                            .arg( insertions )
+                            .arg( mExpectedInsertions.at(i) );
+            }
+        }
+        return QObject::tr("%1The stems were not inserted as expected: %2")
+                .arg( summaryStub() )
+                .arg( problems.join("; ") );
+    }
+}
+
+QString AddStemsTest::barebonesOutput() const
+{
+    QStringList insertions;
+    foreach( int i, mInsertions )
+    {
+        insertions << QString::number(i);
+    }
+    return insertions.join(" ");
+}
+
+void AddStemsTest::runTest()
+{
+    mInsertions.clear();
+    foreach( LexicalStemInsertResult result, mMorphology->addLexicalStems( mStems ) )
+    {
+        mInsertions << result.numberOfInsertions();
+    }
+}
+
+void AddStemsTest::addStem(const LexicalStem &stem, int expectedInsertions)
+{
+    mStems << stem;
+    mExpectedInsertions << expectedInsertions;
+}
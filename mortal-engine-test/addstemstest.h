@@ -0,0 +1,44 @@
+/*!
+  \class AddStemsTest
+  \brief An AbstractTest subclass for testing Morphology::addLexicalStems(). A list of stems is added in one call, and the number of stem lists that accepted each stem is compared with the expected number.
+
+  A stem list writes all of the stems it accepts at once, so if one of them cannot be written, none of that list's stems should be reported as inserted.
+*/
+
+#ifndef ADDSTEMSTEST_H
+#define ADDSTEMSTEST_H
+
+#include "abstracttest.h"
+#include "datatypes/lexicalstem.h"
+
+namespace ME {
+
+class AddStemsTest : public AbstractTest
+{
+public:
+    explicit AddStemsTest(Morphology * morphology);
+    ~AddStemsTest() override;
+
+    //! \brief Returns true if every stem was inserted into the expected number of stem lists.
+    bool succeeds() const override;
+
+    //! \brief Summary of the result of the test.
+    QString message() const override;
+
+    QString barebonesOutput() const override;
+
+    //! \brief Evaluates the test.
+    void runTest() override;
+
+    //! \brief Adds a stem to the list of stems, along with the number of stem lists that should accept it.
+    void addStem(const LexicalStem &stem, int expectedInsertions);
+
+private:
+    QList<LexicalStem> mStems;
+    QList<int> mExpectedInsertions;
+    QList<int> mInsertions;
+};
+
+} // namespace ME
+
+#endif // ADDSTEMSTEST_H
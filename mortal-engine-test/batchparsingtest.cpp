@@ -0,0 +1,98 @@
+#include "batchparsingtest.h"
+
+#include <QObject>
+
+using namespace ME;
+
+BatchParsingTest::BatchParsingTest(Morphology *morphology) : AbstractTest(morphology), mThreads(4), mRepetitions(1), mFlags(Parsing::None), mMismatchCount(-1), mBatchSize(0)
+{
+
+}
+
+BatchParsingTest::~BatchParsingTest()
+{
+
+}
+
+bool BatchParsingTest::succeeds() const
+{
+    return mMismatchCount == 0;
+}
+
+QString BatchParsingTest::message() const
+{
+    if( succeeds() )
+    {
+        return QObject::tr("%1%2 forms were parsed with %3 threads, with the same results as parsing them one at a time.")
+                .arg( summaryStub() )
+                .arg( mBatchSize )
+                .arg( mThreads );
+    }
+    else
+    {
+        return QObject::tr("%1%2 forms were parsed with %3 threads, and %4 of them had different results than parsing them one at a time.")
+                .arg( summaryStub() )
+                .arg( mBatchSize )
+                .arg( mThreads )
+                .arg( mMismatchCount );
+    }
+}
+
+QString BatchParsingTest::barebonesOutput() const
+{
+    return succeeds() ? "identical" : "different";
+}
+
+void BatchParsingTest::runTest()
+{
+    QList<Form> batch;
+    for(int i=0; i < mRepetitions; i++)
+    {
+        batch << mInputs;
+    }
+    mBatchSize = batch.count();
+
+    const QList< QList<Parsing> > batchResults = mMorphology->possibleParsingsBatch( batch, mFlags, mThreads );
+
+    mMismatchCount = 0;
+    for(int i=0; i < batch.count(); i++)
+    {
+        const QList<Parsing> sequential = mMorphology->possibleParsings( batch.at(i), mFlags );
+        QStringList sequentialSummaries, batchSummaries;
+        foreach( Parsing p, sequential )
+        {
+            sequentialSummaries << p.labelSummary();
+        }
+        if( i < batchResults.count() )
+        {
+            foreach( Parsing p, batchResults.at(i) )
+            {
+                batchSummaries << p.labelSummary();
+            }
+        }
+        if( i >= batchResults.count() || sequentialSummaries != batchSummaries )
+        {
+            mMismatchCount++;
+        }
+    }
+}
+
+void BatchParsingTest::addInput(const Form &input)
+{
+    mInputs << input;
+}
+
+void BatchParsingTest::setThreads(int threads)
+{
+    mThreads = threads;
+}
+
+void BatchParsingTest::setRepetitions(int repetitions)
+{
+    mRepetitions = repetitions;
+}
+
+void BatchParsingTest::setFlags(Parsing::Flags flags)
+{
+    mFlags = flags;
+}
@@ -0,0 +1,56 @@
+/*!
+  \class BatchParsingTest
+  \brief An AbstractTest subclass for testing that parsing is reentrant. The inputs are parsed with Morphology::possibleParsingsBatch using several threads, and the test succeeds if the results are identical to parsing each input one at a time.
+
+  If flags are set (see setFlags()), both the batch and the inputs that it is compared with are parsed with them. FlagEquivalenceTest checks that flags do not change the results.
+*/
+
+#ifndef BATCHPARSINGTEST_H
+#define BATCHPARSINGTEST_H
+
+#include "abstracttest.h"
+#include "datatypes/parsing.h"
+
+namespace ME {
+
+class BatchParsingTest : public AbstractTest
+{
+public:
+    explicit BatchParsingTest(Morphology * morphology);
+    ~BatchParsingTest() override;
+
+    //! \brief Returns true if the batch results are identical to the sequential results.
+    bool succeeds() const override;
+
+    //! \brief Summary of the result of the test.
+    QString message() const override;
+
+    QString barebonesOutput() const override;
+
+    //! \brief Evaluates the test.
+    void runTest() override;
+
+    //! \brief Adds an input to the list of forms to be parsed.
+    void addInput(const Form &input);
+
+    //! \brief Sets the number of threads to parse with.
+    void setThreads(int threads);
+
+    //! \brief Sets the number of times the list of inputs is repeated in the batch.
+    void setRepetitions(int repetitions);
+
+    //! \brief Sets the flags that the batch is parsed with (e.g., Parsing::UseParseChart).
+    void setFlags(Parsing::Flags flags);
+
+private:
+    QList<Form> mInputs;
+    int mThreads;
+    int mRepetitions;
+    Parsing::Flags mFlags;
+    int mMismatchCount;
+    int mBatchSize;
+};
+
+} // namespace ME
+
+#endif // BATCHPARSINGTEST_H
@@ -0,0 +1,84 @@
+#include "flagequivalencetest.h"
+
+#include <QObject>
+
+using namespace ME;
+
+FlagEquivalenceTest::FlagEquivalenceTest(Morphology *morphology) : AbstractTest(morphology), mFlags(Parsing::None), mBaselineFlags(Parsing::None)
+{
+
+}
+
+FlagEquivalenceTest::~FlagEquivalenceTest()
+{
+
+}
+
+bool FlagEquivalenceTest::succeeds() const
+{
+    return mMismatches.isEmpty();
+}
+
+QString FlagEquivalenceTest::message() const
+{
+    if( succeeds() )
+    {
+        return QObject::tr("%1%2 forms had the same parsings with and without the flags.")
+                .arg( summaryStub() )
+                .arg( mInputs.count() );
+    }
+    else
+    {
+        return QObject::tr("%1%2 forms were parsed, and these had different parsings with the flags than without them: %3")
+                .arg( summaryStub() )
+                .arg( mInputs.count() )
+                .arg( mMismatches.join(", ") );
+    }
+}
+
+QString FlagEquivalenceTest::barebonesOutput() const
+{
+    return succeeds() ? "identical" : "different";
+}
+
+void FlagEquivalenceTest::runTest()
+{
+    mMismatches.clear();
+    foreach( Form input, mInputs )
+    {
+        QStringList withoutFlags, withFlags;
+        /// the parse cache ignores some flags (e.g., Parsing::ParallelModels), so it mustn't answer the second call with the results of the first
+        mMorphology->clearParseCache();
+        foreach( Parsing p, mMorphology->possibleParsings( input, mBaselineFlags ) )
+        {
+            withoutFlags << p.labelSummary();
+        }
+        mMorphology->clearParseCache();
+        foreach( Parsing p, mMorphology->possibleParsings( input, static_cast<Parsing::Flags>( mBaselineFlags | mFlags ) ) )
+        {
+            withFlags << p.labelSummary();
+        }
+        /// the order of the parsings doesn't matter
+        withoutFlags.sort();
+        withFlags.sort();
+        if( withoutFlags != withFlags )
+        {
+            mMismatches << input.text();
+        }
+    }
+}
+
+void FlagEquivalenceTest::addInput(const Form &input)
+{
+    mInputs << input;
+}
+
+void FlagEquivalenceTest::setFlags(Parsing::Flags flags)
+{
+    mFlags = flags;
+}
+
+void FlagEquivalenceTest::setBaselineFlags(Parsing::Flags flags)
+{
+    mBaselineFlags = flags;
+}
@@ -0,0 +1,51 @@
+/*!
+  \class FlagEquivalenceTest
+  \brief An AbstractTest subclass for testing that parsing flags that are meant to speed up parsing (e.g., Parsing::UseParseChart) do not change the results. Each input is parsed with and without the flags, and the test succeeds if the results are identical.
+
+  Flags that do change the results (e.g., Parsing::OnlyOneResult) can be set as baseline flags (see setBaselineFlags()), which are used for both parses.
+*/
+
+#ifndef FLAGEQUIVALENCETEST_H
+#define FLAGEQUIVALENCETEST_H
+
+#include "abstracttest.h"
+#include "datatypes/parsing.h"
+
+namespace ME {
+
+class FlagEquivalenceTest : public AbstractTest
+{
+public:
+    explicit FlagEquivalenceTest(Morphology * morphology);
+    ~FlagEquivalenceTest() override;
+
+    //! \brief Returns true if every input has the same parsings with and without the flags.
+    bool succeeds() const override;
+
+    //! \brief Summary of the result of the test.
+    QString message() const override;
+
+    QString barebonesOutput() const override;
+
+    //! \brief Evaluates the test.
+    void runTest() override;
+
+    //! \brief Adds an input to the list of forms to be parsed.
+    void addInput(const Form &input);
+
+    //! \brief Sets the flags that are compared with parsing without them.
+    void setFlags(Parsing::Flags flags);
+
+    //! \brief Sets the flags that are used for both parses (Parsing::None by default).
+    void setBaselineFlags(Parsing::Flags flags);
+
+private:
+    QList<Form> mInputs;
+    Parsing::Flags mFlags;
+    Parsing::Flags mBaselineFlags;
+    QStringList mMismatches;
+};
+
+} // namespace ME
+
+#endif // FLAGEQUIVALENCETEST_H
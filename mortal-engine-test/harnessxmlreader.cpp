@@ -12,6 +12,13 @@
 #include "nodes/sqlitestemlist.h"
 #include "generationtest.h"
 #include "interlinearglosstest.h"
+#include "batchparsingtest.h"
+#include "flagequivalencetest.h"
+#include "parsecachetest.h"
+#include "stemlookuptest.h"
+#include "addstemstest.h"
+#include "stemloadingtest.h"
+#include "snapshottest.h"
 #include "datatypes/morphemesequence.h"
 
 #include <QTextStream>
@@ -54,6 +61,22 @@ QString HarnessXmlReader::XML_SQLITE_DATABASE = "sqlite-database";
 QString HarnessXmlReader::XML_SRC = "src";
 QString HarnessXmlReader::XML_FILENAME = "filename";
 QString HarnessXmlReader::XML_DATABASE_NAME = "database-name";
+QString HarnessXmlReader::XML_BATCH_PARSING_TEST = "batch-parsing-test";
+QString HarnessXmlReader::XML_THREADS = "threads";
+QString HarnessXmlReader::XML_REPETITIONS = "repetitions";
+QString HarnessXmlReader::XML_FLAGS = "flags";
+QString HarnessXmlReader::XML_PARSE_CHART = "parse-chart";
+QString HarnessXmlReader::XML_ONLY_ONE_RESULT = "only-one-result";
+QString HarnessXmlReader::XML_PARALLEL_MODELS = "parallel-models";
+QString HarnessXmlReader::XML_BASELINE_FLAGS = "baseline-flags";
+QString HarnessXmlReader::XML_SNAPSHOT_TEST = "snapshot-test";
+QString HarnessXmlReader::XML_FLAG_EQUIVALENCE_TEST = "flag-equivalence-test";
+QString HarnessXmlReader::XML_PARSE_CACHE_TEST = "parse-cache-test";
+QString HarnessXmlReader::XML_STEM_LOOKUP_TEST = "stem-lookup-test";
+QString HarnessXmlReader::XML_REPLACEMENT_STEM = "replacement-stem";
+QString HarnessXmlReader::XML_ADD_STEMS_TEST = "add-stems-test";
+QString HarnessXmlReader::XML_INSERTIONS = "insertions";
+QString HarnessXmlReader::XML_STEM_LOADING_TEST = "stem-loading-test";
 
 HarnessXmlReader::HarnessXmlReader(TestHarness *harness) : mHarness(harness)
 {
@@ -111,6 +134,8 @@ TestSchema *HarnessXmlReader::readSchema(QXmlStreamReader &in)
 
             if (name == XML_MORPHOLOGY_FILE) {
                 schema->setMorphologyFile(in.readElementText());
+                /// the tests are run as they are read, so the counters have to be on beforehand
+                schema->morphology()->setCollectStatistics(mHarness->profile());
             } else if (name == XML_RECOGNITION_TEST) {
                 schema->addTest(readRecognitionTest(in, schema));
             } else if (name == XML_TRANSDUCTION_TEST) {
@@ -135,6 +160,20 @@ TestSchema *HarnessXmlReader::readSchema(QXmlStreamReader &in)
                 schema->addTest(readQuickAcceptanceTest(in, schema));
             } else if (name == XML_REJECT) {
                 schema->addTest(readQuickRejectionTest(in, schema));
+            } else if (name == XML_BATCH_PARSING_TEST) {
+                schema->addTest(readBatchParsingTest(in, schema));
+            } else if (name == XML_SNAPSHOT_TEST) {
+                schema->addTest(readSnapshotTest(in, schema));
+            } else if (name == XML_FLAG_EQUIVALENCE_TEST) {
+                schema->addTest(readFlagEquivalenceTest(in, schema));
+            } else if (name == XML_PARSE_CACHE_TEST) {
+                schema->addTest(readParseCacheTest(in, schema));
+            } else if (name == XML_STEM_LOOKUP_TEST) {
+                schema->addTest(readStemLookupTest(in, schema));
+            } else if (name == XML_ADD_STEMS_TEST) {
+                schema->addTest(readAddStemsTest(in, schema));
+            } else if (name == XML_STEM_LOADING_TEST) {
+                schema->addTest(readStemLoadingTest(in, schema));
             }
         } else if (in.tokenType() == QXmlStreamReader::EndElement) {
             break;
@@ -189,6 +228,249 @@ RecognitionTest *HarnessXmlReader::readRecognitionTest(QXmlStreamReader &in, con
     return test;
 }
 
+BatchParsingTest *HarnessXmlReader::readBatchParsingTest(QXmlStreamReader &in, const TestSchema *schema)
+{
+    BatchParsingTest* test = new BatchParsingTest(schema->morphology());
+    test->setPropertiesFromAttributes(in);
+
+    if( in.attributes().hasAttribute(XML_THREADS) )
+    {
+        test->setThreads( in.attributes().value(XML_THREADS).toString().toInt() );
+    }
+    if( in.attributes().hasAttribute(XML_REPETITIONS) )
+    {
+        test->setRepetitions( in.attributes().value(XML_REPETITIONS).toString().toInt() );
+    }
+    if( in.attributes().hasAttribute(XML_FLAGS) )
+    {
+        test->setFlags( parsingFlagsFromString( in.attributes().value(XML_FLAGS).toString() ) );
+    }
+
+    while(!in.atEnd() && !(in.tokenType() == QXmlStreamReader::EndElement && in.name() == XML_BATCH_PARSING_TEST ) )
+    {
+        in.readNext();
+
+        if( in.tokenType() == QXmlStreamReader::StartElement && in.name() == XML_INPUT )
+        {
+            WritingSystem ws = schema->morphology()->writingSystem( in.attributes().value(XML_LANG).toString() );
+            test->addInput( Form( ws, in.readElementText() ) );
+        }
+    }
+
+    test->evaluate();
+
+    return test;
+}
+
+FlagEquivalenceTest *HarnessXmlReader::readFlagEquivalenceTest(QXmlStreamReader &in, const TestSchema *schema)
+{
+    FlagEquivalenceTest* test = new FlagEquivalenceTest(schema->morphology());
+    test->setPropertiesFromAttributes(in);
+
+    test->setFlags( parsingFlagsFromString( in.attributes().value(XML_FLAGS).toString() ) );
+    test->setBaselineFlags( parsingFlagsFromString( in.attributes().value(XML_BASELINE_FLAGS).toString() ) );
+
+    while(!in.atEnd() && !(in.tokenType() == QXmlStreamReader::EndElement && in.name() == XML_FLAG_EQUIVALENCE_TEST ) )
+    {
+        in.readNext();
+
+        if( in.tokenType() == QXmlStreamReader::StartElement && in.name() == XML_INPUT )
+        {
+            WritingSystem ws = schema->morphology()->writingSystem( in.attributes().value(XML_LANG).toString() );
+            test->addInput( Form( ws, in.readElementText() ) );
+        }
+    }
+
+    test->evaluate();
+
+    return test;
+}
+
+SnapshotTest *HarnessXmlReader::readSnapshotTest(QXmlStreamReader &in, const TestSchema *schema)
+{
+    SnapshotTest* test = new SnapshotTest(schema->morphology());
+    test->setPropertiesFromAttributes(in);
+    test->evaluate();
+    return test;
+}
+
+ParseCacheTest *HarnessXmlReader::readParseCacheTest(QXmlStreamReader &in, const TestSchema *schema)
+{
+    ParseCacheTest* test = new ParseCacheTest(schema->morphology());
+    test->setPropertiesFromAttributes(in);
+
+    Allomorph allomorph(Allomorph::Original);
+    qlonglong stemId = -1;
+
+    while(!in.atEnd() && !(in.tokenType() == QXmlStreamReader::EndElement && in.name() == XML_PARSE_CACHE_TEST ) )
+    {
+        in.readNext();
+
+        if( in.tokenType() == QXmlStreamReader::StartElement )
+        {
+            if( in.name() == XML_INPUT )
+            {
+                WritingSystem ws = schema->morphology()->writingSystem( in.attributes().value(XML_LANG).toString() );
+                test->setInput( Form( ws, in.readElementText() ) );
+            }
+            else if( in.name() == XML_STEM )
+            {
+                stemId = in.attributes().value(XML_ID).toLongLong();
+            }
+            else if( in.name() == XML_FORM )
+            {
+                WritingSystem ws = schema->morphology()->writingSystem( in.attributes().value(XML_LANG).toString() );
+                allomorph.setForm( Form( ws, in.readElementText() ) );
+            }
+            else if( in.name() == XML_TAG )
+            {
+                allomorph.addTag( in.readElementText() );
+            }
+        }
+    }
+
+    LexicalStem stem(allomorph);
+    stem.setId( stemId );
+    test->setStem( stem );
+
+    test->evaluate();
+    return test;
+}
+
+StemLookupTest *HarnessXmlReader::readStemLookupTest(QXmlStreamReader &in, const TestSchema *schema)
+{
+    StemLookupTest* test = new StemLookupTest(schema->morphology());
+    test->setPropertiesFromAttributes(in);
+
+    Allomorph allomorph(Allomorph::Original);
+    Allomorph replacementAllomorph(Allomorph::Original);
+    Allomorph * current = &allomorph;
+    qlonglong stemId = -1;
+
+    while(!in.atEnd() && !(in.tokenType() == QXmlStreamReader::EndElement && in.name() == XML_STEM_LOOKUP_TEST ) )
+    {
+        in.readNext();
+
+        if( in.tokenType() == QXmlStreamReader::StartElement )
+        {
+            if( in.name() == XML_STEM )
+            {
+                stemId = in.attributes().value(XML_ID).toLongLong();
+                current = &allomorph;
+            }
+            else if( in.name() == XML_REPLACEMENT_STEM )
+            {
+                current = &replacementAllomorph;
+            }
+            else if( in.name() == XML_FORM )
+            {
+                WritingSystem ws = schema->morphology()->writingSystem( in.attributes().value(XML_LANG).toString() );
+                current->setForm( Form( ws, in.readElementText() ) );
+            }
+            else if( in.name() == XML_TAG )
+            {
+                current->addTag( in.readElementText() );
+            }
+        }
+    }
+
+    LexicalStem stem(allomorph);
+    stem.setId( stemId );
+    test->setStem( stem );
+    test->setReplacementStem( LexicalStem(replacementAllomorph) );
+
+    test->evaluate();
+    return test;
+}
+
+AddStemsTest *HarnessXmlReader::readAddStemsTest(QXmlStreamReader &in, const TestSchema *schema)
+{
+    AddStemsTest* test = new AddStemsTest(schema->morphology());
+    test->setPropertiesFromAttributes(in);
+
+    Allomorph allomorph(Allomorph::Original);
+    int insertions = 0;
+
+    while(!in.atEnd() && !(in.tokenType() == QXmlStreamReader::EndElement && in.name() == XML_ADD_STEMS_TEST ) )
+    {
+        in.readNext();
+
+        if( in.tokenType() == QXmlStreamReader::StartElement )
+        {
+            if( in.name() == XML_STEM )
+            {
+                allomorph = Allomorph(Allomorph::Original);
+                insertions = in.attributes().value(XML_INSERTIONS).toInt();
+            }
+            else if( in.name() == XML_FORM )
+            {
+                WritingSystem ws = schema->morphology()->writingSystem( in.attributes().value(XML_LANG).toString() );
+                allomorph.setForm( Form( ws, in.readElementText() ) );
+            }
+            else if( in.name() == XML_TAG )
+            {
+                allomorph.addTag( in.readElementText() );
+            }
+        }
+        else if( in.tokenType() == QXmlStreamReader::EndElement && in.name() == XML_STEM )
+        {
+            test->addStem( LexicalStem(allomorph), insertions );
+        }
+    }
+
+    test->evaluate();
+    return test;
+}
+
+StemLoadingTest *HarnessXmlReader::readStemLoadingTest(QXmlStreamReader &in, const TestSchema *schema)
+{
+    StemLoadingTest* test = new StemLoadingTest(schema->morphology());
+    test->setPropertiesFromAttributes(in);
+
+    while(!in.atEnd() && !(in.tokenType() == QXmlStreamReader::EndElement && in.name() == XML_STEM_LOADING_TEST ) )
+    {
+        in.readNext();
+
+        if( in.tokenType() == QXmlStreamReader::StartElement && in.name() == XML_INPUT )
+        {
+            WritingSystem ws = schema->morphology()->writingSystem( in.attributes().value(XML_LANG).toString() );
+            test->addInput( Form( ws, in.readElementText() ) );
+        }
+    }
+
+    test->evaluate();
+    return test;
+}
+
+Parsing::Flags HarnessXmlReader::parsingFlagsFromString(const QString &string)
+{
+    int flags = Parsing::None;
+    foreach( QString flag, string.split(" ") )
+    {
+        if( flag.isEmpty() )
+        {
+            continue;
+        }
+        else if( flag == XML_PARSE_CHART )
+        {
+            flags |= Parsing::UseParseChart;
+        }
+        else if( flag == XML_ONLY_ONE_RESULT )
+        {
+            flags |= Parsing::OnlyOneResult;
+        }
+        else if( flag == XML_PARALLEL_MODELS )
+        {
+            flags |= Parsing::ParallelModels;
+        }
+        else
+        {
+            qWarning() << "Unknown parsing flag:" << flag;
+        }
+    }
+    return static_cast<Parsing::Flags>( flags );
+}
+
 RecognitionTest *HarnessXmlReader::readQuickAcceptanceTest(QXmlStreamReader &in, const TestSchema *schema)
 {
     RecognitionTest* test = new RecognitionTest(schema->morphology());
@@ -8,6 +8,8 @@
 
 #include <QString>
 
+#include "datatypes/parsing.h"
+
 class QTextStream;
 class QXmlStreamReader;
 
@@ -21,6 +23,13 @@ class StemReplacementTest;
 class SuggestionTest;
 class GenerationTest;
 class InterlinearGlossTest;
+class BatchParsingTest;
+class FlagEquivalenceTest;
+class ParseCacheTest;
+class StemLookupTest;
+class AddStemsTest;
+class StemLoadingTest;
+class SnapshotTest;
 class TestHarness;
 
 class HarnessXmlReader
@@ -47,6 +56,16 @@ private:
     static GenerationTest *readQuickGenerationTest(QXmlStreamReader &in, const TestSchema *schema);
     static InterlinearGlossTest *readInterlinearGlossTest(QXmlStreamReader &in,
                                                           const TestSchema *schema);
+    static BatchParsingTest *readBatchParsingTest(QXmlStreamReader &in, const TestSchema *schema);
+    static FlagEquivalenceTest *readFlagEquivalenceTest(QXmlStreamReader &in, const TestSchema *schema);
+    static SnapshotTest *readSnapshotTest(QXmlStreamReader &in, const TestSchema *schema);
+    static ParseCacheTest *readParseCacheTest(QXmlStreamReader &in, const TestSchema *schema);
+    static StemLookupTest *readStemLookupTest(QXmlStreamReader &in, const TestSchema *schema);
+    static AddStemsTest *readAddStemsTest(QXmlStreamReader &in, const TestSchema *schema);
+    static StemLoadingTest *readStemLoadingTest(QXmlStreamReader &in, const TestSchema *schema);
+
+    //! \brief Returns the flags named in the space-separated list \a string (e.g., "parse-chart only-one-result")
+    static Parsing::Flags parsingFlagsFromString(const QString & string);
 
     TestHarness *mHarness;
 
@@ -85,6 +104,22 @@ public:
     static QString XML_SRC;
     static QString XML_FILENAME;
     static QString XML_DATABASE_NAME;
+    static QString XML_BATCH_PARSING_TEST;
+    static QString XML_THREADS;
+    static QString XML_REPETITIONS;
+    static QString XML_FLAGS;
+    static QString XML_PARSE_CHART;
+    static QString XML_ONLY_ONE_RESULT;
+    static QString XML_PARALLEL_MODELS;
+    static QString XML_BASELINE_FLAGS;
+    static QString XML_SNAPSHOT_TEST;
+    static QString XML_FLAG_EQUIVALENCE_TEST;
+    static QString XML_PARSE_CACHE_TEST;
+    static QString XML_STEM_LOOKUP_TEST;
+    static QString XML_REPLACEMENT_STEM;
+    static QString XML_ADD_STEMS_TEST;
+    static QString XML_INSERTIONS;
+    static QString XML_STEM_LOADING_TEST;
 };
 
 } // namespace ME
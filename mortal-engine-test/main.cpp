@@ -31,6 +31,7 @@ int main(int argc, char *argv[])
     parser.addOption({"barebones", QCoreApplication::translate("main", "Barebones output.")});
     parser.addOption({"model", QCoreApplication::translate("main", "Display the model.")});
     parser.addOption({"check", QCoreApplication::translate("main", "Perform checks on the model.")});
+    parser.addOption({"profile", QCoreApplication::translate("main", "Print per-node and per-constraint counters and timings.")});
     parser.addOption({"log", QCoreApplication::translate("main", "File for debug output."), "log"});
     parser.addOption({"inspect", QCoreApplication::translate("main", "Element ID to print summary for."), "inpect"});
     parser.addOption({"path", QCoreApplication::translate("main", "Path with data files."), "path"});
@@ -41,6 +42,7 @@ int main(int argc, char *argv[])
     const bool verbose = parser.isSet("verbose");
     const bool barebones = parser.isSet("barebones");
     const bool check = parser.isSet("check");
+    const bool profile = parser.isSet("profile");
     QString logfile = parser.value("log");
     const NodeId inspectId = NodeId( parser.value("inspect") );
     const QString path = parser.value("path");
@@ -75,6 +77,7 @@ int main(int argc, char *argv[])
 
     Messages::redirectMessagesTo(logfile);
     TestHarness harness;
+    harness.setProfile(profile);
     harness.readTestFile(inputFilename);
 
     QTextStream out(stdout);
@@ -0,0 +1,125 @@
+#include "parsecachetest.h"
+
+#include <QObject>
+
+#include "returns/lexicalsteminsertresult.h"
+
+using namespace ME;
+
+ParseCacheTest::ParseCacheTest(Morphology *morphology) : AbstractTest(morphology)
+{
+
+}
+
+ParseCacheTest::~ParseCacheTest()
+{
+
+}
+
+bool ParseCacheTest::succeeds() const
+{
+    return mProblems.isEmpty();
+}
+
+QString ParseCacheTest::message() const
+{
+    if( succeeds() )
+    {
+        return QObject::tr("%1The parse cache of %2 was cleared when a stem was added and removed.")
+                .arg( summaryStub() )
+                .arg( mInput.text() );
+    }
+    else
+    {
+        return QObject::tr("%1The parse cache of %2 did not behave as expected: %3")
+                .arg( summaryStub() )
+                .arg( mInput.text() )
+                .arg( mProblems.join("; ") );
+    }
+}
+
+QString ParseCacheTest::barebonesOutput() const
+{
+    return succeeds() ? "cleared" : "not cleared";
+}
+
+void ParseCacheTest::runTest()
+{
+    mProblems.clear();
+
+    const int previousSize = mMorphology->parseCacheSize();
+    mMorphology->setParseCacheSize( 10 );
+    mMorphology->clearParseCache();
+    mMorphology->resetParseCacheCounters();
+
+    const QStringList before = parse();
+    if( parse() != before )
+    {
+        mProblems << QObject::tr("the cached parsings differ from the original parsings");
+    }
+    checkCounters( 1, 1, QObject::tr("parsing twice") );
+
+    if( mMorphology->addLexicalStem( mStem ).numberOfInsertions() == 0 )
+    {
+        mProblems << QObject::tr("no stem list accepted the stem");
+    }
+    else
+    {
+        const QStringList added = parse();
+        if( added == before )
+        {
+            mProblems << QObject::tr("the parsings did not change when the stem was added");
+        }
+        if( parse() != added )
+        {
+            mProblems << QObject::tr("the cached parsings differ from the parsings after the stem was added");
+        }
+        checkCounters( 2, 2, QObject::tr("adding the stem") );
+
+        mMorphology->removeLexicalStem( mStem.id() );
+        if( parse() != before )
+        {
+            mProblems << QObject::tr("the parsings did not return to the original parsings when the stem was removed");
+        }
+        checkCounters( 2, 3, QObject::tr("removing the stem") );
+    }
+
+    mMorphology->setParseCacheSize( previousSize );
+    mMorphology->clearParseCache();
+    mMorphology->resetParseCacheCounters();
+}
+
+void ParseCacheTest::setInput(const Form &input)
+{
+    mInput = input;
+}
+
+void ParseCacheTest::setStem(const LexicalStem &stem)
+{
+    mStem = stem;
+}
+
+QStringList ParseCacheTest::parse() const
+{
+    QStringList result;
+    foreach( Parsing p, mMorphology->possibleParsings( mInput ) )
+    {
+        result << p.labelSummary();
+    }
+    /// the order of the parsings doesn't matter
+    result.sort();
+    return result;
+}
+
+void ParseCacheTest::checkCounters(qint64 hits, qint64 misses, const QString &when)
+{
+    if( mMorphology->parseCacheHits() != hits || mMorphology->parseCacheMisses() != misses )
+    {
+        mProblems << QObject::tr("after %1 there were %2 hit(s) and %3 miss(es) instead of %4 and %5")
+                     .arg( when )
+                     .arg( mMorphology->parseCacheHits() )
+                     .arg( mMorphology->parseCacheMisses() )
+                     .arg( hits )
+                     .arg( misses );
+    }
+}
@@ -0,0 +1,51 @@
+/*!
+  \class ParseCacheTest
+  \brief An AbstractTest subclass for testing that the parse cache of a Morphology is cleared when the stems change. The input is parsed with the cache turned on, a stem that matches it is added and then removed, and the input is parsed again after each change.
+
+  The test succeeds if the parsings change when the stem is added, return to the original parsings when it is removed, and the cache counters record a hit for each repeated parse and a miss for each parse after a change. The morphology must have a stem list that accepts stems.
+*/
+
+#ifndef PARSECACHETEST_H
+#define PARSECACHETEST_H
+
+#include "abstracttest.h"
+#include "datatypes/form.h"
+#include "datatypes/lexicalstem.h"
+
+namespace ME {
+
+class ParseCacheTest : public AbstractTest
+{
+public:
+    explicit ParseCacheTest(Morphology * morphology);
+    ~ParseCacheTest() override;
+
+    //! \brief Returns true if the parsings and the cache counters changed as expected.
+    bool succeeds() const override;
+
+    //! \brief Summary of the result of the test.
+    QString message() const override;
+
+    QString barebonesOutput() const override;
+
+    //! \brief Evaluates the test.
+    void runTest() override;
+
+    //! \brief Sets the form that is parsed.
+    void setInput(const Form &input);
+
+    //! \brief Sets the stem that is added and removed. The stem should have an id, so that it can be removed afterward.
+    void setStem(const LexicalStem &stem);
+
+private:
+    QStringList parse() const;
+    void checkCounters(qint64 hits, qint64 misses, const QString & when);
+
+    Form mInput;
+    LexicalStem mStem;
+    QStringList mProblems;
+};
+
+} // namespace ME
+
+#endif // PARSECACHETEST_H
@@ -0,0 +1,102 @@
+#include "snapshottest.h"
+
+#include <QObject>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+using namespace ME;
+
+SnapshotTest::SnapshotTest(Morphology *morphology) : AbstractTest(morphology), mSaved(false), mRestoredStemLists(-1), mStaleRejected(false)
+{
+
+}
+
+SnapshotTest::~SnapshotTest()
+{
+
+}
+
+bool SnapshotTest::succeeds() const
+{
+    return mSaved && mRestoredStemLists > 0 && mStaleRejected;
+}
+
+QString SnapshotTest::message() const
+{
+    if( !mSaved )
+    {
+        return QObject::tr("%1The morphology could not be saved to a snapshot.").arg( summaryStub() );
+    }
+    else if( mRestoredStemLists < 0 )
+    {
+        return QObject::tr("%1The morphology was saved to a snapshot but could not be reloaded from it.").arg( summaryStub() );
+    }
+    else if( mRestoredStemLists == 0 )
+    {
+        return QObject::tr("%1The morphology was reloaded, but none of its stem lists were restored from the snapshot.").arg( summaryStub() );
+    }
+    else if( !mStaleRejected )
+    {
+        return QObject::tr("%1The morphology was reloaded from the snapshot, but a snapshot of a morphology file that had since changed was not rejected.").arg( summaryStub() );
+    }
+    else
+    {
+        return QObject::tr("%1The morphology was saved to a snapshot and reloaded from it, with %2 stem list(s) restored; the tests that follow use the reloaded morphology. A snapshot of a changed morphology file was rejected.")
+                .arg( summaryStub() )
+                .arg( mRestoredStemLists );
+    }
+}
+
+QString SnapshotTest::barebonesOutput() const
+{
+    return succeeds() ? "reloaded" : "not reloaded";
+}
+
+void SnapshotTest::runTest()
+{
+    QTemporaryDir directory;
+    if( !directory.isValid() )
+    {
+        return;
+    }
+
+    mStaleRejected = staleSnapshotIsRejected( directory.path() );
+
+    const QString path = directory.filePath("snapshot");
+    mSaved = mMorphology->saveSnapshot( path );
+    if( mSaved )
+    {
+        mRestoredStemLists = mMorphology->loadSnapshot( path );
+    }
+}
+
+bool SnapshotTest::staleSnapshotIsRejected(const QString &directory) const
+{
+    /// the paths in the morphology file are relative to the working directory, so the copy reads the same sources
+    const QString copyPath = QDir(directory).filePath("morphology.xml");
+    if( !QFile::copy( mMorphology->morphologyPath(), copyPath ) )
+    {
+        return false;
+    }
+    QFile::setPermissions( copyPath, QFile::ReadOwner | QFile::WriteOwner );
+
+    Morphology copy;
+    copy.readXmlFile( copyPath );
+    const QString snapshotPath = QDir(directory).filePath("stale-snapshot");
+    if( !copy.saveSnapshot( snapshotPath ) )
+    {
+        return false;
+    }
+
+    /// a comment doesn't change the model, but it does change the file
+    QFile file( copyPath );
+    if( !file.open( QIODevice::Append ) )
+    {
+        return false;
+    }
+    file.write( "<!-- changed -->\n" );
+    file.close();
+
+    return copy.loadSnapshot( snapshotPath ) == -1;
+}
@@ -0,0 +1,43 @@
+/*!
+  \class SnapshotTest
+  \brief An AbstractTest subclass for testing MorphologySnapshot. The stems of the morphology are saved to a snapshot in a temporary directory, and the morphology is then reloaded from the snapshot. The test succeeds if the snapshot could be saved, at least one stem list was restored from it, and a snapshot of a morphology file that has since changed is rejected.
+
+  The tests that follow this one in the schema are run on the reloaded morphology, so they check that the stems were restored faithfully.
+*/
+
+#ifndef SNAPSHOTTEST_H
+#define SNAPSHOTTEST_H
+
+#include "abstracttest.h"
+
+namespace ME {
+
+class SnapshotTest : public AbstractTest
+{
+public:
+    explicit SnapshotTest(Morphology * morphology);
+    ~SnapshotTest() override;
+
+    //! \brief Returns true if the snapshot was saved, the morphology was reloaded with stems from it, and the stale snapshot was rejected.
+    bool succeeds() const override;
+
+    //! \brief Summary of the result of the test.
+    QString message() const override;
+
+    QString barebonesOutput() const override;
+
+    //! \brief Saves the snapshot and reloads the morphology from it.
+    void runTest() override;
+
+private:
+    //! \brief Saves a snapshot of a copy of the morphology file, changes the copy, and checks that the snapshot is then rejected.
+    bool staleSnapshotIsRejected(const QString & directory) const;
+
+    bool mSaved;
+    int mRestoredStemLists;
+    bool mStaleRejected;
+};
+
+} // namespace ME
+
+#endif // SNAPSHOTTEST_H
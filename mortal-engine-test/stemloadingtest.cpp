@@ -0,0 +1,111 @@
+#include "stemloadingtest.h"
+
+#include <QObject>
+
+#include "nodes/abstractstemlist.h"
+#include "datatypes/lexicalstem.h"
+
+using namespace ME;
+
+StemLoadingTest::StemLoadingTest(Morphology *morphology) : AbstractTest(morphology), mParallel(nullptr), mSequential(nullptr), mStemCount(0)
+{
+
+}
+
+StemLoadingTest::~StemLoadingTest()
+{
+    delete mParallel;
+    delete mSequential;
+}
+
+bool StemLoadingTest::succeeds() const
+{
+    return mProblems.isEmpty();
+}
+
+QString StemLoadingTest::message() const
+{
+    if( succeeds() )
+    {
+        return QObject::tr("%1The %2 stems and the parsings of %3 forms were the same when the stem lists were read in parallel and one at a time.")
+                .arg( summaryStub() )
+                .arg( mStemCount )
+                .arg( mInputs.count() );
+    }
+    else
+    {
+        return QObject::tr("%1Reading the stem lists in parallel and one at a time gave different results: %2")
+                .arg( summaryStub() )
+                .arg( mProblems.join("; ") );
+    }
+}
+
+QString StemLoadingTest::barebonesOutput() const
+{
+    return succeeds() ? "identical" : "different";
+}
+
+void StemLoadingTest::runTest()
+{
+    mProblems.clear();
+
+    delete mParallel;
+    delete mSequential;
+
+    mParallel = new Morphology;
+    mParallel->setReadStemListsInParallel(true);
+    mParallel->readXmlFile( mMorphology->morphologyPath() );
+
+    mSequential = new Morphology;
+    mSequential->setReadStemListsInParallel(false);
+    mSequential->readXmlFile( mMorphology->morphologyPath() );
+
+    const QStringList parallelStems = stemSummaries( mParallel );
+    const QStringList sequentialStems = stemSummaries( mSequential );
+    mStemCount = sequentialStems.count();
+    if( parallelStems != sequentialStems )
+    {
+        mProblems << QObject::tr("%1 stems were read in parallel and %2 one at a time, and they were not the same")
+                     .arg( parallelStems.count() )
+                     .arg( sequentialStems.count() );
+    }
+
+    foreach( Form input, mInputs )
+    {
+        if( parsingSummaries( mParallel, input ) != parsingSummaries( mSequential, input ) )
+        {
+            mProblems << QObject::tr("%1 was parsed differently").arg( input.text() );
+        }
+    }
+}
+
+void StemLoadingTest::addInput(const Form &input)
+{
+    mInputs << input;
+}
+
+QStringList StemLoadingTest::stemSummaries(const Morphology *morphology)
+{
+    QStringList summaries;
+    foreach( AbstractStemList * stemList, morphology->stemLists() )
+    {
+        foreach( LexicalStem * stem, stemList->stems() )
+        {
+            summaries << stemList->label().toString() + ": " + stem->oneLineSummary();
+        }
+    }
+    /// neither the stem lists nor their stems are in any particular order
+    summaries.sort();
+    return summaries;
+}
+
+QStringList StemLoadingTest::parsingSummaries(const Morphology *morphology, const Form &input)
+{
+    QStringList summaries;
+    foreach( Parsing p, morphology->possibleParsings( input ) )
+    {
+        summaries << p.labelSummary();
+    }
+    summaries.sort();
+    return summaries;
+}
@@ -0,0 +1,48 @@
+/*!
+  \class StemLoadingTest
+  \brief An AbstractTest subclass for testing that reading the stem lists in parallel (see Morphology::setReadStemListsInParallel()) gives the same model as reading them one at a time. The morphology file is read twice, once each way, and the test succeeds if the two have the same stems and the same parsings of each input.
+
+  SQL stem lists remove every database connection when they are deleted, so the two morphologies are kept until the test itself is deleted.
+*/
+
+#ifndef STEMLOADINGTEST_H
+#define STEMLOADINGTEST_H
+
+#include "abstracttest.h"
+
+namespace ME {
+
+class StemLoadingTest : public AbstractTest
+{
+public:
+    explicit StemLoadingTest(Morphology * morphology);
+    ~StemLoadingTest() override;
+
+    //! \brief Returns true if the stems and the parsings were the same both ways.
+    bool succeeds() const override;
+
+    //! \brief Summary of the result of the test.
+    QString message() const override;
+
+    QString barebonesOutput() const override;
+
+    //! \brief Evaluates the test.
+    void runTest() override;
+
+    //! \brief Adds an input to the list of forms to be parsed.
+    void addInput(const Form &input);
+
+private:
+    static QStringList stemSummaries(const Morphology * morphology);
+    static QStringList parsingSummaries(const Morphology * morphology, const Form & input);
+
+    QList<Form> mInputs;
+    Morphology * mParallel;
+    Morphology * mSequential;
+    int mStemCount;
+    QStringList mProblems;
+};
+
+} // namespace ME
+
+#endif // STEMLOADINGTEST_H
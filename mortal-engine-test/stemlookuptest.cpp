@@ -0,0 +1,93 @@
+#include "stemlookuptest.h"
+
+#include <QObject>
+
+#include "returns/lexicalsteminsertresult.h"
+
+using namespace ME;
+
+StemLookupTest::StemLookupTest(Morphology *morphology) : AbstractTest(morphology)
+{
+
+}
+
+StemLookupTest::~StemLookupTest()
+{
+
+}
+
+bool StemLookupTest::succeeds() const
+{
+    return mProblems.isEmpty();
+}
+
+QString StemLookupTest::message() const
+{
+    if( succeeds() )
+    {
+        return QObject::tr("%1The stem with the id %2 was found after it was added and replaced, and not after it was removed.")
+                .arg( summaryStub() )
+                .arg( mStem.id() );
+    }
+    else
+    {
+        return QObject::tr("%1The stem with the id %2 was not found as expected: %3")
+                .arg( summaryStub() )
+                .arg( mStem.id() )
+                .arg( mProblems.join("; ") );
+    }
+}
+
+QString StemLookupTest::barebonesOutput() const
+{
+    return succeeds() ? "found" : "not found";
+}
+
+void StemLookupTest::runTest()
+{
+    mProblems.clear();
+
+    if( mMorphology->addLexicalStem( mStem ).numberOfInsertions() == 0 )
+    {
+        mProblems << QObject::tr("no stem list accepted the stem");
+        return;
+    }
+    checkLookup( mStem, QObject::tr("adding the stem") );
+
+    LexicalStem replacement( mReplacementStem );
+    replacement.setId( mStem.id() );
+    mMorphology->replaceLexicalStem( replacement );
+    checkLookup( replacement, QObject::tr("replacing the stem") );
+
+    mMorphology->removeLexicalStem( mStem.id() );
+    if( mMorphology->getLexicalStem( mStem.id() ) != nullptr )
+    {
+        mProblems << QObject::tr("the stem was still found after it was removed");
+    }
+}
+
+void StemLookupTest::setStem(const LexicalStem &stem)
+{
+    mStem = stem;
+}
+
+void StemLookupTest::setReplacementStem(const LexicalStem &stem)
+{
+    mReplacementStem = stem;
+}
+
+void StemLookupTest::checkLookup(const LexicalStem &expected, const QString &when)
+{
+    const LexicalStem * found = mMorphology->getLexicalStem( expected.id() );
+    if( found == nullptr )
+    {
+        mProblems << QObject::tr("no stem was found after %1").arg( when );
+    }
+    else if( !( *found == expected ) )
+    {
+        mProblems << QObject::tr("after %1 the stem found was %2 instead of %3")
+                     .arg( when )
+                     .arg( found->oneLineSummary() )
+                     .arg( expected.oneLineSummary() );
+    }
+}
@@ -0,0 +1,49 @@
+/*!
+  \class StemLookupTest
+  \brief An AbstractTest subclass for testing that Morphology::getLexicalStem() follows changes to the stems. A stem is added, replaced, and then removed, and the stem is looked up by its id after each change.
+
+  The test succeeds if the lookup returns the added stem, then the replacement, and then nothing. The morphology must have a stem list that accepts stems.
+*/
+
+#ifndef STEMLOOKUPTEST_H
+#define STEMLOOKUPTEST_H
+
+#include "abstracttest.h"
+#include "datatypes/lexicalstem.h"
+
+namespace ME {
+
+class StemLookupTest : public AbstractTest
+{
+public:
+    explicit StemLookupTest(Morphology * morphology);
+    ~StemLookupTest() override;
+
+    //! \brief Returns true if the stem was found as expected after each change.
+    bool succeeds() const override;
+
+    //! \brief Summary of the result of the test.
+    QString message() const override;
+
+    QString barebonesOutput() const override;
+
+    //! \brief Evaluates the test.
+    void runTest() override;
+
+    //! \brief Sets the stem that is added. The stem should have an id, which the replacement takes as well.
+    void setStem(const LexicalStem &stem);
+
+    //! \brief Sets the stem that replaces the added stem.
+    void setReplacementStem(const LexicalStem &stem);
+
+private:
+    void checkLookup(const LexicalStem & expected, const QString & when);
+
+    LexicalStem mStem;
+    LexicalStem mReplacementStem;
+    QStringList mProblems;
+};
+
+} // namespace ME
+
+#endif // STEMLOOKUPTEST_H
@@ -4,10 +4,11 @@
 
 #include "testschema.h"
 #include "harnessxmlreader.h"
+#include "returns/morphologystatistics.h"
 
 using namespace ME;
 
-TestHarness::TestHarness()
+TestHarness::TestHarness() : mProfile(false)
 {
 
 }
@@ -52,6 +53,21 @@ void TestHarness::printReport(QTextStream &out, VerbosityLevel verbosity, bool s
             out << Qt::endl;
         }
         ts->printReport(out, verbosity);
+        if( mProfile )
+        {
+            out << Qt::endl;
+            out << ts->morphology()->statistics().summary();
+        }
         out << Qt::endl << Qt::endl;
     }
 }
+
+void TestHarness::setProfile(bool profile)
+{
+    mProfile = profile;
+}
+
+bool TestHarness::profile() const
+{
+    return mProfile;
+}
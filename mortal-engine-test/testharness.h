@@ -36,8 +36,13 @@ public:
     //! \param showModel The models are printed if this is set to true.
     void printReport(QTextStream &out, TestHarness::VerbosityLevel verbosity, bool showModel, bool check, const NodeId &inspectId );
 
+    //! \brief If \a profile is true, the models collect statistics while the tests are run, and printReport() prints them (see Morphology::statistics()). This must be set before readTestFile() is called.
+    void setProfile(bool profile);
+    bool profile() const;
+
 private:
     QList<TestSchema*> mSchemata;
+    bool mProfile;
 };
 
 } // namespace ME
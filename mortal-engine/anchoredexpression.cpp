@@ -0,0 +1,242 @@
+#include "anchoredexpression.h"
+
+#include <QRegularExpression>
+#include <QStringList>
+
+using namespace ME;
+
+namespace {
+
+/// beyond this, caching by context would not save anything
+const int MAXIMUM_CONTEXT_LENGTH = 1000;
+
+int alternationLength(const QString & pattern, int & pos);
+
+/// Returns the maximum length of the character class starting at pos, which is left after the closing bracket, or -1
+int classLength(const QString & pattern, int & pos)
+{
+    pos++; /// [
+    if( pos < pattern.length() && pattern.at(pos) == '^' )
+        pos++;
+    /// a ] at the start of the class is a literal
+    if( pos < pattern.length() && pattern.at(pos) == ']' )
+        pos++;
+    while( pos < pattern.length() && pattern.at(pos) != ']' )
+    {
+        if( pattern.at(pos) == '\\' )
+        {
+            pos += 2;
+        }
+        else if( pattern.mid(pos, 2) == "[:" )
+        {
+            const int end = pattern.indexOf( ":]", pos + 2 );
+            if( end == -1 )
+                return -1;
+            pos = end + 2;
+        }
+        else
+        {
+            pos++;
+        }
+    }
+    if( pos >= pattern.length() )
+        return -1;
+    pos++; /// ]
+    /// a character outside the BMP takes two code units
+    return 2;
+}
+
+/// Returns the maximum length of the escape sequence starting at pos, which is left after it, or -1
+int escapeLength(const QString & pattern, int & pos)
+{
+    pos++; /// backslash
+    if( pos >= pattern.length() )
+        return -1;
+    const QChar c = pattern.at(pos);
+    pos++;
+
+    if( !c.isLetterOrNumber() )
+    {
+        /// an escaped literal
+        return 1;
+    }
+    else if( QString("dDwWsShHvV").contains(c) )
+    {
+        return 2;
+    }
+    else if( c == 'R' )
+    {
+        /// \R can match \r\n
+        return 2;
+    }
+    else if( c == 'p' || c == 'P' || c == 'x' )
+    {
+        if( pos < pattern.length() && pattern.at(pos) == '{' )
+        {
+            const int end = pattern.indexOf( '}', pos );
+            if( end == -1 )
+                return -1;
+            pos = end + 1;
+        }
+        else if( c == 'x' )
+        {
+            /// \x with two hex digits
+            const QString hexDigits = "0123456789abcdefABCDEF";
+            if( pos + 1 >= pattern.length() || !hexDigits.contains( pattern.at(pos) ) || !hexDigits.contains( pattern.at(pos + 1) ) )
+                return -1;
+            pos += 2;
+        }
+        else
+        {
+            /// e.g., \pL
+            pos++;
+        }
+        return 2;
+    }
+    /// anchors (\b, \A, \z, \G), backreferences, \K, \Q, \X, etc.
+    return -1;
+}
+
+/// Returns the maximum length of the sequence starting at pos, which is left at the | or ) that ends the sequence, or at the end of the pattern; or -1
+int sequenceLength(const QString & pattern, int & pos)
+{
+    int length = 0;
+    while( pos < pattern.length() && pattern.at(pos) != '|' && pattern.at(pos) != ')' )
+    {
+        const QChar c = pattern.at(pos);
+        int atom = -1;
+        if( c == '(' )
+        {
+            pos++;
+            /// only plain and non-capturing groups; (?= etc. can inspect characters outside the match
+            if( pos < pattern.length() && pattern.at(pos) == '?' )
+            {
+                if( pattern.mid(pos, 2) != "?:" )
+                    return -1;
+                pos += 2;
+            }
+            atom = alternationLength( pattern, pos );
+            if( atom == -1 || pos >= pattern.length() || pattern.at(pos) != ')' )
+                return -1;
+            pos++;
+        }
+        else if( c == '[' )
+        {
+            atom = classLength( pattern, pos );
+        }
+        else if( c == '\\' )
+        {
+            atom = escapeLength( pattern, pos );
+        }
+        else if( c == '.' )
+        {
+            atom = 2;
+            pos++;
+        }
+        else if( QString("^$*+?{").contains(c) )
+        {
+            return -1;
+        }
+        else
+        {
+            atom = 1;
+            pos++;
+        }
+
+        if( atom == -1 )
+            return -1;
+
+        /// a quantifier, if any
+        if( pos < pattern.length() && pattern.at(pos) == '?' )
+        {
+            pos++;
+        }
+        else if( pos < pattern.length() && pattern.at(pos) == '{' )
+        {
+            const int end = pattern.indexOf( '}', pos );
+            if( end == -1 )
+                return -1;
+            const QStringList bounds = pattern.mid( pos + 1, end - pos - 1 ).split(',');
+            bool ok = bounds.count() <= 2;
+            const int maximum = ok ? bounds.last().toInt(&ok) : 0;
+            if( !ok )
+                return -1;
+            atom *= maximum;
+            pos = end + 1;
+        }
+        else if( pos < pattern.length() && ( pattern.at(pos) == '*' || pattern.at(pos) == '+' ) )
+        {
+            return -1;
+        }
+        else
+        {
+            length += atom;
+            if( length > MAXIMUM_CONTEXT_LENGTH )
+                return -1;
+            continue;
+        }
+
+        /// lazy or possessive quantifiers match no more than greedy ones
+        if( pos < pattern.length() && ( pattern.at(pos) == '?' || pattern.at(pos) == '+' ) )
+            pos++;
+
+        length += atom;
+        if( length > MAXIMUM_CONTEXT_LENGTH )
+            return -1;
+    }
+    return length;
+}
+
+int alternationLength(const QString & pattern, int & pos)
+{
+    int length = sequenceLength( pattern, pos );
+    while( length != -1 && pos < pattern.length() && pattern.at(pos) == '|' )
+    {
+        pos++;
+        length = qMax( length, sequenceLength( pattern, pos ) );
+        if( length == -1 )
+            return -1;
+    }
+    return length;
+}
+
+}
+
+int AnchoredExpression::contextLength(const QString &pattern)
+{
+    /// the expression has to be anchored at the end, and nowhere else
+    if( !pattern.endsWith('$') )
+    {
+        return -1;
+    }
+    const QString body = pattern.left( pattern.length() - 1 );
+    /// an odd number of backslashes before the $ would make it a literal
+    int backslashes = 0;
+    while( backslashes < body.length() && body.at( body.length() - 1 - backslashes ) == '\\' )
+    {
+        backslashes++;
+    }
+    if( backslashes % 2 == 1 )
+    {
+        return -1;
+    }
+
+    /// a | at the top level would leave the other alternatives unanchored
+    int pos = 0;
+    const int length = sequenceLength( body, pos );
+    if( pos != body.length() )
+    {
+        return -1;
+    }
+    return length;
+}
+
+int AnchoredExpression::contextLength(const QRegularExpression &re)
+{
+    /// other options (e.g., multiline) would change what $ means
+    if( !re.isValid() || ( re.patternOptions() & ~QRegularExpression::UseUnicodePropertiesOption ) != 0 )
+    {
+        return -1;
+    }
+    return contextLength( re.pattern() );
+}
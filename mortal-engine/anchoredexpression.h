@@ -0,0 +1,26 @@
+#ifndef ANCHOREDEXPRESSION_H
+#define ANCHOREDEXPRESSION_H
+
+#include "mortal-engine_global.h"
+
+class QString;
+class QRegularExpression;
+
+namespace ME {
+
+//! \brief Analyzes regular expressions that are anchored at the end of the text, which only need to be matched against the end of a string. Both phonological conditions and CreateAllomorphs replacements use this.
+class MORTAL_ENGINE_EXPORT AnchoredExpression {
+public:
+    //! \brief Returns the maximum number of UTF-16 code units matched by \a pattern, if it is of the form "...$" with no unbounded quantifiers, lookarounds, or other anchors; otherwise returns -1
+    static int contextLength(const QString & pattern);
+
+    //! \brief Returns contextLength() of the pattern of \a re, or -1 if \a re is invalid or has an option other than QRegularExpression::UseUnicodePropertiesOption, which could change what $ means
+    static int contextLength(const QRegularExpression & re);
+
+private:
+    AnchoredExpression();
+};
+
+} // namespace ME
+
+#endif // ANCHOREDEXPRESSION_H
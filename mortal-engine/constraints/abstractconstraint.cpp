@@ -4,6 +4,11 @@
 #include "abstractnestedconstraint.h"
 
 #include <QXmlStreamReader>
+#include <QRegularExpression>
+#include <QElapsedTimer>
+
+#include "anchoredexpression.h"
+#include "datatypes/parsing.h"
 
 using namespace ME;
 
@@ -21,8 +26,17 @@ bool AbstractConstraint::matches(const Parsing *parsing, const AbstractNode *nod
 {
     if( shouldBeIgnored(parsing) )
         return true;
-    else
+    else if( parsing == nullptr || !parsing->collectStatistics() )
         return matchesThisConstraint(parsing, node, allomorph);
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool result = matchesThisConstraint(parsing, node, allomorph);
+    mCounters.add( HotPathCounters::Visits );
+    if( !result )
+        mCounters.add( HotPathCounters::ConditionRejections );
+    mCounters.add( HotPathCounters::Nanoseconds, timer.nsecsElapsed() );
+    return result;
 }
 
 QString AbstractConstraint::satisfactionSummary(const Parsing *parsing, const AbstractNode *node, const Allomorph &allomorph) const
@@ -76,6 +90,21 @@ bool AbstractConstraint::isLongDistanceConstraint() const
     return mType == AbstractConstraint::LongDistanceConstraint;
 }
 
+bool AbstractConstraint::isResolved() const
+{
+    return true;
+}
+
+bool AbstractConstraint::isCostly() const
+{
+    return false;
+}
+
+AbstractConstraint::History AbstractConstraint::historyInspected() const
+{
+    return AbstractConstraint::NoHistory;
+}
+
 AbstractLongDistanceConstraint *AbstractConstraint::toLongDistanceConstraint()
 {
     return dynamic_cast<AbstractLongDistanceConstraint *>(this);
@@ -119,6 +148,16 @@ bool AbstractConstraint::isNot() const
     return false;
 }
 
+const HotPathCounters &AbstractConstraint::counters() const
+{
+    return mCounters;
+}
+
+void AbstractConstraint::resetCounters() const
+{
+    mCounters.reset();
+}
+
 bool AbstractConstraint::shouldBeIgnored(const Parsing *parsing) const
 {
     QListIterator<IgnoreFlag> i(mIgnoreFlags);
@@ -159,3 +198,32 @@ void AbstractConstraint::setType(const Type &type)
 {
     mType = type;
 }
+
+bool AbstractConstraint::matchesText(const QRegularExpression &re, const QString &text, int position, int length, int contextLength)
+{
+    if( contextLength != -1 )
+    {
+        /// one more code unit, since $ also matches before a final newline
+        int start = qMax( position, position + length - contextLength - 1 );
+        /// don't split a surrogate pair
+        if( start > position && text.at(start).isLowSurrogate() )
+        {
+            start--;
+        }
+        length -= start - position;
+        position = start;
+    }
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 5, 0))
+    return re.matchView( QStringView(text).mid(position, length) ).hasMatch();
+#elif (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+    return re.match( QStringView(text).mid(position, length) ).hasMatch();
+#else
+    return re.match( text.midRef(position, length) ).hasMatch();
+#endif
+}
+
+int AbstractConstraint::expressionContextLength(const QRegularExpression &re)
+{
+    return AnchoredExpression::contextLength( re );
+}
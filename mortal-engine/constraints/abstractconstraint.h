@@ -4,9 +4,11 @@
 #include <QString>
 
 #include "ignoreflag.h"
+#include "datatypes/hotpathcounters.h"
 #include "mortal-engine_global.h"
 
 class QXmlStreamReader;
+class QRegularExpression;
 
 namespace ME {
 
@@ -21,6 +23,8 @@ class MORTAL_ENGINE_EXPORT AbstractConstraint
 {
 public:
     enum Type { MatchCondition, LocalConstraint, LongDistanceConstraint, Nested, Pointer };
+    //! \brief How many of the preceding steps of a parsing a constraint examines (see historyInspected())
+    enum History { NoHistory, PrecedingStep, AllSteps };
 
     AbstractConstraint(Type t);
     virtual ~AbstractConstraint() = 0;
@@ -46,6 +50,13 @@ public:
     virtual bool isLocalConstraint() const;
     virtual bool isLongDistanceConstraint() const;
 
+    //! \brief Returns false if the constraint depends on a PointerToConstraint that has not been filled in yet, in which case its type cannot be known
+    virtual bool isResolved() const;
+    //! \brief Returns true if the constraint is relatively expensive to check (e.g., it matches a regular expression), so that it can be checked after cheaper constraints
+    virtual bool isCostly() const;
+    //! \brief Returns how much of the parsing's steps the constraint examines, beyond the number of steps. ParseChart uses this to decide which parsings can share results.
+    virtual History historyInspected() const;
+
     AbstractLongDistanceConstraint * toLongDistanceConstraint();
     AbstractNestedConstraint * toNestedConstraint();
 
@@ -56,6 +67,10 @@ public:
 
     virtual bool isNot() const;
 
+    //! \brief Returns the counters of this constraint, which are only updated when the model is collecting statistics (see Morphology::setCollectStatistics())
+    const HotPathCounters & counters() const;
+    void resetCounters() const;
+
     static QString XML_MATCH_EXPRESSION;
     static QString XML_OPTIONAL;
     static QString XML_IGNORE_WHEN_PARSING;
@@ -69,12 +84,18 @@ protected:
     void readCommonAttributes(QXmlStreamReader &in);
     void setType(const Type &type);
 
+    //! \brief Returns true if \a re matches the \a length code units of \a text starting at \a position, without copying them. If \a contextLength is not -1, \a re must be anchored at the end and match at most that many code units (see expressionContextLength()), and only the end of the text is searched.
+    static bool matchesText(const QRegularExpression & re, const QString & text, int position, int length, int contextLength = -1);
+    //! \brief Returns the context length of \a re to pass to matchesText(), or -1 if the whole text has to be searched
+    static int expressionContextLength(const QRegularExpression & re);
+
 protected:
     QString mId;
     Type mType;
 
 private:
     QList<IgnoreFlag> mIgnoreFlags;
+    mutable HotPathCounters mCounters;
 };
 
 } // namespace ME
@@ -56,6 +56,30 @@ bool AbstractNestedConstraint::isLongDistanceConstraint() const
     return true;
 }
 
+bool AbstractNestedConstraint::isResolved() const
+{
+    foreach( const AbstractConstraint * ac, mConstraints )
+    {
+        if( ! ac->isResolved() )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AbstractNestedConstraint::isCostly() const
+{
+    foreach( const AbstractConstraint * ac, mConstraints )
+    {
+        if( ac->isCostly() )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 int AbstractNestedConstraint::count() const
 {
     return mConstraints.count();
@@ -22,12 +22,12 @@ bool BoundCondition::matchesThisConstraint(const Parsing *parsing, const Abstrac
     Q_UNUSED(node)
     Q_UNUSED(allomorph)
 
-    return parsing->steps().length() > 1;
+    return parsing->stepCount() > 1;
 }
 
 bool BoundCondition::satisfied(const Parsing *p) const
 {
-    return p->steps().length() > 1;
+    return p->stepCount() > 1;
 }
 
 QString BoundCondition::elementName()
@@ -29,16 +29,28 @@ bool FollowingPhonologicalCondition::matchesThisConstraint(const Parsing *parsin
 {
     Q_UNUSED( node )
 
+    QHash<WritingSystem,QRegularExpression>::const_iterator re = mRegularExpressions.constFind( parsing->writingSystem() );
+    if( re == mRegularExpressions.constEnd() )
+    {
+        /// an empty expression matches anything
+        return true;
+    }
+
     /// When considering a candidate allomorph, we need to look at the text of that allomorph
-    Form remainder = allomorph.form( parsing->writingSystem() );
-    QRegularExpression re = mRegularExpressions.value( parsing->writingSystem() );
-    QRegularExpressionMatch match = re.match(remainder.text());
-    return match.hasMatch();
+    const Form * remainder = allomorph.formPointer( parsing->writingSystem() );
+    const QString text = remainder == nullptr ? QString() : remainder->text();
+    return matchesText( re.value(), text, 0, text.length(), mContextLengths.value( parsing->writingSystem(), -1 ) );
+}
+
+bool FollowingPhonologicalCondition::isCostly() const
+{
+    return true;
 }
 
 void FollowingPhonologicalCondition::addRegularExpression(const WritingSystem &ws, const QRegularExpression &re)
 {
     mRegularExpressions.insert(ws, re);
+    mContextLengths.insert(ws, expressionContextLength(re) );
 }
 
 QString FollowingPhonologicalCondition::elementName()
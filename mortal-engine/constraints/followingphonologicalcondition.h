@@ -16,6 +16,7 @@ public:
     ~FollowingPhonologicalCondition() override;
 
     bool matchesThisConstraint( const Parsing * parsing, const AbstractNode *node, const Allomorph &allomorph ) const override;
+    bool isCostly() const override;
 
     /**
      * @brief Returns a string representation of the Form for logging purposes.
@@ -32,6 +33,8 @@ public:
 
 private:
     QHash<WritingSystem,QRegularExpression> mRegularExpressions;
+    /// for expressions anchored at the end, the number of code units at the end of the text that they can match; otherwise -1
+    QHash<WritingSystem,int> mContextLengths;
 };
 
 } // namespace ME
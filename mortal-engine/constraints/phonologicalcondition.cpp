@@ -27,15 +27,26 @@ bool PhonologicalCondition::matchesThisConstraint(const Parsing *parsing, const
 {
     Q_UNUSED(node)
     Q_UNUSED(allomorph)
-    Form soFar = parsing->parsedSoFar();
-    QRegularExpression re = mRegularExpressions.value( parsing->writingSystem() );
-    QRegularExpressionMatch match = re.match(soFar.text());
-    return match.hasMatch();
+    QHash<WritingSystem,QRegularExpression>::const_iterator re = mRegularExpressions.constFind( parsing->writingSystem() );
+    if( re == mRegularExpressions.constEnd() )
+    {
+        /// an empty expression matches anything
+        return true;
+    }
+
+    /// match on the text parsed so far without copying it
+    return matchesText( re.value(), parsing->form().text(), 0, parsing->position(), mContextLengths.value( parsing->writingSystem(), -1 ) );
+}
+
+bool PhonologicalCondition::isCostly() const
+{
+    return true;
 }
 
 void PhonologicalCondition::addRegularExpression(const WritingSystem &ws, const QRegularExpression &re)
 {
     mRegularExpressions.insert(ws, re);
+    mContextLengths.insert(ws, expressionContextLength(re) );
 }
 
 QString PhonologicalCondition::elementName()
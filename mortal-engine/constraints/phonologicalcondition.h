@@ -14,6 +14,7 @@ public:
     ~PhonologicalCondition() override;
 
     bool matchesThisConstraint( const Parsing * parsing, const AbstractNode *node, const Allomorph &allomorph ) const override;
+    bool isCostly() const override;
 
     /**
      * @brief Returns a string representation of the Form for logging purposes.
@@ -30,6 +31,8 @@ public:
 
 private:
     QHash<WritingSystem,QRegularExpression> mRegularExpressions;
+    /// for expressions anchored at the end, the number of code units at the end of the text that they can match; otherwise -1
+    QHash<WritingSystem,int> mContextLengths;
 };
 
 } // namespace ME
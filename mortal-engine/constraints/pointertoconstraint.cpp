@@ -106,6 +106,16 @@ bool PointerToConstraint::isLongDistanceConstraint() const
     return mTheConstraint->isLongDistanceConstraint();
 }
 
+bool PointerToConstraint::isResolved() const
+{
+    return mTheConstraint != nullptr && mTheConstraint->isResolved();
+}
+
+bool PointerToConstraint::isCostly() const
+{
+    return mTheConstraint != nullptr && mTheConstraint->isCostly();
+}
+
 QString PointerToConstraint::summary(const QString &suffix) const
 {
     QString dbgString;
@@ -35,6 +35,8 @@ public:
     bool isMatchCondition() const override;
     bool isLocalConstraint() const override;
     bool isLongDistanceConstraint() const override;
+    bool isResolved() const override;
+    bool isCostly() const override;
 
 
 private:
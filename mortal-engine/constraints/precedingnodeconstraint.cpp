@@ -20,7 +20,7 @@ bool PrecedingNodeConstraint::matchesThisConstraint(const Parsing *parsing, cons
     Q_UNUSED(allomorph)
 
     /// there has to be a preceding node
-    if( parsing->steps().count() < 1 )
+    if( parsing->stepCount() < 1 )
     {
         return false;
     }
@@ -35,6 +35,11 @@ bool PrecedingNodeConstraint::matchesThisConstraint(const Parsing *parsing, cons
     return false;
 }
 
+AbstractConstraint::History PrecedingNodeConstraint::historyInspected() const
+{
+    return AbstractConstraint::PrecedingStep;
+}
+
 bool PrecedingNodeConstraint::matchImmediatelyPreceding(const Parsing *parsing) const
 {
     switch( mIdentifier )
@@ -42,9 +47,9 @@ bool PrecedingNodeConstraint::matchImmediatelyPreceding(const Parsing *parsing)
     case PrecedingNodeConstraint::Null:
         return false;
     case PrecedingNodeConstraint::Id:
-        return parsing->steps().constLast().lastNodeMatchesId( NodeId(mIdentifierString) );
+        return parsing->lastStep().lastNodeMatchesId( NodeId(mIdentifierString) );
     case PrecedingNodeConstraint::Label:
-        return parsing->steps().constLast().lastNodeMatchesLabel( MorphemeLabel(mIdentifierString) );
+        return parsing->lastStep().lastNodeMatchesLabel( MorphemeLabel(mIdentifierString) );
     }
     return false;
 }
@@ -56,9 +61,9 @@ bool PrecedingNodeConstraint::matchAnyPreceding(const Parsing *parsing) const
     case PrecedingNodeConstraint::Null:
         return false;
     case PrecedingNodeConstraint::Id:
-        return parsing->steps().constLast().anyNodeMatchesId( NodeId(mIdentifierString) );
+        return parsing->lastStep().anyNodeMatchesId( NodeId(mIdentifierString) );
     case PrecedingNodeConstraint::Label:
-        return parsing->steps().constLast().anyNodeMatchesLabel( MorphemeLabel(mIdentifierString) );
+        return parsing->lastStep().anyNodeMatchesLabel( MorphemeLabel(mIdentifierString) );
     }
     return false;
 }
@@ -15,6 +15,9 @@ public:
 
     bool matchesThisConstraint( const Parsing * parsing, const AbstractNode *node, const Allomorph &allomorph ) const override;
 
+    //! \brief Both scopes only examine the last step of the parsing
+    History historyInspected() const override;
+
     /**
      * @brief Returns a string representation of the Form for logging purposes.
      *
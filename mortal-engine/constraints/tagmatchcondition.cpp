@@ -94,13 +94,31 @@ bool TagMatchCondition::matchesThisConstraint(const Parsing *parsing, const Abst
     return false;
 }
 
+AbstractConstraint::History TagMatchCondition::historyInspected() const
+{
+    switch( mSearchScope )
+    {
+    case TagMatchCondition::AnyPreceding:
+    case TagMatchCondition::AnyFollowing:
+        return AbstractConstraint::AllSteps;
+    case TagMatchCondition::ImmediatelyPreceding:
+        return AbstractConstraint::PrecedingStep;
+    case TagMatchCondition::ImmediatelyFollowing:
+    case TagMatchCondition::Self:
+    case TagMatchCondition::NullScope:
+        break;
+    }
+    return AbstractConstraint::NoHistory;
+}
+
 bool TagMatchCondition::matchAnyPreceding(const Parsing *parsing) const
 {
     if( mInterruptTags.isEmpty() )
     {
-        foreach( ParsingStep ps, parsing->steps() )
+        ParsingStepChain::Iterator i( parsing->stepIterator() );
+        while(i.hasNext())
         {
-            if( match(ps.allomorph()) )
+            if( match(i.next().allomorphRef()) )
             {
                 return true;
             }
@@ -110,15 +128,15 @@ bool TagMatchCondition::matchAnyPreceding(const Parsing *parsing) const
     else
     {
         bool precedingMatchWithoutInterrupt = false;
-        QListIterator<ParsingStep> i( parsing->steps() );
+        ParsingStepChain::Iterator i( parsing->stepIterator() );
         while(i.hasNext())
         {
-            ParsingStep ps = i.next();
-            if( match(ps.allomorph()) )
+            const ParsingStep & ps = i.next();
+            if( match(ps.allomorphRef()) )
             {
                 precedingMatchWithoutInterrupt = true;
             }
-            if( matchInterrupt(ps.allomorph()) )
+            if( matchInterrupt(ps.allomorphRef()) )
             {
                 precedingMatchWithoutInterrupt = false;
             }
@@ -129,13 +147,13 @@ bool TagMatchCondition::matchAnyPreceding(const Parsing *parsing) const
 
 bool TagMatchCondition::matchImmediatelyPreceding(const Parsing *parsing) const
 {
-    if( parsing->steps().count() == 0 )
+    if( parsing->stepCount() == 0 )
     {
         return false;
     }
 
-    ParsingStep ps = parsing->steps().constLast();
-    if( match( ps.allomorph() ) )
+    const ParsingStep & ps = parsing->lastStep();
+    if( match( ps.allomorphRef() ) )
     {
         return true;
     }
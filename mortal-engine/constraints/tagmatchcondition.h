@@ -27,6 +27,8 @@ public:
 
     bool matchesThisConstraint( const Parsing * parsing, const AbstractNode *node, const Allomorph &allomorph ) const override;
 
+    History historyInspected() const override;
+
     bool matchAnyPreceding(const Parsing * parsing) const;
     bool matchImmediatelyPreceding( const Parsing * parsing ) const;
 
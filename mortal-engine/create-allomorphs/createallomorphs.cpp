@@ -23,6 +23,12 @@ CreateAllomorphs::CreateAllomorphs() : mOtherwiseMode(Default)
 
 QSet<Allomorph> CreateAllomorphs::generateAllomorphs(const Allomorph & original) const
 {
+    /// if no case can change the allomorph, no case creates a new allomorph, so the original is returned as the singleton member of the set
+    if( !mMatcher.mightChange( original ) )
+    {
+        return QSet<Allomorph>() << original;
+    }
+
     QSet<Allomorph> allomorphs;
 
     /// generate an allomorph for each case
@@ -77,6 +83,7 @@ void CreateAllomorphs::setOtherwiseMode(CreateAllomorphs::OtherwiseMode mode)
 void CreateAllomorphs::addCase(CreateAllomorphsCase c)
 {
     mCases << c;
+    mMatcher.addMatcher( c.matcher() );
 }
 
 QString CreateAllomorphs::elementName()
@@ -118,6 +125,8 @@ CreateAllomorphs CreateAllomorphs::readFromXml(QXmlStreamReader &in, MorphologyX
         }
     }
 
+    ca.mMatcher.compile();
+
     Q_ASSERT( in.isEndElement() && in.name() == elementName() );
     return ca;
 }
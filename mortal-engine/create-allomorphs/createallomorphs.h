@@ -7,12 +7,14 @@ class QXmlStreamReader;
 
 #include <QSet>
 
+#include "mortal-engine_global.h"
+
 namespace ME {
 
 class Allomorph;
 class MorphologyXmlReader;
 
-class CreateAllomorphs
+class MORTAL_ENGINE_EXPORT CreateAllomorphs
 {
 public:
     enum OtherwiseMode { Default, None, Override };
@@ -50,6 +52,8 @@ private:
     CreateAllomorphsCase mOtherwiseOverride;
     OtherwiseMode mOtherwiseMode;
     QString mId;
+    /// the expressions of every case, to skip allomorphs that no case can change
+    CreateAllomorphsMatcher mMatcher;
 };
 
 } // namespace ME
@@ -8,6 +8,8 @@
 #include "morphology.h"
 
 #include <QXmlStreamReader>
+#include <QMutex>
+#include <QMutexLocker>
 
 using namespace ME;
 
@@ -22,7 +24,15 @@ QString CreateAllomorphsCase::XML_REMOVE_TAG = "remove-tag";
 QString CreateAllomorphsCase::XML_TOLERATE_DUPLICATES = "tolerate-duplicates";
 QString CreateAllomorphsCase::XML_TRUE = "true";
 
-CreateAllomorphsCase::CreateAllomorphsCase() : mFormsMode(IncludeAllForms), mTolerateDuplicates(false)
+struct CreateAllomorphsCase::ReplacementCache
+{
+    /// stems are given their allomorphs in several threads at once (see AbstractStemList::generateAllomorphsFromRules)
+    QMutex mutex;
+    /// form ending → the ending after the replacements, and whether it was changed
+    QHash<WritingSystem, QHash<QString, QPair<QString,bool> > > results;
+};
+
+CreateAllomorphsCase::CreateAllomorphsCase() : mFormsMode(IncludeAllForms), mTolerateDuplicates(false), mReplacementCache(new ReplacementCache)
 {
 
 }
@@ -34,6 +44,12 @@ Allomorph CreateAllomorphsCase::createAllomorph(const Allomorph & input, const Q
     /// Otherwise, return the nullptr
     ///
 
+    /// if none of the replacements can change any form of the allomorph, the case doesn't apply
+    if( !mMatcher.mightChange( input ) )
+    {
+        return Allomorph(Allomorph::Null);
+    }
+
     /// if the allomorph doesn't match the tags for this case, return nullptr (i.e., don't apply)
     if( ! input.tags().contains( mMatchTags ) || ( !mNotMatchTags.isEmpty() && input.tags().intersects( mNotMatchTags ) ) )
     {
@@ -64,12 +80,10 @@ Allomorph CreateAllomorphsCase::createAllomorph(const Allomorph & input, const Q
         Form original = f;
         bool formChanged = false;
 
-        /// perform all the replacements
-        for(int i=0; i<mReplacements.count(); i++)
+        /// perform all the replacements, unless none of them can change the form
+        if( mMatcher.mightChange( f ) )
         {
-            bool changedThisTime = false;
-            f = mReplacements.at(i).perform(f, changedThisTime);
-            formChanged = formChanged || changedThisTime;
+            f = performReplacements( f, formChanged );
         }
 
         /// this checks whether this form is available somewhere else in the set of allomorphs
@@ -115,6 +129,68 @@ Allomorph CreateAllomorphsCase::createAllomorph(const Allomorph & input, const Q
     }
 }
 
+Form CreateAllomorphsCase::performReplacements(const Form &form, bool &changed) const
+{
+    const int contextLength = mContextLengths.value( form.writingSystem(), -1 );
+    const QString text = form.text();
+    /// $ can also match before a final newline, which would put the match outside of the ending
+    if( contextLength == -1 || text.contains('\n') )
+    {
+        return performReplacementsUncached( form, changed );
+    }
+
+    int start = qMax( 0, text.length() - contextLength );
+    /// don't split a surrogate pair
+    if( start > 0 && text.at(start).isLowSurrogate() )
+    {
+        start--;
+    }
+    const QString ending = text.mid( start );
+
+    {
+        QMutexLocker locker( &mReplacementCache->mutex );
+        const QHash<QString, QPair<QString,bool> > & results = mReplacementCache->results[ form.writingSystem() ];
+        QHash<QString, QPair<QString,bool> >::const_iterator cached = results.constFind( ending );
+        if( cached != results.constEnd() )
+        {
+            changed = cached.value().second;
+            Form newForm = form;
+            newForm.setText( text.left(start) + cached.value().first );
+            return newForm;
+        }
+    }
+
+    /// every change falls within the ending, and the replacements can't see past its start, so the replacements
+    /// can be performed on the ending alone
+    Form endingForm = form;
+    endingForm.setText( ending );
+    bool endingChanged = false;
+    const QString newEnding = performReplacementsUncached( endingForm, endingChanged ).text();
+
+    {
+        QMutexLocker locker( &mReplacementCache->mutex );
+        mReplacementCache->results[ form.writingSystem() ].insert( ending, qMakePair( newEnding, endingChanged ) );
+    }
+
+    changed = endingChanged;
+    Form newForm = form;
+    newForm.setText( text.left(start) + newEnding );
+    return newForm;
+}
+
+Form CreateAllomorphsCase::performReplacementsUncached(const Form &form, bool &changed) const
+{
+    Form f = form;
+    changed = false;
+    for(int i=0; i<mReplacements.count(); i++)
+    {
+        bool changedThisTime = false;
+        f = mReplacements.at(i).perform(f, changedThisTime);
+        changed = changed || changedThisTime;
+    }
+    return f;
+}
+
 QString CreateAllomorphsCase::elementName()
 {
     return "case";
@@ -196,6 +272,8 @@ CreateAllomorphsCase CreateAllomorphsCase::readFromXml(QXmlStreamReader &in, Mor
         }
     }
 
+    c.mMatcher.compile();
+
     Q_ASSERT( in.isEndElement() && in.name() == elementName() );
     return c;
 }
@@ -228,6 +306,19 @@ void CreateAllomorphsCase::addConstraints(const QSet<const AbstractConstraint *>
 void CreateAllomorphsCase::addReplacement(const CreateAllomorphsReplacement &r)
 {
     mReplacements << r;
+    mMatcher.addPatterns( r.replaceThisExpressions() );
+
+    /// each replacement changes at most its own context length from the end, but a later replacement
+    /// may look back past what an earlier one wrote, so the context of the case is the sum
+    QHashIterator<WritingSystem,QRegularExpression> i( r.replaceThisExpressions() );
+    while( i.hasNext() )
+    {
+        i.next();
+        const int previous = mContextLengths.value( i.key(), 0 );
+        const int length = r.contextLength( i.key() );
+        mContextLengths.insert( i.key(), previous == -1 || length == -1 ? -1 : previous + length );
+    }
+    mReplacementCache.reset( new ReplacementCache );
 }
 
 QSet<const AbstractConstraint *> CreateAllomorphsCase::constraints() const
@@ -267,6 +358,11 @@ void CreateAllomorphsCase::setTolerateDuplicates(bool tolerateDuplicates)
     mTolerateDuplicates = tolerateDuplicates;
 }
 
+const CreateAllomorphsMatcher &CreateAllomorphsCase::matcher() const
+{
+    return mMatcher;
+}
+
 QString CreateAllomorphsCase::summary() const
 {
     QString dbgString;
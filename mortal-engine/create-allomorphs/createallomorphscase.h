@@ -3,8 +3,10 @@
 
 #include <QSet>
 #include <QList>
+#include <QSharedPointer>
 
 #include "createallomorphsreplacement.h"
+#include "createallomorphsmatcher.h"
 #include "datatypes/tag.h"
 
 class QXmlStreamReader;
@@ -64,7 +66,14 @@ public:
 
     void setTolerateDuplicates(bool tolerateDuplicates);
 
+    //! \brief Returns the matcher for the replacements of this case
+    const CreateAllomorphsMatcher & matcher() const;
+
 private:
+    //! \brief Performs the replacements on \a form, reusing the result for another form with the same ending when the replacements only look at the end of the form (see CreateAllomorphsReplacement::contextLength)
+    Form performReplacements(const Form & form, bool & changed) const;
+    Form performReplacementsUncached(const Form & form, bool & changed) const;
+
     QSet<const AbstractConstraint *> mConstraints;
     QList<CreateAllomorphsReplacement> mReplacements;
     QSet<Tag> mMatchTags;
@@ -74,6 +83,13 @@ private:
     QSet<Tag> mAddTags;
     QSet<Tag> mRemoveTags;
     bool mTolerateDuplicates;
+    CreateAllomorphsMatcher mMatcher;
+
+    /// for each writing system, the number of code units at the end of a form that the replacements can look at and change, or -1 if the replacements can look at the whole form
+    QHash<WritingSystem,int> mContextLengths;
+    /// the results of the replacements by form ending. Copies of the case share the cache, since they have the same replacements.
+    struct ReplacementCache;
+    QSharedPointer<ReplacementCache> mReplacementCache;
 };
 
 } // namespace ME
@@ -0,0 +1,124 @@
+#include "createallomorphsmatcher.h"
+
+#include "datatypes/form.h"
+#include "datatypes/allomorph.h"
+
+using namespace ME;
+
+CreateAllomorphsMatcher::CreateAllomorphsMatcher() : mCompiled(false)
+{
+
+}
+
+void CreateAllomorphsMatcher::addPatterns(const QHash<WritingSystem, QRegularExpression> &patterns)
+{
+    QHashIterator<WritingSystem,QRegularExpression> i(patterns);
+    while( i.hasNext() )
+    {
+        i.next();
+        if( canBeCombined( i.value() ) )
+        {
+            mPatterns[ i.key() ] << i.value().pattern();
+        }
+        else
+        {
+            mUnfiltered << i.key();
+        }
+    }
+    mCompiled = false;
+}
+
+void CreateAllomorphsMatcher::addMatcher(const CreateAllomorphsMatcher &other)
+{
+    QHashIterator<WritingSystem,QStringList> i(other.mPatterns);
+    while( i.hasNext() )
+    {
+        i.next();
+        mPatterns[ i.key() ] << i.value();
+    }
+    mUnfiltered.unite( other.mUnfiltered );
+    mCompiled = false;
+}
+
+void CreateAllomorphsMatcher::compile()
+{
+    mCombined.clear();
+
+    QHashIterator<WritingSystem,QStringList> i(mPatterns);
+    while( i.hasNext() )
+    {
+        i.next();
+        if( mUnfiltered.contains( i.key() ) )
+        {
+            continue;
+        }
+
+        /// each expression is placed in a non-capturing group so that its alternations and inline options stay with it
+        QStringList alternatives;
+        foreach( QString pattern, i.value() )
+        {
+            alternatives << "(?:" + pattern + ")";
+        }
+
+        const QRegularExpression combined( alternatives.join("|"), QRegularExpression::UseUnicodePropertiesOption );
+        if( combined.isValid() )
+        {
+            mCombined.insert( i.key(), combined );
+        }
+        else
+        {
+            /// e.g., two expressions have a named group with the same name
+            mUnfiltered << i.key();
+        }
+    }
+
+    mCompiled = true;
+}
+
+bool CreateAllomorphsMatcher::mightChange(const Form &form) const
+{
+    if( !mCompiled || mUnfiltered.contains( form.writingSystem() ) )
+    {
+        return true;
+    }
+
+    QHash<WritingSystem,QRegularExpression>::const_iterator i = mCombined.constFind( form.writingSystem() );
+    if( i == mCombined.constEnd() )
+    {
+        /// no replacement applies to this writing system
+        return false;
+    }
+    return i.value().match( form.text() ).hasMatch();
+}
+
+bool CreateAllomorphsMatcher::mightChange(const Allomorph &allomorph) const
+{
+    if( !mCompiled )
+    {
+        return true;
+    }
+
+    QHashIterator<WritingSystem,Form> i( allomorph.forms() );
+    while( i.hasNext() )
+    {
+        i.next();
+        if( mightChange( i.value() ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CreateAllomorphsMatcher::canBeCombined(const QRegularExpression &re)
+{
+    if( !re.isValid() )
+    {
+        return false;
+    }
+
+    /// constructs that refer to groups by number, or whose meaning would change in an alternation:
+    /// backreferences, subroutine calls, conditions, verbs like (*COMMIT), \Q without \E, and comments
+    static const QRegularExpression unsafe( "\\\\[0-9gkQ]|\\(\\?P?[=>&]|\\(\\?[-+]?[0-9R]|\\(\\?\\(|\\(\\*|#" );
+    return !unsafe.match( re.pattern() ).hasMatch();
+}
@@ -0,0 +1,56 @@
+/*!
+  \class CreateAllomorphsMatcher
+  \brief A prefilter for CreateAllomorphs rules, which tells with one regular expression match per form whether any of a set of replacements could change that form.
+
+  The replace-this expressions of each writing system are compiled, when the model is read, into a single alternation. A form whose text matches none of the expressions is left unchanged by every replacement, even when they are applied one after another, so the replacements do not need to be tried. If the alternation matches, the replacements are performed as usual, so the results are exactly those of applying them one by one.
+
+  Expressions that cannot be placed in an alternation without changing their meaning (e.g., those with backreferences, which would be renumbered) are never filtered: a form in that writing system is always assumed to match.
+*/
+
+#ifndef CREATEALLOMORPHSMATCHER_H
+#define CREATEALLOMORPHSMATCHER_H
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QRegularExpression>
+#include "datatypes/writingsystem.h"
+
+namespace ME {
+
+class Form;
+class Allomorph;
+
+class CreateAllomorphsMatcher
+{
+public:
+    CreateAllomorphsMatcher();
+
+    //! \brief Adds the replace-this expressions of a replacement, by writing system. The matcher must be compiled again afterward.
+    void addPatterns(const QHash<WritingSystem,QRegularExpression> & patterns);
+
+    //! \brief Adds all of the expressions of \a other. The matcher must be compiled again afterward.
+    void addMatcher(const CreateAllomorphsMatcher & other);
+
+    //! \brief Builds the combined expression for each writing system. Until this is called, mightChange() always returns true.
+    void compile();
+
+    //! \brief Returns false if none of the expressions match \a form, i.e., if no replacement can change it
+    bool mightChange(const Form & form) const;
+
+    //! \brief Returns false if none of the expressions match any form of \a allomorph
+    bool mightChange(const Allomorph & allomorph) const;
+
+private:
+    static bool canBeCombined(const QRegularExpression & re);
+
+    QHash<WritingSystem,QStringList> mPatterns;
+    /// writing systems with an expression that cannot be combined
+    QSet<WritingSystem> mUnfiltered;
+    QHash<WritingSystem,QRegularExpression> mCombined;
+    bool mCompiled;
+};
+
+} // namespace ME
+
+#endif // CREATEALLOMORPHSMATCHER_H
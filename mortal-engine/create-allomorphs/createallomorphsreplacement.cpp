@@ -1,6 +1,7 @@
 #include "createallomorphsreplacement.h"
 
 #include "datatypes/form.h"
+#include "anchoredexpression.h"
 #include "debug.h"
 
 using namespace ME;
@@ -16,6 +17,7 @@ void CreateAllomorphsReplacement::setReplaceThis(const QList<Form> &replaceThis)
     foreach(Form f, replaceThis)
     {
         mReplaceThis.insert( f.writingSystem(), QRegularExpression( f.text(), QRegularExpression::UseUnicodePropertiesOption ) );
+        mContextLengths.insert( f.writingSystem(), AnchoredExpression::contextLength( mReplaceThis.value( f.writingSystem() ) ) );
     }
 }
 
@@ -47,6 +49,26 @@ Form CreateAllomorphsReplacement::perform(const Form &subject, bool &changed) co
     }
 }
 
+QHash<WritingSystem, QRegularExpression> CreateAllomorphsReplacement::replaceThisExpressions() const
+{
+    QHash<WritingSystem,QRegularExpression> expressions;
+    QHashIterator<WritingSystem,QRegularExpression> i(mReplaceThis);
+    while( i.hasNext() )
+    {
+        i.next();
+        if( mWithThis.contains( i.key() ) )
+        {
+            expressions.insert( i.key(), i.value() );
+        }
+    }
+    return expressions;
+}
+
+int CreateAllomorphsReplacement::contextLength(const WritingSystem &ws) const
+{
+    return mContextLengths.value( ws, -1 );
+}
+
 QString CreateAllomorphsReplacement::summary() const
 {
     QString dbgString;
@@ -22,6 +22,12 @@ public:
 
     Form perform( const Form & subject, bool &changed ) const;
 
+    //! \brief Returns the replace-this expressions of the writing systems that also have a with-this form, i.e., those for which perform() can change a form
+    QHash<WritingSystem,QRegularExpression> replaceThisExpressions() const;
+
+    //! \brief Returns the number of UTF-16 code units at the end of a form in \a ws that the replace-this expression can match, if the expression is anchored at the end of the form and matches a bounded number of characters (see AnchoredExpression::contextLength()); otherwise returns -1. Every change that perform() makes falls within that many code units from the end of the form.
+    int contextLength(const WritingSystem & ws) const;
+
     /**
      * @brief Returns a string representation of the Form for logging purposes.
      * 
@@ -32,6 +38,7 @@ public:
 private:
     QHash<WritingSystem,QRegularExpression> mReplaceThis;
     QHash<WritingSystem,QString> mWithThis;
+    QHash<WritingSystem,int> mContextLengths;
     WritingSystem mWritingSystem;
     QSet<Tag> mAddTags;
     QSet<Tag> mRemoveTags;
@@ -26,12 +26,12 @@ QString Allomorph::XML_TRUE = "true";
 QString Allomorph::XML_PORTMANTEAU = "portmanteau";
 QString Allomorph::XML_ID = "id";
 
-Allomorph::Allomorph(Allomorph::Type type) : mType(type), mId(-1), mUseInGenerations(true)
+Allomorph::Allomorph(Allomorph::Type type) : mType(type), mId(-1), mUseInGenerations(true), mConstraintsPartitioned(true)
 {
     calculateHash();
 }
 
-Allomorph::Allomorph(const Form &f, Type type) : mType(type), mId(-1), mUseInGenerations(true)
+Allomorph::Allomorph(const Form &f, Type type) : mType(type), mId(-1), mUseInGenerations(true), mConstraintsPartitioned(true)
 {
     mForms.insert( f.writingSystem(), f );
     calculateHash();
@@ -45,7 +45,11 @@ Allomorph::Allomorph(const Allomorph &other) :
     mPortmanteau(other.mPortmanteau),
     mId(other.mId),
     mHash(other.mHash),
-    mUseInGenerations(other.mUseInGenerations)
+    mUseInGenerations(other.mUseInGenerations),
+    mMatchConditions(other.mMatchConditions),
+    mLocalConstraints(other.mLocalConstraints),
+    mLongDistanceConstraints(other.mLongDistanceConstraints),
+    mConstraintsPartitioned(other.mConstraintsPartitioned)
 {
 }
 
@@ -59,6 +63,10 @@ Allomorph &Allomorph::operator=(const Allomorph & other)
     mId = other.mId;
     mHash = other.mHash;
     mUseInGenerations = other.mUseInGenerations;
+    mMatchConditions = other.mMatchConditions;
+    mLocalConstraints = other.mLocalConstraints;
+    mLongDistanceConstraints = other.mLongDistanceConstraints;
+    mConstraintsPartitioned = other.mConstraintsPartitioned;
     return *this;
 }
 
@@ -82,12 +90,58 @@ void Allomorph::addConstraint(const AbstractConstraint *constraint)
     if( constraint != nullptr )
         mConstraints.insert(constraint);
     calculateHash();
+    partitionConstraints();
 }
 
 void Allomorph::addConstraints(const QSet<const AbstractConstraint *> &constraints)
 {
+    if( constraints.isEmpty() )
+        return;
     mConstraints.unite(constraints);
     calculateHash();
+    partitionConstraints();
+}
+
+void Allomorph::partitionConstraints()
+{
+    mMatchConditions.clear();
+    mLocalConstraints.clear();
+    mLongDistanceConstraints.clear();
+
+    /// the type of a constraint that points to another constraint is not known
+    /// until the pointers have been filled in, so the accessors have to work it
+    /// out on the fly until this is called again
+    foreach( const AbstractConstraint * c, mConstraints )
+    {
+        if( ! c->isResolved() )
+        {
+            mConstraintsPartitioned = false;
+            return;
+        }
+    }
+
+    /// check the cheap match conditions first, since any of them can rule out the allomorph
+    QList<const AbstractConstraint *> costly;
+    foreach( const AbstractConstraint * c, mConstraints )
+    {
+        if( c->isMatchCondition() )
+        {
+            if( c->isCostly() )
+                costly << c;
+            else
+                mMatchConditions << c;
+        }
+        if( c->isLocalConstraint() )
+        {
+            mLocalConstraints << c;
+        }
+        if( c->isLongDistanceConstraint() )
+        {
+            mLongDistanceConstraints << c;
+        }
+    }
+    mMatchConditions << costly;
+    mConstraintsPartitioned = true;
 }
 
 void Allomorph::addTag(const QString &tag)
@@ -139,6 +193,12 @@ Form Allomorph::form(const WritingSystem &ws, bool *ok) const
     return mForms.value( ws, Form(ws, "") );
 }
 
+const Form *Allomorph::formPointer(const WritingSystem &ws) const
+{
+    QHash<WritingSystem,Form>::const_iterator i = mForms.constFind( ws );
+    return i == mForms.constEnd() ? nullptr : &i.value();
+}
+
 void Allomorph::clearForms()
 {
     mForms.clear();
@@ -155,21 +215,27 @@ bool Allomorph::hasForm(const Form &form) const
     return mForms.value( form.writingSystem() ) == form;
 }
 
-QSet<const AbstractConstraint *> Allomorph::matchConditions() const
+QList<const AbstractConstraint *> Allomorph::matchConditions() const
 {
-    QSet<const AbstractConstraint *> set;
+    if( mConstraintsPartitioned )
+        return mMatchConditions;
+
+    QList<const AbstractConstraint *> list;
     foreach( const AbstractConstraint * c, mConstraints )
     {
         if( c->isMatchCondition() )
         {
-            set << c;
+            list << c;
         }
     }
-    return set;
+    return list;
 }
 
 QSet<const AbstractConstraint *> Allomorph::localConstraints() const
 {
+    if( mConstraintsPartitioned )
+        return mLocalConstraints;
+
     QSet<const AbstractConstraint *> set;
     foreach( const AbstractConstraint * c, mConstraints )
     {
@@ -183,6 +249,9 @@ QSet<const AbstractConstraint *> Allomorph::localConstraints() const
 
 QSet<const AbstractConstraint *> Allomorph::longDistanceConstraints() const
 {
+    if( mConstraintsPartitioned )
+        return mLongDistanceConstraints;
+
     QSet<const AbstractConstraint *> set;
     foreach( const AbstractConstraint * c, mConstraints )
     {
@@ -81,6 +81,11 @@ public:
     void addConstraint(const AbstractConstraint * constraint);
     void addConstraints(const QSet<const AbstractConstraint *> &constraints);
 
+    /**
+     * @brief Sorts the constraints into match conditions, local constraints, and long distance constraints, so that the accessors do not have to. This is done whenever constraints are added, but it needs to be done again once any PointerToConstraint objects have been filled in.
+     */
+    void partitionConstraints();
+
     /**
      * @brief Adds the given \a tag to teh allomorph
      * 
@@ -120,6 +125,15 @@ public:
      */
     Form form( const WritingSystem & ws, bool * ok = nullptr ) const;
 
+    /**
+     * @brief Returns a pointer to the Form for the given WritingSystem, or nullptr if there is none. Unlike form(),
+     * this does not copy the Form. The pointer is valid until the Allomorph is changed or destroyed.
+     *
+     * @param ws
+     * @return const Form* The requested form, or nullptr
+     */
+    const Form * formPointer( const WritingSystem & ws ) const;
+
     /**
      * @brief Remove all forms from the Allomorph.
      * 
@@ -161,11 +175,11 @@ public:
     QString focusedSummary(const WritingSystem & ws) const;
 
     /**
-     * @brief Returns the Allomorphs's match condition constraints (i.e., AbstractConstraint::MatchCondition)
+     * @brief Returns the Allomorphs's match condition constraints (i.e., AbstractConstraint::MatchCondition), with the costly ones (see AbstractConstraint::isCostly) at the end
      * 
-     * @return QSet<const AbstractConstraint *> the set of constraints
+     * @return QList<const AbstractConstraint *> the list of constraints
      */
-    QSet<const AbstractConstraint *> matchConditions() const;
+    QList<const AbstractConstraint *> matchConditions() const;
 
     /**
      * @brief Returns the Allomorphs's local constraints (i.e., AbstractConstraint::LocalConstraint)
@@ -263,6 +277,12 @@ private:
     qlonglong mId;
     uint mHash;
     bool mUseInGenerations;
+
+    /// precomputed by partitionConstraints(); these are implicitly shared, so returning them does not allocate
+    QList<const AbstractConstraint *> mMatchConditions;
+    QSet<const AbstractConstraint *> mLocalConstraints;
+    QSet<const AbstractConstraint *> mLongDistanceConstraints;
+    bool mConstraintsPartitioned;
 };
 
 Q_DECL_EXPORT uint qHash(const ME::Allomorph &key);
@@ -44,7 +44,7 @@ void Generation::append(const AbstractNode *node, const Allomorph & allomorph, c
 
         ParsingStep ps(node, allomorph, lexicalStem);
         ps.setIsStem(isStem);
-        mSteps.append( ps );
+        appendStep( ps );
 
         /// remove a morpheme from the morpheme sequence constraint
         /// i.e., move on to the next morpheme in the sequence
@@ -65,10 +65,10 @@ void Generation::append(const AbstractNode *node, const Allomorph & allomorph, c
     else
     {
         /// helpful debug if a parsing fails
-        parsingLog()->constraintsSetSatisfactionSummary("constraints",this, mLocalConstraints, node, allomorph);
+        if( parsingLog()->isEnabled() )
+            parsingLog()->constraintsSetSatisfactionSummary("constraints",this, mLocalConstraints, node, allomorph);
         setStatus( Parsing::Failed );
     }
-    calculateHash();
 }
 
 void Generation::setCompleteIfAllConstraintsSatisfied()
@@ -127,7 +127,7 @@ bool Generation::ableToAppend(const MorphemeLabel &label) const
     bool mscFailed = mMorphemeSequenceConstraint.currentMorpheme() != label;
     if( mscHasNoMoreMorphemes || mscFailed )
     {
-        parsingLog()->info( QString("MSC has no more morphemes: %1; MSC failed: %2 (expecting: %3, trying to append %4).").arg(mscHasNoMoreMorphemes ? "true" : "false").arg(mscFailed ? "true" : "false").arg(mMorphemeSequenceConstraint.currentMorpheme().toString()).arg(label.toString()) );
+        parsingLog()->deferredInfo( [&]{ return QString("MSC has no more morphemes: %1; MSC failed: %2 (expecting: %3, trying to append %4).").arg(mscHasNoMoreMorphemes ? "true" : "false").arg(mscFailed ? "true" : "false").arg(mMorphemeSequenceConstraint.currentMorpheme().toString()).arg(label.toString()); } );
         return false;
     }
     else
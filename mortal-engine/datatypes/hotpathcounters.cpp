@@ -0,0 +1,67 @@
+#include "hotpathcounters.h"
+
+using namespace ME;
+
+HotPathCounters::HotPathCounters()
+{
+    reset();
+}
+
+HotPathCounters::HotPathCounters(const HotPathCounters &other)
+{
+    for(int i=0; i < CounterCount; i++)
+    {
+        mValues[i].storeRelaxed( other.mValues[i].loadRelaxed() );
+    }
+}
+
+HotPathCounters &HotPathCounters::operator=(const HotPathCounters &other)
+{
+    for(int i=0; i < CounterCount; i++)
+    {
+        mValues[i].storeRelaxed( other.mValues[i].loadRelaxed() );
+    }
+    return *this;
+}
+
+bool HotPathCounters::isEmpty() const
+{
+    for(int i=0; i < CounterCount; i++)
+    {
+        if( mValues[i].loadRelaxed() != 0 )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HotPathCounters::reset()
+{
+    for(int i=0; i < CounterCount; i++)
+    {
+        mValues[i].storeRelaxed( 0 );
+    }
+}
+
+QString HotPathCounters::counterName(Counter counter)
+{
+    switch( counter )
+    {
+    case HotPathCounters::Visits:
+        return "visits";
+    case HotPathCounters::AllomorphsTested:
+        return "allomorphs-tested";
+    case HotPathCounters::SegmentalMatches:
+        return "segmental-matches";
+    case HotPathCounters::ConditionRejections:
+        return "condition-rejections";
+    case HotPathCounters::CandidatesProduced:
+        return "candidates";
+    case HotPathCounters::Nanoseconds:
+        return "ns";
+    case HotPathCounters::CounterCount:
+        break;
+    }
+    return "";
+}
@@ -0,0 +1,46 @@
+/*!
+  \class HotPathCounters
+  \brief A set of counters for one node or constraint, which records how often it is used while parsing and how long that takes. Each AbstractNode and AbstractConstraint has one.
+
+  The counters are only updated when Morphology::setCollectStatistics() is on, so they cost nothing but a flag check otherwise. They are atomic, so they can be updated by several parsing threads at once. See Morphology::statistics().
+*/
+
+#ifndef HOTPATHCOUNTERS_H
+#define HOTPATHCOUNTERS_H
+
+#include <QAtomicInteger>
+#include <QString>
+
+#include "mortal-engine_global.h"
+
+namespace ME {
+
+class MORTAL_ENGINE_EXPORT HotPathCounters
+{
+public:
+    /// Visits: calls to a node, or evaluations of a constraint
+    /// AllomorphsTested, SegmentalMatches, ConditionRejections: allomorphs compared with the input at a node; those that matched segmentally; and those that then failed their match conditions. For a constraint, ConditionRejections is the number of evaluations that failed.
+    /// CandidatesProduced: parsings returned by a node
+    /// Nanoseconds: cumulative time spent in the node or constraint, including the nodes that it calls
+    enum Counter { Visits, AllomorphsTested, SegmentalMatches, ConditionRejections, CandidatesProduced, Nanoseconds, CounterCount };
+
+    HotPathCounters();
+    HotPathCounters(const HotPathCounters & other);
+    HotPathCounters &operator=(const HotPathCounters & other);
+
+    void add(Counter counter, qint64 amount = 1) { mValues[counter].fetchAndAddRelaxed(amount); }
+    qint64 value(Counter counter) const { return mValues[counter].loadRelaxed(); }
+
+    //! \brief Returns true if the node or constraint was not used since the counters were last reset
+    bool isEmpty() const;
+    void reset();
+
+    static QString counterName(Counter counter);
+
+private:
+    QAtomicInteger<qint64> mValues[CounterCount];
+};
+
+} // namespace ME
+
+#endif // HOTPATHCOUNTERS_H
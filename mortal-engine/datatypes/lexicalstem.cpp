@@ -103,6 +103,11 @@ void LexicalStem::generateAllomorphs(const QList<CreateAllomorphs> &cas)
         }
         mAllomorphs = QList<Allomorph>(newAllomorphs.begin(), newAllomorphs.end());
     }
+    /// this is called after constraint pointers have been filled in
+    for(int i=0; i < mAllomorphs.count(); i++ )
+    {
+        mAllomorphs[i].partitionConstraints();
+    }
 }
 
 bool LexicalStem::hasAllomorph(const Allomorph & allomorph, bool matchConstraints) const
@@ -210,6 +215,11 @@ int LexicalStem::allomorphCount() const
     return mAllomorphs.count();
 }
 
+const Allomorph &LexicalStem::allomorph(int index) const
+{
+    return mAllomorphs.at(index);
+}
+
 QListIterator<Allomorph> LexicalStem::allomorphs() const
 {
     return mAllomorphs;
@@ -252,6 +262,8 @@ Allomorph LexicalStem::displayAllomorph(const WritingSystem & forWs) const
 void LexicalStem::initializePortmanteaux(const AbstractNode *parent)
 {
     QHash<MorphemeLabel,const AbstractNode *> cache;
+    /// a copy of an initialized stem is initialized again once its derived allomorphs have been generated
+    mPortmanteaux.clear();
     for(int i=0; i<mAllomorphs.count(); i++)
     {
         QSetIterator<WritingSystem> wsIter( mAllomorphs.at(i).writingSystems() );
@@ -274,6 +286,11 @@ QList<MorphemeSequence> LexicalStem::portmanteaux(const WritingSystem &ws)
     return mPortmanteaux.values(ws);
 }
 
+bool LexicalStem::hasPortmanteaux() const
+{
+    return !mPortmanteaux.isEmpty();
+}
+
 QString LexicalStem::summary() const
 {
     QString dbgString;
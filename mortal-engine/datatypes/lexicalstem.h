@@ -53,6 +53,8 @@ public:
     bool isEmpty() const;
 
     int allomorphCount() const;
+    //! \brief Returns the allomorph at \a index, which must be less than allomorphCount()
+    const Allomorph & allomorph(int index) const;
 
     QListIterator<Allomorph> allomorphs() const;
 
@@ -68,6 +70,8 @@ public:
 
     void initializePortmanteaux(const AbstractNode * parent);
     QList<MorphemeSequence> portmanteaux(const WritingSystem & ws);
+    //! \brief Returns true if initializePortmanteaux() found any portmanteau allomorphs
+    bool hasPortmanteaux() const;
 
 private:
     QList<Allomorph> mAllomorphs;
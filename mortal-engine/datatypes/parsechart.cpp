@@ -0,0 +1,52 @@
+#include "parsechart.h"
+
+#include "hashseed.h"
+
+using namespace ME;
+
+ParseChart::ParseChart(AbstractConstraint::History history) : mHistory(history), mHits(0)
+{
+
+}
+
+bool ParseChart::lookup(const AbstractNode *node, const Parsing &parsing, QList<Parsing> &results) const
+{
+    const uint k = key( node, parsing );
+    QMultiHash<uint, Entry>::const_iterator i = mEntries.constFind( k );
+    while( i != mEntries.constEnd() && i.key() == k )
+    {
+        if( i.value().node == node && i.value().parsing.hasSameState( parsing, mHistory ) )
+        {
+            results.clear();
+            results.reserve( i.value().results.count() );
+            foreach( const Parsing & result, i.value().results )
+            {
+                results << result.rebased( i.value().parsing, parsing );
+            }
+            mHits++;
+            return true;
+        }
+        ++i;
+    }
+    return false;
+}
+
+void ParseChart::insert(const AbstractNode *node, const Parsing &parsing, const QList<Parsing> &results)
+{
+    mEntries.insert( key( node, parsing ), Entry{ node, parsing, results } );
+}
+
+int ParseChart::count() const
+{
+    return mEntries.count();
+}
+
+int ParseChart::hits() const
+{
+    return mHits;
+}
+
+uint ParseChart::key(const AbstractNode *node, const Parsing &parsing) const
+{
+    return qHash( node, HASH_SEED ) ^ parsing.stateHash( mHistory );
+}
@@ -0,0 +1,51 @@
+/*!
+  \class ParseChart
+  \brief A memo table of the parsings that a node produces from a given parsing state. When parsing with Parsing::UseParseChart, branches that converge on the same node with the same state (e.g., via optional nodes, Fork paths, Jumps, or different segmentations of the preceding text) share the results that were computed for the first branch, rather than exploring the rest of the model again.
+
+  The state is the position, jump counters and pending constraints of the parsing (see Parsing::hasSameState()). The steps that have already been appended are only part of the state if something in the model can examine them: the last step if a constraint examines the preceding step, and all of them if a constraint examines any preceding step or the model has portmanteaux (see Morphology::parseChartHistory()). The results that are shared are rebased onto the steps of the branch that reuses them.
+*/
+
+#ifndef PARSECHART_H
+#define PARSECHART_H
+
+#include <QHash>
+#include <QList>
+
+#include "datatypes/parsing.h"
+
+#include "mortal-engine_global.h"
+
+namespace ME {
+
+class AbstractNode;
+
+class MORTAL_ENGINE_EXPORT ParseChart
+{
+public:
+    //! \brief Constructs a chart that compares as many of the parsings' steps as \a history calls for
+    explicit ParseChart(AbstractConstraint::History history);
+
+    //! \brief Sets \a results to the parsings stored for \a node and a parsing with the same state as \a parsing, rebased onto \a parsing, and returns true, or returns false if there is no such entry
+    bool lookup(const AbstractNode * node, const Parsing & parsing, QList<Parsing> & results) const;
+    void insert(const AbstractNode * node, const Parsing & parsing, const QList<Parsing> & results);
+
+    int count() const;
+    int hits() const;
+
+private:
+    struct Entry {
+        const AbstractNode * node;
+        Parsing parsing;
+        QList<Parsing> results;
+    };
+
+    uint key(const AbstractNode * node, const Parsing & parsing) const;
+
+    AbstractConstraint::History mHistory;
+    QMultiHash<uint, Entry> mEntries;
+    mutable int mHits;
+};
+
+} // namespace ME
+
+#endif // PARSECHART_H
@@ -12,19 +12,31 @@
 #include "datatypes/morphemesequence.h"
 #include "datatypes/parsingsummary.h"
 #include "hashseed.h"
+#include "hotpathcounters.h"
 
 using namespace ME;
 
 int Parsing::MAXIMUM_JUMPS = 1;
 
+namespace {
+
+/// folds the hash of one more step into the hash of a parsing
+inline quint64 combineStepHash(quint64 hash, quint64 stepHash)
+{
+    return ( hash ^ ( stepHash * Q_UINT64_C(0x9E3779B97F4A7C15) ) ) * Q_UINT64_C(0x100000001B3);
+}
+
+} // namespace
+
 Parsing::Parsing() :
     mForm( WritingSystem(), "" ),
     mPosition(0),
     mStatus(Parsing::Null),
     mMorphologicalModel(nullptr),
-    mNextNodeRequired(false)
+    mNextNodeRequired(false),
+    mParseChart(nullptr)
 {
-
+    calculateHash();
 }
 
 Parsing::Parsing(const Form &form, const MorphologicalModel *morphologicalModel) :
@@ -32,9 +44,10 @@ Parsing::Parsing(const Form &form, const MorphologicalModel *morphologicalModel)
     mPosition(0),
     mStatus(Parsing::Null),
     mMorphologicalModel(morphologicalModel),
-    mNextNodeRequired(false)
+    mNextNodeRequired(false),
+    mParseChart(nullptr)
 {
-
+    calculateHash();
 }
 
 Parsing::~Parsing()
@@ -54,7 +67,8 @@ Parsing::Parsing(const Parsing &other) :
       mJumpCounts(other.mJumpCounts),
       mNextNodeRequired(other.mNextNodeRequired),
       mStackTrace(other.mStackTrace),
-      mHash(other.mHash)
+      mHash(other.mHash),
+      mParseChart(other.mParseChart)
 {
 }
 
@@ -71,24 +85,14 @@ Parsing &Parsing::operator=(const Parsing &other)
     mNextNodeRequired = other.mNextNodeRequired;
     mStackTrace = other.mStackTrace;
     mHash = other.mHash;
+    mParseChart = other.mParseChart;
 
     return *this;
 }
 
 bool Parsing::operator==(const Parsing &other) const
 {
-    if( labelSummary() != other.labelSummary() )
-        return false;
-    const QList<LexicalStem> myStems = lexicalStems();
-    const QList<LexicalStem> otherStems = other.lexicalStems(); 
-    if( myStems.count() != otherStems.count() )
-        return false;
-    for(int i=0; i<myStems.count(); i++)
-    {
-        if( !( myStems.at(i) == otherStems.at(i) ) )
-            return false;
-    }
-    return true;
+    return mHash == other.mHash && mSteps.structurallyEquals( other.mSteps );
 }
 
 Form Parsing::parsedSoFar() const
@@ -175,14 +179,17 @@ bool Parsing::allConstraintsSatisfied() const
     /// should be called with an empty Allomorph (i.e., no Allomorph), so that any local constraints
     /// can voice their objections to not being satisfied
     bool localConstraintsResolved = constraintsSetSatisfied( mLocalConstraints, mSteps.last().node(), Allomorph(Allomorph::Null) );
-    bool finalAllomorphConstraintsResolved = constraintsSetSatisfied( mSteps.last().allomorph().localConstraints(), mSteps.last().node(), Allomorph(Allomorph::Null) );
+    bool finalAllomorphConstraintsResolved = constraintsSetSatisfied( mSteps.last().allomorphRef().localConstraints(), mSteps.last().node(), Allomorph(Allomorph::Null) );
     bool longDistanceConstraintsResolved = longDistanceConstraintsSatisfied();
 
-    parsingLog()->begin("constraints");
-    parsingLog()->constraintsSetSatisfactionSummary("local", this, mLocalConstraints, mSteps.last().node(), Allomorph(Allomorph::Null));
-    parsingLog()->constraintsSetSatisfactionSummary("final-allomorphs", this, mSteps.last().allomorph().localConstraints(), mSteps.last().node(), Allomorph(Allomorph::Null) );
-    parsingLog()->longDistanceConstraintsSatisfactionSummary(this);
-    parsingLog()->end();
+    if( parsingLog()->isEnabled() )
+    {
+        parsingLog()->begin("constraints");
+        parsingLog()->constraintsSetSatisfactionSummary("local", this, mLocalConstraints, mSteps.last().node(), Allomorph(Allomorph::Null));
+        parsingLog()->constraintsSetSatisfactionSummary("final-allomorphs", this, mSteps.last().allomorphRef().localConstraints(), mSteps.last().node(), Allomorph(Allomorph::Null) );
+        parsingLog()->longDistanceConstraintsSatisfactionSummary(this);
+        parsingLog()->end();
+    }
 
     return localConstraintsResolved && finalAllomorphConstraintsResolved && longDistanceConstraintsResolved;
 }
@@ -199,7 +206,7 @@ void Parsing::serialize(QXmlStreamWriter &out, bool includeGlosses) const
         /// only write further information if the parsing is actually completed
         /// this function should not be used for any other parsing stages
     {
-        QListIterator<ParsingStep> i(mSteps);
+        ParsingStepChain::Iterator i( mSteps );
         while(i.hasNext())
         {
             i.next().serialize(out, includeGlosses);
@@ -228,7 +235,7 @@ void Parsing::serialize(QDomElement &out, bool includeGlosses) const
         /// only write further information if the parsing is actually completed
         /// this function should not be used for any other parsing stages
     {
-        QListIterator<ParsingStep> i(mSteps);
+        ParsingStepChain::Iterator i( mSteps );
         while(i.hasNext())
         {
             QDomElement psEl = out.ownerDocument().createElement("parsing-step");
@@ -342,6 +349,51 @@ WritingSystem Parsing::writingSystem() const
 }
 
 void Parsing::append(const AbstractNode *node, const Allomorph &allomorph, const LexicalStem & lexicalStem, bool isStem)
+{
+    if( beginAppend( node, allomorph ) )
+    {
+        ParsingStep ps(node, allomorph, lexicalStem);
+        ps.setIsStem(isStem);
+        appendStep( ps );
+        endAppend( allomorph );
+    }
+}
+
+void Parsing::append(const AbstractNode *node, const Allomorph *allomorph, const LexicalStem *lexicalStem, bool isStem)
+{
+    if( beginAppend( node, *allomorph ) )
+    {
+        ParsingStep ps(node, allomorph, lexicalStem);
+        ps.setIsStem(isStem);
+        appendStep( ps );
+        endAppend( *allomorph );
+    }
+}
+
+void Parsing::detachFromModel()
+{
+    bool refersToModel = false;
+    ParsingStepChain::Iterator i( mSteps );
+    while( i.hasNext() && !refersToModel )
+    {
+        refersToModel = i.next().refersToModel();
+    }
+    if( !refersToModel )
+    {
+        return;
+    }
+
+    ParsingStepChain detached;
+    i = ParsingStepChain::Iterator( mSteps );
+    while( i.hasNext() )
+    {
+        const ParsingStep & step = i.next();
+        detached.append( step.refersToModel() ? step.detached() : step );
+    }
+    mSteps = detached;
+}
+
+bool Parsing::beginAppend(const AbstractNode *node, const Allomorph &allomorph)
 {
     if( constraintsSetSatisfied( mLocalConstraints, node, allomorph) )
     {
@@ -359,36 +411,40 @@ void Parsing::append(const AbstractNode *node, const Allomorph &allomorph, const
         Form allomorphForm = allomorph.form( writingSystem() );
         mPosition += allomorphForm.text().length();
 
-        ParsingStep ps(node, allomorph, lexicalStem);
-        ps.setIsStem(isStem);
-        mSteps.append( ps );
+        return true;
+    }
+    else
+    {
+        setStatus( Parsing::Failed );
+        if( parsingLog()->isEnabled() )
+        {
+            parsingLog()->info( QObject::tr("Parse failed because local constraints were not satisfied: %1. Trying to append: %2").arg(intermediateSummary()).arg(allomorph.focusedSummary( writingSystem() )) );
+            parsingLog()->constraintsSetSatisfactionSummary("constraint-satisfaction-summary", this, mLocalConstraints, node, allomorph);
+        }
+        return false;
+    }
+}
 
-        addLocalConstraints( allomorph.localConstraints() );
-        addLongDistanceConstraints( allomorph.longDistanceConstraints() );
+void Parsing::endAppend(const Allomorph &allomorph)
+{
+    addLocalConstraints( allomorph.localConstraints() );
+    addLongDistanceConstraints( allomorph.longDistanceConstraints() );
 
-        if( atEnd() )
+    if( atEnd() )
+    {
+        if( allConstraintsSatisfied() )
         {
-            if( allConstraintsSatisfied() )
-            {
-                setStatus( Parsing::Completed );
-            }
-            else
-            {
-                setStatus( Parsing::Failed );
-            }
+            setStatus( Parsing::Completed );
         }
         else
         {
-            setStatus( Parsing::Ongoing );
+            setStatus( Parsing::Failed );
         }
     }
     else
     {
-        setStatus( Parsing::Failed );
-        parsingLog()->info( QObject::tr("Parse failed because local constraints were not satisfied: %1. Trying to append: %2").arg(intermediateSummary()).arg(allomorph.focusedSummary( writingSystem() )) );
-        parsingLog()->constraintsSetSatisfactionSummary("constraint-satisfaction-summary", this, mLocalConstraints, node, allomorph);
+        setStatus( Parsing::Ongoing );
     }
-    calculateHash();
 }
 
 int Parsing::position() const
@@ -431,7 +487,18 @@ QSet<const AbstractConstraint *> Parsing::longDistanceConstraints() const
 
 void Parsing::calculateHash()
 {
-    mHash = qHash(labelSummary(), HASH_SEED);
+    mHash = HASH_SEED;
+    ParsingStepChain::Iterator i( mSteps );
+    while( i.hasNext() )
+    {
+        mHash = combineStepHash( mHash, i.next().structuralHash() );
+    }
+}
+
+void Parsing::appendStep(const ParsingStep &step)
+{
+    mSteps.append( step );
+    mHash = combineStepHash( mHash, step.structuralHash() );
 }
 
 const ParsingLog *Parsing::parsingLog() const
@@ -439,28 +506,100 @@ const ParsingLog *Parsing::parsingLog() const
     return mMorphologicalModel->parsingLog();
 }
 
+bool Parsing::collectStatistics() const
+{
+    return mMorphologicalModel != nullptr && mMorphologicalModel->collectStatistics();
+}
+
 QStringList Parsing::stackTrace() const
 {
     return mStackTrace;
 }
 
-uint Parsing::hash() const
+quint64 Parsing::hash() const
 {
     return mHash;
 }
 
+bool Parsing::hasSameState(const Parsing &other, AbstractConstraint::History history) const
+{
+    /// BoundCondition and PrecedingNodeConstraint depend on how many steps there are, but only up to two
+    const bool sameState = mPosition == other.mPosition
+            && mStatus == other.mStatus
+            && mNextNodeRequired == other.mNextNodeRequired
+            && qMin( mSteps.count(), 2 ) == qMin( other.mSteps.count(), 2 )
+            && mMorphologicalModel == other.mMorphologicalModel
+            && mForm == other.mForm
+            && mJumpCounts == other.mJumpCounts
+            && mLocalConstraints == other.mLocalConstraints
+            && mLongDistanceConstraints == other.mLongDistanceConstraints;
+    if( !sameState )
+    {
+        return false;
+    }
+
+    switch( history )
+    {
+    case AbstractConstraint::NoHistory:
+        return true;
+    case AbstractConstraint::PrecedingStep:
+        return mSteps.isEmpty() || mSteps.last().structurallyEquals( other.mSteps.last() );
+    case AbstractConstraint::AllSteps:
+        return mHash == other.mHash && mSteps.structurallyEquals( other.mSteps );
+    }
+    return false;
+}
+
+uint Parsing::stateHash(AbstractConstraint::History history) const
+{
+    uint hash = qHash( mPosition, HASH_SEED ) ^ qHash( ( static_cast<int>(mStatus) << 2 ) | qMin( mSteps.count(), 2 ), HASH_SEED );
+    if( history == AbstractConstraint::PrecedingStep && !mSteps.isEmpty() )
+    {
+        hash ^= qHash( mSteps.last().structuralHash(), HASH_SEED );
+    }
+    else if( history == AbstractConstraint::AllSteps )
+    {
+        hash ^= qHash( mHash, HASH_SEED );
+    }
+    return hash;
+}
+
+Parsing Parsing::rebased(const Parsing &from, const Parsing &onto) const
+{
+    Parsing p = *this;
+    p.mSteps = onto.mSteps;
+    p.mHash = onto.mHash;
+    const ParsingStepChain::Iterator steps( mSteps );
+    for(int i = from.mSteps.count(); i < steps.count(); i++)
+    {
+        p.appendStep( steps.at(i) );
+    }
+    p.mStackTrace = onto.mStackTrace + mStackTrace.mid( from.mStackTrace.count() );
+    return p;
+}
+
+ParseChart *Parsing::parseChart() const
+{
+    return mParseChart;
+}
+
+void Parsing::setParseChart(ParseChart *parseChart)
+{
+    mParseChart = parseChart;
+}
+
 void Parsing::setSteps(const QList<ParsingStep> &steps)
 {
-    mSteps = steps;
+    mSteps = ParsingStepChain( steps );
     calculateHash();
 }
 
 bool Parsing::hasHypotheticalStem() const
 {
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        if( i.next().allomorph().isHypothetical() )
+        if( i.next().allomorphRef().isHypothetical() )
             return true;
     }
     return false;
@@ -498,9 +637,11 @@ bool Parsing::isGeneration() const
 
 bool Parsing::hasPortmanteauClash(const MorphemeSequence &morphemes, const WritingSystem & ws) const
 {
-    /// iterate over mSteps
+    const ParsingStepChain::Iterator steps( mSteps );
+
+    /// iterate over the steps
     /// start at zero and go up to the last index that could match \a morphemes
-    for(int i=0; i <= (mSteps.count() - morphemes.count()); i++)
+    for(int i=0; i <= (steps.count() - morphemes.count()); i++)
     {
         bool matches = true;
         for(int j=0; j < morphemes.count(); j++)
@@ -509,8 +650,8 @@ bool Parsing::hasPortmanteauClash(const MorphemeSequence &morphemes, const Writi
             /// because the first condition establishes that the
             /// allomorph doesn't have a portmanteau; so it will only
             /// have one
-            if( !mSteps.at(i+j).allomorph().hasPortmanteau(ws)
-                && mSteps.at(i+j).morphemes(ws).first() == morphemes.at(j) )
+            if( !steps.at(i+j).allomorphRef().hasPortmanteau(ws)
+                && steps.at(i+j).morphemes(ws).first() == morphemes.at(j) )
             {
                 continue;
             }
@@ -544,19 +685,20 @@ bool Parsing::hasPortmanteauClash(const QMultiHash<WritingSystem, MorphemeSequen
 
 bool Parsing::hasLexicalItemPortmanteauClash() const
 {
+    const ParsingStepChain::Iterator steps( mSteps );
     MorphemeSequence parsingSequence = morphemeSequence();
-    for(int i=0; i<mSteps.count(); i++)
+    for(int i=0; i<steps.count(); i++)
     {
-        if( mSteps.at(i).isStem() )
+        if( steps.at(i).isStem() )
         {
-            const QList<MorphemeSequence> portmanteaux = mSteps.at(i).lexicalStem().portmanteaux( writingSystem() );
+            const QList<MorphemeSequence> portmanteaux = steps.at(i).lexicalStemRef().portmanteaux( writingSystem() );
 
             QListIterator<MorphemeSequence> iter(portmanteaux);
             while(iter.hasNext())
             {
                 const MorphemeSequence sequence = iter.next();
                 /// of course we only check if the allomorph in the parsing is not itself the portmanteau morpheme
-                if( mSteps.at(i).morphemes(writingSystem()) != sequence )
+                if( steps.at(i).morphemes(writingSystem()) != sequence )
                 {
                     int stemInSequence = sequence.indexOf( MorphemeLabel( MorphemeSequence::STEM_LABEL ) );
 
@@ -603,13 +745,13 @@ int Parsing::jumpCounter(const Jump *jump) const
 
 LexicalStem Parsing::firstLexicalStem() const
 {
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        ParsingStep ps = i.next();
-        if( ! ps.lexicalStem().isEmpty() )
+        const ParsingStep & ps = i.next();
+        if( ! ps.lexicalStemRef().isEmpty() )
         {
-            return ps.lexicalStem();
+            return ps.lexicalStemRef();
         }
     }
     return LexicalStem();
@@ -618,13 +760,13 @@ LexicalStem Parsing::firstLexicalStem() const
 QList<LexicalStem> Parsing::lexicalStems() const
 {
     QList<LexicalStem> stems;
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        ParsingStep ps = i.next();
-        if( ! ps.lexicalStem().isEmpty() )
+        const ParsingStep & ps = i.next();
+        if( ! ps.lexicalStemRef().isEmpty() )
         {
-            stems << ps.lexicalStem();
+            stems << ps.lexicalStemRef();
         }
     }
     return stems;
@@ -632,10 +774,10 @@ QList<LexicalStem> Parsing::lexicalStems() const
 
 bool Parsing::containsStem(const LexicalStem &stem) const
 {
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        if( i.next().lexicalStem() == stem )
+        if( i.next().lexicalStemRef() == stem )
         {
             return true;
         }
@@ -645,10 +787,10 @@ bool Parsing::containsStem(const LexicalStem &stem) const
 
 bool Parsing::containsStem(qlonglong stemId) const
 {
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        if( i.next().lexicalStem() == stemId )
+        if( i.next().lexicalStemRef() == stemId )
         {
             return true;
         }
@@ -659,10 +801,10 @@ bool Parsing::containsStem(qlonglong stemId) const
 int Parsing::numberOfInstancesOfStem(qlonglong stemId) const
 {
     int ct = 0;
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        if( i.next().lexicalStem() == stemId )
+        if( i.next().lexicalStemRef() == stemId )
         {
             ct++;
         }
@@ -672,13 +814,13 @@ int Parsing::numberOfInstancesOfStem(qlonglong stemId) const
 
 Allomorph Parsing::firstLexicalStemAllomorph() const
 {
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        ParsingStep ps = i.next();
-        if( ! ps.lexicalStem().isEmpty() )
+        const ParsingStep & ps = i.next();
+        if( ! ps.lexicalStemRef().isEmpty() )
         {
-            return ps.allomorph();
+            return ps.allomorphRef();
         }
     }
     return Allomorph(Allomorph::Null);
@@ -686,13 +828,13 @@ Allomorph Parsing::firstLexicalStemAllomorph() const
 
 Allomorph Parsing::firstHypotheticalAllomorph() const
 {
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        ParsingStep ps = i.next();
-        if( ps.allomorph().isHypothetical() )
+        const ParsingStep & ps = i.next();
+        if( ps.allomorphRef().isHypothetical() )
         {
-            return ps.allomorph();
+            return ps.allomorphRef();
         }
     }
     return Allomorph(Allomorph::Null);
@@ -705,13 +847,13 @@ Form Parsing::form() const
 
 Form Parsing::stem(const WritingSystem &ws) const
 {
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        ParsingStep ps = i.next();
+        const ParsingStep & ps = i.next();
         if( ps.node()->type() == AbstractNode::StemNodeType )
         {
-            return ps.allomorph().form( ws );
+            return ps.allomorphRef().form( ws );
         }
     }
     return Form(ws, "");
@@ -720,7 +862,7 @@ Form Parsing::stem(const WritingSystem &ws) const
 MorphemeSequence Parsing::morphemeSequence() const
 {
     MorphemeSequence seq;
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
         seq << i.next().morphemes( writingSystem() );
@@ -730,21 +872,49 @@ MorphemeSequence Parsing::morphemeSequence() const
 
 void Parsing::addLocalConstraints(const QSet<const AbstractConstraint *> &newConstraints)
 {
-    mLocalConstraints.unite(newConstraints);
+    /// most allomorphs have no constraints, and assigning shares the allomorph's set rather than copying it
+    if( newConstraints.isEmpty() )
+        return;
+    if( mLocalConstraints.isEmpty() )
+        mLocalConstraints = newConstraints;
+    else
+        mLocalConstraints.unite(newConstraints);
 }
 
 void Parsing::addLongDistanceConstraints(const QSet<const AbstractConstraint *> &newConstraints)
 {
-    mLongDistanceConstraints.unite(newConstraints);
+    if( newConstraints.isEmpty() )
+        return;
+    if( mLongDistanceConstraints.isEmpty() )
+        mLongDistanceConstraints = newConstraints;
+    else
+        mLongDistanceConstraints.unite(newConstraints);
 }
 
 QList<ParsingStep> Parsing::steps() const
 {
-    return mSteps;
+    return mSteps.toList();
+}
+
+ParsingStepChain::Iterator Parsing::stepIterator() const
+{
+    return ParsingStepChain::Iterator( mSteps );
+}
+
+int Parsing::stepCount() const
+{
+    return mSteps.count();
+}
+
+const ParsingStep &Parsing::lastStep() const
+{
+    return mSteps.last();
 }
 
-bool Parsing::allomorphMatches(const Allomorph &allomorph, bool logMatches) const
+bool Parsing::allomorphMatches(const Allomorph &allomorph, bool logMatches, HotPathCounters *counters) const
 {
+    if( counters != nullptr )
+        counters->add( HotPathCounters::AllomorphsTested );
     bool segmentalMatch = allomorphMatchesSegmentally(allomorph);
     if( !segmentalMatch )
     {
@@ -752,7 +922,11 @@ bool Parsing::allomorphMatches(const Allomorph &allomorph, bool logMatches) cons
             parsingLog()->allomorphMatchSummary(this,allomorph);
         return false;
     }
+    if( counters != nullptr )
+        counters->add( HotPathCounters::SegmentalMatches );
     bool conditionMatch = allomorphMatchConditionsSatisfied(allomorph);
+    if( counters != nullptr && !conditionMatch )
+        counters->add( HotPathCounters::ConditionRejections );
     if( logMatches )
         parsingLog()->allomorphMatchSummary(this,allomorph);
     return segmentalMatch && conditionMatch;
@@ -760,8 +934,10 @@ bool Parsing::allomorphMatches(const Allomorph &allomorph, bool logMatches) cons
 
 bool Parsing::allomorphMatchConditionsSatisfied(const Allomorph &allomorph) const
 {
-    foreach(const AbstractConstraint * c, allomorph.matchConditions() )
+    const QList<const AbstractConstraint *> conditions = allomorph.matchConditions();
+    for(int i=0; i < conditions.count(); i++ )
     {
+        const AbstractConstraint * c = conditions.at(i);
         bool satisfied = c->matches(this, nullptr, allomorph );
         if( ! satisfied )
         {
@@ -776,18 +952,20 @@ bool Parsing::allomorphMatchConditionsSatisfied(const Allomorph &allomorph) cons
 
 void Parsing::positionsForStep(int parsingStepIndex, int &start, int &end) const
 {
-    if( parsingStepIndex < 0 || parsingStepIndex >= mSteps.length() )
+    const ParsingStepChain::Iterator steps( mSteps );
+    if( parsingStepIndex < 0 || parsingStepIndex >= steps.count() )
     {
         start = -1;
         end = -1;
+        return;
     }
 
     start = 0;
     for(int i=0; i < parsingStepIndex; i++)
     {
-        start += mSteps.at(i).allomorph().form( mForm.writingSystem() ).length();
+        start += steps.at(i).allomorphRef().form( mForm.writingSystem() ).length();
     }
-    end = start + mSteps.at(parsingStepIndex).allomorph().form( mForm.writingSystem() ).length() - 1;
+    end = start + steps.at(parsingStepIndex).allomorphRef().form( mForm.writingSystem() ).length() - 1;
 }
 
 bool Parsing::allomorphMatchesSegmentally(const Allomorph &allomorph) const
@@ -914,13 +1092,13 @@ QString Parsing::summary() const
     dbg << "Remainder: " << mForm.text().mid(mPosition) << "\n";
     dbg << "Model: " << (mMorphologicalModel == nullptr ? "null" : mMorphologicalModel->label().toString()) << "\n";
 
-    dbg << "Steps(s) (n=" << mSteps.length() << ") (\n";
+    dbg << "Steps(s) (n=" << mSteps.count() << ") (\n";
 
-    QListIterator<ParsingStep> i(mSteps);
+    ParsingStepChain::Iterator i( mSteps );
     while(i.hasNext())
     {
-        ParsingStep ps = i.next();
-        dbg << ps.node()->label().toString() << ", " << ps.allomorph().focusedSummary( writingSystem() ) << "\n";
+        const ParsingStep & ps = i.next();
+        dbg << ps.node()->label().toString() << ", " << ps.allomorphRef().focusedSummary( writingSystem() ) << "\n";
     }
     dbg << "),\n";
     dbg << "Local Constraint(s) (n=" << mLocalConstraints.size() << ") (\n";
@@ -942,10 +1120,10 @@ QString Parsing::oneLineSummary() const
 
 bool parsingLessThanStepwise(const Parsing &p1, const Parsing &p2)
 {
-    return p1.steps().length() > p2.steps().length();
+    return p1.stepCount() > p2.stepCount();
 }
 
 uint ME::qHash(const Parsing & key)
 {
-    return key.hash();
+    return static_cast<uint>( key.hash() ^ ( key.hash() >> 32 ) );
 }
@@ -13,6 +13,7 @@
 
 #include <QList>
 #include "parsingstep.h"
+#include "parsingstepchain.h"
 
 #include "form.h"
 
@@ -28,6 +29,8 @@ class Jump;
 class Morphology;
 class MorphemeSequence;
 class ParsingLog;
+class ParseChart;
+class HotPathCounters;
 
 #include "mortal-engine_global.h"
 
@@ -38,7 +41,13 @@ public:
     enum Flags {
         None = 0,
         GuessStem = 1 << 0,
-        OnlyOneResult = 1 << 1
+        OnlyOneResult = 1 << 1,
+        /// share the results of identical sub-parses between branches (see ParseChart)
+        UseParseChart = 1 << 2,
+        /// steps refer to the model's allomorphs and stems instead of copying them (see detachFromModel)
+        ReferenceModelObjects = 1 << 3,
+        /// try the morphological models concurrently (see Morphology::possibleParsings)
+        ParallelModels = 1 << 4
     };
 
     /**
@@ -53,6 +62,7 @@ public:
 
     Parsing(const Parsing &other);
     Parsing &operator=(const Parsing &other);
+    //! \brief Returns true if the parsings have the same steps, i.e., the same nodes, allomorphs and stems (see ParsingStep::structurallyEquals)
     bool operator==(const Parsing & other) const;
 
     //! \section Basic data access
@@ -108,6 +118,11 @@ public:
 
 
     virtual void append(const AbstractNode* node, const Allomorph &allomorph, const LexicalStem &lexicalStem = LexicalStem(), bool isStem = false );
+    //! \brief Appends a step that refers to \a allomorph and \a lexicalStem, which are owned by the model, rather than copying them
+    void append(const AbstractNode* node, const Allomorph * allomorph, const LexicalStem * lexicalStem = nullptr, bool isStem = false );
+
+    //! \brief Replaces any steps that refer to the model's allomorphs and stems with copies, so that the parsing remains valid if the model changes
+    void detachFromModel();
 
     /**
      * @brief Returns a string representation of the Form for logging purposes.
@@ -117,10 +132,17 @@ public:
     QString summary() const;
     QString oneLineSummary() const;
 
+    //! \brief Returns a copy of the steps of the parsing. Prefer stepIterator(), stepCount() and lastStep() where they suffice, since this copies every step.
     QList<ParsingStep> steps() const;
+    //! \brief Returns an iterator over the steps of the parsing, from first to last, which does not copy them. The parsing must outlive the iterator.
+    ParsingStepChain::Iterator stepIterator() const;
+    int stepCount() const;
+    //! \brief Returns the most recently appended step. The parsing must have at least one step.
+    const ParsingStep & lastStep() const;
 
     /// \a logMatches can be used to disable logging for contexts in which that may be inappropriate (e.g., long lists of stems)
-    bool allomorphMatches(const Allomorph &allomorph, bool logMatches = true) const;
+    /// if \a counters is not nullptr, the test and its outcome are counted there (see AbstractNode::statisticsCounters())
+    bool allomorphMatches(const Allomorph &allomorph, bool logMatches = true, HotPathCounters * counters = nullptr) const;
     bool allomorphMatchConditionsSatisfied(const Allomorph &allomorph) const;
 
     void positionsForStep(int parsingStepIndex, int &start, int &end) const;
@@ -193,8 +215,24 @@ public:
 
     bool hasHypotheticalStem() const;
 
-    uint hash() const;
+    //! \brief Returns a hash of the steps of the parsing, which is updated as steps are appended
+    quint64 hash() const;
+
+    //! \brief Returns true if \a other would be extended in exactly the same way as this parsing, i.e., it has the same position, status, jump counts and pending constraints, and whether it has more than one step. Of the steps themselves, only as many are compared as \a history calls for (see AbstractConstraint::historyInspected()).
+    bool hasSameState(const Parsing & other, AbstractConstraint::History history) const;
+    //! \brief Returns a hash consistent with hasSameState() for the same \a history
+    uint stateHash(AbstractConstraint::History history) const;
+    //! \brief Returns a copy of this parsing, which was extended from \a from, as though it had been extended from \a onto instead. \a from and \a onto must have the same state (see hasSameState()).
+    Parsing rebased(const Parsing & from, const Parsing & onto) const;
+
+    //! \brief Returns the chart used to share sub-parses when parsing with Parsing::UseParseChart, or nullptr
+    ParseChart *parseChart() const;
+    void setParseChart(ParseChart *parseChart);
 
+    //! \brief Returns true if the model of the parsing is collecting statistics (see Morphology::setCollectStatistics())
+    bool collectStatistics() const;
+
+    /// this is read during parsing, so it should not be changed while other threads are parsing
     static int MAXIMUM_JUMPS;
 
     QSet<const AbstractConstraint *> longDistanceConstraints() const;
@@ -215,7 +253,7 @@ protected:
 
     bool longDistanceConstraintsSatisfied() const;
 
-    QList<ParsingStep> mSteps;
+    ParsingStepChain mSteps;
     Form mForm;
     int mPosition;
 
@@ -223,6 +261,11 @@ protected:
     QSet<const AbstractConstraint *> mLongDistanceConstraints;
 
     void calculateHash();
+    void appendStep(const ParsingStep & step);
+
+    /// Parsing::append is split in two so that the step is only constructed if it can be appended
+    bool beginAppend(const AbstractNode *node, const Allomorph &allomorph);
+    void endAppend(const Allomorph &allomorph);
 
     const ParsingLog * parsingLog() const;
 
@@ -233,7 +276,8 @@ private:
     QHash<const Jump*,int> mJumpCounts;
     bool mNextNodeRequired;
     QStringList mStackTrace;
-    uint mHash;
+    quint64 mHash;
+    ParseChart * mParseChart;
 };
 
 Q_DECL_EXPORT uint qHash(const ME::Parsing & key);
@@ -13,6 +13,8 @@ using namespace ME;
 ParsingStep::ParsingStep(const AbstractNode *node, const Allomorph & allomorph) :
     mNode(node),
     mAllomorph(allomorph),
+    mAllomorphReference(nullptr),
+    mLexicalStemReference(nullptr),
     mIsStem(false)
 {
 
@@ -22,11 +24,76 @@ ParsingStep::ParsingStep(const AbstractNode *node, const Allomorph &allomorph, c
     mNode(node),
     mAllomorph(allomorph),
     mLexicalStem(lexicalStem),
+    mAllomorphReference(nullptr),
+    mLexicalStemReference(nullptr),
     mIsStem(true)
 {
 
 }
 
+ParsingStep::ParsingStep(const AbstractNode *node, const Allomorph *allomorph, const LexicalStem *lexicalStem) :
+    mNode(node),
+    mAllomorph(Allomorph::Null),
+    mAllomorphReference(allomorph),
+    mLexicalStemReference(lexicalStem),
+    mIsStem(lexicalStem != nullptr)
+{
+
+}
+
+const Allomorph &ParsingStep::allomorphRef() const
+{
+    return mAllomorphReference == nullptr ? mAllomorph : *mAllomorphReference;
+}
+
+const LexicalStem &ParsingStep::lexicalStemRef() const
+{
+    return mLexicalStemReference == nullptr ? mLexicalStem : *mLexicalStemReference;
+}
+
+bool ParsingStep::refersToModel() const
+{
+    return mAllomorphReference != nullptr || mLexicalStemReference != nullptr;
+}
+
+ParsingStep ParsingStep::detached() const
+{
+    ParsingStep step( mNode, allomorphRef(), lexicalStemRef() );
+    step.setIsStem( mIsStem );
+    return step;
+}
+
+bool ParsingStep::operator==(const ParsingStep &other) const
+{
+    /// LexicalStem::operator== only compares allomorphs, so the id is compared as well
+    return mNode == other.mNode
+            && mIsStem == other.mIsStem
+            && allomorphRef() == other.allomorphRef()
+            && lexicalStemRef().id() == other.lexicalStemRef().id()
+            && lexicalStemRef() == other.lexicalStemRef();
+}
+
+bool ParsingStep::structurallyEquals(const ParsingStep &other) const
+{
+    /// allomorphs read from XML do not have ids, so the allomorphs themselves are compared, but only once the cheap checks (including the hash) have passed
+    return mNode == other.mNode
+            && mIsStem == other.mIsStem
+            && allomorphRef().id() == other.allomorphRef().id()
+            && allomorphRef().hash() == other.allomorphRef().hash()
+            && lexicalStemRef().id() == other.lexicalStemRef().id()
+            && ( &allomorphRef() == &other.allomorphRef() || allomorphRef() == other.allomorphRef() );
+}
+
+quint64 ParsingStep::structuralHash() const
+{
+    quint64 h = static_cast<quint64>( reinterpret_cast<quintptr>(mNode) );
+    h = h * 31 + allomorphRef().hash();
+    h = h * 31 + static_cast<quint64>( allomorphRef().id() );
+    h = h * 31 + static_cast<quint64>( lexicalStemRef().id() );
+    h = h * 31 + ( mIsStem ? 1 : 0 );
+    return h;
+}
+
 const AbstractNode *ParsingStep::node() const
 {
     return mNode;
@@ -34,9 +101,9 @@ const AbstractNode *ParsingStep::node() const
 
 QList<const AbstractNode *> ParsingStep::nodes(const WritingSystem &ws) const
 {
-    if( mAllomorph.hasPortmanteau(ws) )
+    if( allomorphRef().hasPortmanteau(ws) )
     {
-        return mAllomorph.portmanteau().nodes();
+        return allomorphRef().portmanteau().nodes();
     }
     else
     {
@@ -46,9 +113,9 @@ QList<const AbstractNode *> ParsingStep::nodes(const WritingSystem &ws) const
 
 const AbstractNode *ParsingStep::lastNode(const WritingSystem & ws) const
 {
-    if( mAllomorph.hasPortmanteau(ws) )
+    if( allomorphRef().hasPortmanteau(ws) )
     {
-        return mAllomorph.portmanteau().lastNode();
+        return allomorphRef().portmanteau().lastNode();
     }
     else
     {
@@ -58,7 +125,7 @@ const AbstractNode *ParsingStep::lastNode(const WritingSystem & ws) const
 
 bool ParsingStep::lastNodeMatchesId(const NodeId &id) const
 {
-    QSetIterator<WritingSystem> wsIter( mAllomorph.writingSystems() );
+    QSetIterator<WritingSystem> wsIter( allomorphRef().writingSystems() );
     while(wsIter.hasNext())
     {
         const WritingSystem ws = wsIter.next();
@@ -72,7 +139,7 @@ bool ParsingStep::lastNodeMatchesId(const NodeId &id) const
 
 bool ParsingStep::lastNodeMatchesLabel(const MorphemeLabel &label) const
 {
-    QSetIterator<WritingSystem> wsIter( mAllomorph.writingSystems() );
+    QSetIterator<WritingSystem> wsIter( allomorphRef().writingSystems() );
     while(wsIter.hasNext())
     {
         const WritingSystem ws = wsIter.next();
@@ -86,7 +153,7 @@ bool ParsingStep::lastNodeMatchesLabel(const MorphemeLabel &label) const
 
 bool ParsingStep::anyNodeMatchesId(const NodeId &id) const
 {
-    QSetIterator<WritingSystem> wsIter( mAllomorph.writingSystems() );
+    QSetIterator<WritingSystem> wsIter( allomorphRef().writingSystems() );
     while(wsIter.hasNext())
     {
         const WritingSystem ws = wsIter.next();
@@ -99,7 +166,7 @@ bool ParsingStep::anyNodeMatchesId(const NodeId &id) const
 
 bool ParsingStep::anyNodeMatchesLabel(const MorphemeLabel &label) const
 {
-    QSetIterator<WritingSystem> wsIter( mAllomorph.writingSystems() );
+    QSetIterator<WritingSystem> wsIter( allomorphRef().writingSystems() );
     while(wsIter.hasNext())
     {
         const WritingSystem ws = wsIter.next();
@@ -112,20 +179,20 @@ bool ParsingStep::anyNodeMatchesLabel(const MorphemeLabel &label) const
 
 Allomorph ParsingStep::allomorph() const
 {
-    return mAllomorph;
+    return allomorphRef();
 }
 
 void ParsingStep::serialize(QXmlStreamWriter &out, bool includeGlosses) const
 {
     out.writeStartElement("parsing-step");
     mNode->serialize(out);
-    mAllomorph.serialize(out);
+    allomorphRef().serialize(out);
 
     if( includeGlosses )
     {
         if( mIsStem ) /// then print the lexical stem glosses
         {
-            QHashIterator<WritingSystem, Form> i( mLexicalStem.glosses() );
+            QHashIterator<WritingSystem, Form> i( lexicalStemRef().glosses() );
             while( i.hasNext() )
             {
                 i.next();
@@ -153,7 +220,7 @@ void ParsingStep::serialize(QDomElement &out, bool includeGlosses) const
     out.appendChild(nodeEl);
 
     QDomElement allEl = out.ownerDocument().createElement("allomorph");
-    mAllomorph.serialize(allEl);
+    allomorphRef().serialize(allEl);
     out.appendChild(allEl);
 
 
@@ -161,7 +228,7 @@ void ParsingStep::serialize(QDomElement &out, bool includeGlosses) const
     {
         if( mIsStem ) /// then print the lexical stem glosses
         {
-            QHashIterator<WritingSystem, Form> i( mLexicalStem.glosses() );
+            QHashIterator<WritingSystem, Form> i( lexicalStemRef().glosses() );
             while( i.hasNext() )
             {
                 i.next();
@@ -382,9 +449,9 @@ QList<ParsingStep> ParsingStep::readListFromXml(QDomElement list, const Morpholo
 
 MorphemeSequence ParsingStep::morphemes(const WritingSystem & ws) const
 {
-    if( mAllomorph.hasPortmanteau(ws) )
+    if( allomorphRef().hasPortmanteau(ws) )
     {
-        return mAllomorph.portmanteau().morphemes();
+        return allomorphRef().portmanteau().morphemes();
     }
     else
     {
@@ -399,5 +466,5 @@ void ParsingStep::setIsStem(const bool &isStem)
 
 LexicalStem ParsingStep::lexicalStem() const
 {
-    return mLexicalStem;
+    return lexicalStemRef();
 }
@@ -20,6 +20,15 @@ class MORTAL_ENGINE_EXPORT ParsingStep
 public:
     ParsingStep(const AbstractNode* node, const Allomorph & allomorph);
     ParsingStep(const AbstractNode* node, const Allomorph & allomorph, const LexicalStem &lexicalStem);
+    //! \brief Constructs a step that refers to an allomorph (and optionally a stem) owned by the model, rather than copying them. Such a step is only valid as long as the model is not changed; see detached().
+    ParsingStep(const AbstractNode* node, const Allomorph * allomorph, const LexicalStem * lexicalStem = nullptr);
+
+    bool operator==(const ParsingStep & other) const;
+
+    //! \brief Returns true if the steps have the same node, allomorph and stem. Unlike operator==, this does not compare the stems' allomorphs.
+    bool structurallyEquals(const ParsingStep & other) const;
+    //! \brief Returns a hash of the node, allomorph and stem, consistent with structurallyEquals()
+    quint64 structuralHash() const;
 
     const AbstractNode *node() const;
     QList<const AbstractNode *> nodes(const WritingSystem &ws) const;
@@ -29,9 +38,20 @@ public:
     bool anyNodeMatchesId(const NodeId & id) const;
     bool anyNodeMatchesLabel(const class MorphemeLabel & label) const;
 
+    //! \brief Returns a copy of the allomorph
     Allomorph allomorph() const;
+    //! \brief Returns the allomorph without copying it
+    const Allomorph & allomorphRef() const;
 
+    //! \brief Returns a copy of the lexical stem
     LexicalStem lexicalStem() const;
+    //! \brief Returns the lexical stem without copying it
+    const LexicalStem & lexicalStemRef() const;
+
+    //! \brief Returns true if the step refers to an allomorph or stem owned by the model
+    bool refersToModel() const;
+    //! \brief Returns a copy of the step that holds its own copies of the allomorph and stem
+    ParsingStep detached() const;
 
     /**
      * @brief Writes an XML representation of the object to the specified writer.
@@ -58,6 +78,9 @@ private:
     Allomorph mAllomorph;
     /// these need to be an object rather than a pointer because even LexicalStems that don't exist in the model can be specified in generations
     LexicalStem mLexicalStem;
+    /// if these are not null, they are used instead of mAllomorph and mLexicalStem
+    const Allomorph * mAllomorphReference;
+    const LexicalStem * mLexicalStemReference;
     bool mIsStem;
 };
 
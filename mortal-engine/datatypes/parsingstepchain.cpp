@@ -0,0 +1,122 @@
+#include "parsingstepchain.h"
+
+using namespace ME;
+
+ParsingStepChain::Link::Link(const ParsingStep &step, const QSharedPointer<const Link> &previous) :
+    step(step),
+    previous(previous),
+    count( previous.isNull() ? 1 : previous->count + 1 )
+{
+}
+
+ParsingStepChain::ParsingStepChain()
+{
+}
+
+ParsingStepChain::ParsingStepChain(const QList<ParsingStep> &steps)
+{
+    foreach( ParsingStep step, steps )
+    {
+        append( step );
+    }
+}
+
+bool ParsingStepChain::operator==(const ParsingStepChain &other) const
+{
+    if( count() != other.count() )
+        return false;
+
+    const Link * a = mLast.data();
+    const Link * b = other.mLast.data();
+    /// once the chains share a link, the rest of the steps are the same
+    while( a != b )
+    {
+        if( !( a->step == b->step ) )
+            return false;
+        a = a->previous.data();
+        b = b->previous.data();
+    }
+    return true;
+}
+
+bool ParsingStepChain::structurallyEquals(const ParsingStepChain &other) const
+{
+    if( count() != other.count() )
+        return false;
+
+    const Link * a = mLast.data();
+    const Link * b = other.mLast.data();
+    while( a != b )
+    {
+        if( ! a->step.structurallyEquals( b->step ) )
+            return false;
+        a = a->previous.data();
+        b = b->previous.data();
+    }
+    return true;
+}
+
+int ParsingStepChain::count() const
+{
+    return mLast.isNull() ? 0 : mLast->count;
+}
+
+bool ParsingStepChain::isEmpty() const
+{
+    return mLast.isNull();
+}
+
+const ParsingStep &ParsingStepChain::last() const
+{
+    Q_ASSERT( !mLast.isNull() );
+    return mLast->step;
+}
+
+void ParsingStepChain::append(const ParsingStep &step)
+{
+    mLast = QSharedPointer<const Link>( new Link( step, mLast ) );
+}
+
+ParsingStepChain::Iterator::Iterator(const ParsingStepChain &chain) :
+    mLinks( chain.count() ),
+    mIndex(0)
+{
+    int i = mLinks.size();
+    for( const Link * l = chain.mLast.data(); l != nullptr; l = l->previous.data() )
+    {
+        mLinks[--i] = l;
+    }
+}
+
+bool ParsingStepChain::Iterator::hasNext() const
+{
+    return mIndex < mLinks.size();
+}
+
+const ParsingStep &ParsingStepChain::Iterator::next()
+{
+    Q_ASSERT( hasNext() );
+    return mLinks.at( mIndex++ )->step;
+}
+
+const ParsingStep &ParsingStepChain::Iterator::at(int index) const
+{
+    Q_ASSERT( index >= 0 && index < mLinks.size() );
+    return mLinks.at( index )->step;
+}
+
+int ParsingStepChain::Iterator::count() const
+{
+    return mLinks.size();
+}
+
+QList<ParsingStep> ParsingStepChain::toList() const
+{
+    QList<ParsingStep> list;
+    list.reserve( count() );
+    for( const Link * l = mLast.data(); l != nullptr; l = l->previous.data() )
+    {
+        list.prepend( l->step );
+    }
+    return list;
+}
@@ -0,0 +1,78 @@
+/*!
+  \class ParsingStepChain
+  \brief An immutable, reference-counted list of ParsingStep objects, stored as a chain from the last step back to the first. Copying the chain is O(1), and appending to a copy shares all of the existing steps with the original, so that branching parsings share their common prefix.
+
+  Use ParsingStepChain::Iterator to visit the steps in order without copying them. Parsing::steps() materializes the chain as a QList, which copies every step.
+*/
+
+#ifndef PARSINGSTEPCHAIN_H
+#define PARSINGSTEPCHAIN_H
+
+#include <QList>
+#include <QSharedPointer>
+#include <QVarLengthArray>
+
+#include "parsingstep.h"
+
+#include "mortal-engine_global.h"
+
+namespace ME {
+
+class MORTAL_ENGINE_EXPORT ParsingStepChain
+{
+    struct Link;
+
+public:
+    //! \brief A Java-style iterator over the steps of a chain, from the first step to the last. The steps are not copied, so the chain must outlive the iterator.
+    class MORTAL_ENGINE_EXPORT Iterator
+    {
+    public:
+        explicit Iterator(const ParsingStepChain & chain);
+
+        bool hasNext() const;
+        const ParsingStep & next();
+
+        //! \brief Returns the step at \a index, counting from the first step, regardless of the position of the iterator
+        const ParsingStep & at(int index) const;
+        int count() const;
+
+    private:
+        /// most parsings have only a handful of steps, so this usually doesn't allocate
+        QVarLengthArray<const Link *, 16> mLinks;
+        int mIndex;
+    };
+
+    ParsingStepChain();
+    explicit ParsingStepChain(const QList<ParsingStep> & steps);
+
+    bool operator==(const ParsingStepChain & other) const;
+
+    //! \brief Returns true if the steps of the two chains are structurally equal (see ParsingStep::structurallyEquals)
+    bool structurallyEquals(const ParsingStepChain & other) const;
+
+    int count() const;
+    bool isEmpty() const;
+
+    //! \brief Returns the last step. The chain must not be empty.
+    const ParsingStep & last() const;
+
+    void append(const ParsingStep & step);
+
+    QList<ParsingStep> toList() const;
+
+private:
+    struct Link
+    {
+        Link(const ParsingStep & step, const QSharedPointer<const Link> & previous);
+
+        const ParsingStep step;
+        const QSharedPointer<const Link> previous;
+        const int count;
+    };
+
+    QSharedPointer<const Link> mLast;
+};
+
+} // namespace ME
+
+#endif // PARSINGSTEPCHAIN_H
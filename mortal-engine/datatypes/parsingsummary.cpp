@@ -46,10 +46,10 @@ ParsingSummary ParsingSummary::interlinearStyleSummary(const WritingSystem &ws)
 QString ParsingSummary::summarize(const Parsing &parsing) const
 {
     QString string;
-    QListIterator<ParsingStep> iter(parsing.steps());
+    ParsingStepChain::Iterator iter( parsing.stepIterator() );
     while( iter.hasNext() )
     {
-        const ParsingStep step = iter.next();
+        const ParsingStep & step = iter.next();
         const bool hasNext = iter.hasNext();
         string += summarize( parsing, step, hasNext );
     }
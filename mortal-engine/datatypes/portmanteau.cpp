@@ -135,6 +135,11 @@ MorphemeSequence Portmanteau::morphemes() const
     return mMorphemes;
 }
 
+QString Portmanteau::initializationString() const
+{
+    return mInitializationString;
+}
+
 QList<const AbstractNode *> Portmanteau::nodes() const
 {
     return mNodes;
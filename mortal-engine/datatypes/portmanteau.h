@@ -46,6 +46,9 @@ public:
 
     MorphemeSequence morphemes() const;
 
+    //! \brief Returns the string that the portmanteau was constructed with. Unlike morphemes(), this is available before initialize() has been called.
+    QString initializationString() const;
+
     QList<const AbstractNode *> nodes() const;
 
 private:
@@ -6,8 +6,10 @@
 
 using namespace ME;
 
-int Debug::indentLevel = 0;
-bool Debug::atBeginning = true;
+namespace {
+thread_local int sIndentLevel = 0;
+thread_local bool sAtBeginning = true;
+}
 
 Debug::Debug(QString *string) : mString(string), mStream(string, QIODevice::Append)
 {
@@ -20,10 +22,10 @@ Debug::Debug(const Debug &other) : mString(other.mString), mStream(other.mString
 Debug Debug::operator <<(const QString &output)
 {
     QTextStream stream(mString);
-    if(atBeginning)
+    if(sAtBeginning)
     {
-        stream << QString("\t").repeated(indentLevel);
-        atBeginning = false;
+        stream << QString("\t").repeated(sIndentLevel);
+        sAtBeginning = false;
     }
     stream << output;
     return *this;
@@ -32,10 +34,10 @@ Debug Debug::operator <<(const QString &output)
 Debug Debug::operator <<(const int &output)
 {
     QTextStream stream(mString);
-    if(atBeginning)
+    if(sAtBeginning)
     {
-        stream << QString("\t").repeated(indentLevel);
-        atBeginning = false;
+        stream << QString("\t").repeated(sIndentLevel);
+        sAtBeginning = false;
     }
     stream << output;
     return *this;
@@ -44,10 +46,10 @@ Debug Debug::operator <<(const int &output)
 Debug Debug::operator <<(const long long &output)
 {
     QTextStream stream(mString);
-    if(atBeginning)
+    if(sAtBeginning)
     {
-        stream << QString("\t").repeated(indentLevel);
-        atBeginning = false;
+        stream << QString("\t").repeated(sIndentLevel);
+        sAtBeginning = false;
     }
     stream << output;
     return *this;
@@ -59,17 +61,37 @@ Debug Debug::operator <<(Debug::Control c)
     {
         QTextStream stream(mString);
         stream << Qt::endl;
-        atBeginning = true;
+        sAtBeginning = true;
     }
     return *this;
 }
 
 void Debug::indent()
 {
-    indentLevel++;
+    sIndentLevel++;
 }
 
 void Debug::unindent()
 {
-    indentLevel--;
+    sIndentLevel--;
+}
+
+int Debug::indentLevel()
+{
+    return sIndentLevel;
+}
+
+void Debug::setIndentLevel(int indentLevel)
+{
+    sIndentLevel = indentLevel;
+}
+
+bool Debug::atBeginning()
+{
+    return sAtBeginning;
+}
+
+void Debug::setAtBeginning(bool atBeginning)
+{
+    sAtBeginning = atBeginning;
 }
@@ -25,8 +25,11 @@ public:
     void indent();
     void unindent();
 
-    static int indentLevel;
-    static bool atBeginning;
+    /// the indentation state is kept per thread, so that summaries can be written concurrently
+    static int indentLevel();
+    static void setIndentLevel(int indentLevel);
+    static bool atBeginning();
+    static void setAtBeginning(bool atBeginning);
 
 private:
     QString * mString;
@@ -2,6 +2,6 @@
 
 using namespace ME;
 
-ParsingLog::ParsingLog() {}
+ParsingLog::ParsingLog(bool enabled) : mEnabled(enabled) {}
 
 ParsingLog::~ParsingLog() {}
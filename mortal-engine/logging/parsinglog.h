@@ -6,7 +6,7 @@
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #endif
 
-class QString;
+#include <QString>
 #include <QSet>
 #include "datatypes/allomorph.h"
 
@@ -23,9 +23,29 @@ class Generation;
 class ParsingLog
 {
 public:
-    ParsingLog();
+    //! \brief Creates a log; the base class records nothing, so it is not \a enabled unless a subclass that does record things says so
+    explicit ParsingLog(bool enabled = false);
     virtual ~ParsingLog();
 
+    //! \brief Returns true if the log records anything. When it does not (e.g., the default log that is used when debug output is off), callers should not build any messages for it; see deferredInfo() and deferredOutput().
+    bool isEnabled() const { return mEnabled; }
+
+    //! \brief Calls info() with the string returned by \a message, which is only called if the log is enabled
+    template<typename MessageFunction>
+    void deferredInfo(MessageFunction message) const
+    {
+        if( mEnabled )
+            info( message() );
+    }
+
+    //! \brief Calls output() with \a elementName and the string returned by \a information, which is only called if the log is enabled
+    template<typename MessageFunction>
+    void deferredOutput(const char * elementName, MessageFunction information) const
+    {
+        if( mEnabled )
+            output( QString::fromLatin1(elementName), information() );
+    }
+
     virtual void setStream(QXmlStreamWriter *stream) {}
 
     virtual void beginParse(const Form & f) const {}
@@ -52,6 +72,9 @@ public:
 
     virtual void output(const QString & elementName, const QString & information) const {}
     virtual void info(const QString & information) const {}
+
+private:
+    bool mEnabled;
 };
 
 }
@@ -11,7 +11,7 @@
 
 using namespace ME;
 
-XmlParsingLog::XmlParsingLog(QXmlStreamWriter *stream) : xml(stream)
+XmlParsingLog::XmlParsingLog(QXmlStreamWriter *stream) : ParsingLog(true), xml(stream)
 {
 }
 
@@ -1,15 +1,27 @@
 #include "morphology.h"
 
 #include "morphologyxmlreader.h"
+#include "morphologysnapshot.h"
 #include "datatypes/generation.h"
 #include "nodes/abstractstemlist.h"
 #include "nodes/morphemenode.h"
 #include "returns/lexicalsteminsertresult.h"
+#include "returns/morphologystatistics.h"
+#include "constraints/abstractconstraint.h"
 #include "datatypes/lexicalstem.h"
 #include <stdexcept>
 #include "messages.h"
 
 #include <QDir>
+#include <QtDebug>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QVector>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QSharedPointer>
 
 #include "morphologychecker.h"
 
@@ -20,11 +32,157 @@ using namespace ME;
 
 ParsingLog Morphology::NULL_PARSING_LOG;
 
+namespace {
+
+/// Each task takes the next unparsed form until none are left, and stores
+/// the result at the index of that form, so results are in input order.
+class BatchParsingTask : public QRunnable
+{
+public:
+    BatchParsingTask(const Morphology * morphology, const QList<Form> * forms, Parsing::Flags flags, QList<Parsing> * results, QAtomicInt * nextIndex)
+        : mMorphology(morphology), mForms(forms), mFlags(flags), mResults(results), mNextIndex(nextIndex)
+    {
+    }
+
+    void run() override
+    {
+        int i;
+        while( ( i = mNextIndex->fetchAndAddRelaxed(1) ) < mForms->count() )
+        {
+            mResults[i] = mMorphology->possibleParsings( mForms->at(i), mFlags );
+        }
+    }
+
+private:
+    const Morphology * mMorphology;
+    const QList<Form> * mForms;
+    Parsing::Flags mFlags;
+    QList<Parsing> * mResults;
+    QAtomicInt * mNextIndex;
+};
+
+/// The models of one possibleParsings() call with Parsing::ParallelModels. The state is shared
+/// with the pool tasks, since a task may start after the call has returned, in which case it finds
+/// nothing left to do.
+class ModelParsingState
+{
+public:
+    ModelParsingState(const Form & form, Parsing::Flags flags, const QList<MorphologicalModel*> & models)
+        : mForm(form), mFlags(flags), mModels(models), mResults( models.count() ), mCancelled( models.count() ),
+          mNextIndex(0), mFirstSuccess( models.count() ), mFinished(0)
+    {
+        mResultData = mResults.data();
+        mCancelledData = mCancelled.data();
+    }
+
+    /// parse with the next model until there are none left
+    void run()
+    {
+        int i;
+        while( ( i = mNextIndex.fetchAndAddRelaxed(1) ) < mModels.count() )
+        {
+            /// with Parsing::OnlyOneResult, a model after one that has succeeded needn't be tried
+            if( !( mFlags & Parsing::OnlyOneResult ) || i < mFirstSuccess.loadAcquire() )
+            {
+                /// the nodes stop making parsings if a model before this one succeeds in the meantime
+                const QAtomicInt * previousFlag = AbstractNode::setCancellationFlag( &mCancelledData[i] );
+                Parsing p( mForm, mModels.at(i) );
+                mResultData[i] = mModels.at(i)->possibleParsings( p, mFlags );
+                AbstractNode::setCancellationFlag( previousFlag );
+
+                if( mFlags & Parsing::OnlyOneResult && !mResultData[i].isEmpty() && mCancelledData[i].loadAcquire() == 0 )
+                {
+                    int first = mFirstSuccess.loadAcquire();
+                    while( i < first && !mFirstSuccess.testAndSetOrdered( first, i ) )
+                    {
+                        first = mFirstSuccess.loadAcquire();
+                    }
+                    /// the results of the models after this one won't be used, so abandon any that are running
+                    for(int j = i + 1; j < mModels.count(); j++)
+                    {
+                        mCancelledData[j].storeRelease(1);
+                    }
+                }
+            }
+
+            QMutexLocker locker(&mMutex);
+            mFinished++;
+            if( mFinished == mModels.count() )
+            {
+                mAllFinished.wakeAll();
+            }
+        }
+    }
+
+    /// returns the results in model order, once every model has been tried
+    QList<Parsing> results()
+    {
+        {
+            QMutexLocker locker(&mMutex);
+            while( mFinished < mModels.count() )
+            {
+                mAllFinished.wait(&mMutex);
+            }
+        }
+
+        QList<Parsing> candidates;
+        for(int i=0; i < mResults.count(); i++)
+        {
+            candidates.append( mResults.at(i) );
+            if( mFlags & Parsing::OnlyOneResult && !candidates.isEmpty() )
+            {
+                break;
+            }
+        }
+        return candidates;
+    }
+
+private:
+    const Form mForm;
+    const Parsing::Flags mFlags;
+    const QList<MorphologicalModel*> mModels;
+    /// each element is written by exactly one thread; the vector is not resized
+    QVector<QList<Parsing> > mResults;
+    QList<Parsing> * mResultData;
+    /// for each model, nonzero once a model before it has succeeded (with Parsing::OnlyOneResult); see AbstractNode::setCancellationFlag()
+    QVector<QAtomicInt> mCancelled;
+    QAtomicInt * mCancelledData;
+    QAtomicInt mNextIndex;
+    QAtomicInt mFirstSuccess;
+    QMutex mMutex;
+    QWaitCondition mAllFinished;
+    int mFinished;
+};
+
+class ModelParsingTask : public QRunnable
+{
+public:
+    explicit ModelParsingTask(const QSharedPointer<ModelParsingState> & state) : mState(state)
+    {
+    }
+
+    void run() override
+    {
+        mState->run();
+    }
+
+private:
+    QSharedPointer<ModelParsingState> mState;
+};
+
+} // namespace
+
 Morphology::Morphology()
     : mParsingLog(new XmlParsingLog(&Messages::stream()))
     , mDebugOutput(false)
     , mStemDebugOutput(false)
+    , mCollectStatistics(false)
+    , mReadStemListsInParallel(true)
+    , mParseChartHistory(AbstractConstraint::NoHistory)
+    , mParseCacheHits(0)
+    , mParseCacheMisses(0)
 {
+    setParseCacheSize(0);
 }
 
 Morphology::~Morphology()
@@ -41,22 +199,76 @@ void Morphology::readXmlFile(const QString &path)
 
     MorphologyXmlReader reader(this);
     reader.readXmlFile(path);
+    mLoadTimings = reader.phaseTimings();
+}
+
+bool Morphology::saveSnapshot(const QString &path) const
+{
+    return MorphologySnapshot::save(this, path);
+}
+
+int Morphology::loadSnapshot(const QString &path)
+{
+    MorphologySnapshot snapshot;
+    if( !snapshot.open(path) )
+    {
+        return -1;
+    }
+    if( !snapshot.modelIsUnchanged() )
+    {
+        qWarning() << "Morphology::loadSnapshot()" << "The morphology file has changed since the snapshot was made:" << snapshot.morphologyPath();
+        return -1;
+    }
+
+    clearData();
+
+    MorphologyXmlReader reader(this);
+    reader.setSnapshot(&snapshot);
+    reader.readXmlFile( snapshot.morphologyPath() );
+    mLoadTimings = reader.phaseTimings();
+    if( reader.restoredStemListCount() == 0 )
+    {
+        qWarning() << "Morphology::loadSnapshot()" << "None of the stem lists could be restored from the snapshot, so they were read from their sources:" << path;
+    }
+    return reader.restoredStemListCount();
 }
 
 bool Morphology::isWellFormed(const Form & form) const
 {
+    const bool useCache = parseCacheEnabled();
+    if( useCache )
+    {
+        QMutexLocker locker(&mParseCacheMutex);
+        const bool * cached = mWellFormedCache.object( form );
+        if( cached != nullptr )
+        {
+            mParseCacheHits++;
+            return *cached;
+        }
+        mParseCacheMisses++;
+    }
+
+    bool wellFormed = false;
     QListIterator<MorphologicalModel*> i(mMorphologicalModels);
     while (i.hasNext())
     {
         MorphologicalModel * model = i.next();
         Parsing p( form, model );
-        int count = model->possibleParsings(p, Parsing::OnlyOneResult).count();
+        int count = model->possibleParsings(p, static_cast<Parsing::Flags>( Parsing::OnlyOneResult | Parsing::ReferenceModelObjects ) ).count();
         if( count > 0 )
         {
-            return true;
+            wellFormed = true;
+            break;
         }
     }
-    return false;
+
+    if( useCache )
+    {
+        QMutexLocker locker(&mParseCacheMutex);
+        mWellFormedCache.insert( form, new bool(wellFormed) );
+    }
+
+    return wellFormed;
 }
 
 void Morphology::clearData()
@@ -73,7 +285,13 @@ void Morphology::clearData()
     mStemAcceptingStemLists.clear();
     mStemLists.clear();
     mMorphemeNodes.clear();
+    mConstraints.clear();
+    mParseChartHistory = AbstractConstraint::NoHistory;
+    mLexicalStemsById.clear();
     mNormalizationFunctions.clear();
+    mLoadTimings.clear();
+
+    clearParseCache();
 }
 
 QList<MorphologicalModel *> Morphology::morphologicalModels() const
@@ -89,25 +307,119 @@ WritingSystem Morphology::writingSystem(const QString &lang) const
 QList<Parsing> Morphology::possibleParsings(const Form &form, Parsing::Flags flags) const
 {
     QList<Parsing> candidates;
+    const Form normalized = normalize(form);
 
-    parsingLog()->beginParse(form);
+    /// Parsing::ParallelModels doesn't change the results, so it isn't passed on or used in the cache key
+    const bool parallelModels = flags & Parsing::ParallelModels;
+    flags = static_cast<Parsing::Flags>( flags & ~Parsing::ParallelModels );
 
-    foreach(MorphologicalModel *model,  mMorphologicalModels)
+    /// the models always make steps that refer to the model's allomorphs and stems, which is much cheaper than copying them;
+    /// unless the caller has asked for such parsings, they are detached before they leave this function
+    const bool detach = !( flags & Parsing::ReferenceModelObjects );
+    const Parsing::Flags modelFlags = static_cast<Parsing::Flags>( flags | Parsing::ReferenceModelObjects );
+
+    const bool useCache = parseCacheEnabled();
+    const ParseCacheKey key = { normalized, static_cast<int>(flags) };
+    if( useCache )
+    {
+        QMutexLocker locker(&mParseCacheMutex);
+        const QList<Parsing> * cached = mParseCache.object( key );
+        if( cached != nullptr )
+        {
+            mParseCacheHits++;
+            return *cached;
+        }
+        mParseCacheMisses++;
+    }
+
+    /// the debug log is a single stream, so with debug output the models are tried in this thread
+    if( parallelModels && !mDebugOutput && mMorphologicalModels.count() > 1 )
+    {
+        /// this thread tries models too, so the call finishes even if no pool thread is free
+        QSharedPointer<ModelParsingState> state( new ModelParsingState( normalized, modelFlags, mMorphologicalModels ) );
+        const int helpers = qMin( QThread::idealThreadCount(), mMorphologicalModels.count() ) - 1;
+        for(int i=0; i < helpers; i++)
+        {
+            QThreadPool::globalInstance()->start( new ModelParsingTask( state ) );
+        }
+        state->run();
+        candidates = state->results();
+    }
+    else
     {
-        parsingLog()->beginModel(model);
+        parsingLog()->beginParse(form);
 
-        Parsing p( normalize(form), model );
-        QList<Parsing> parsings = model->possibleParsings(p, flags);
-        candidates.append( parsings );
+        foreach(MorphologicalModel *model,  mMorphologicalModels)
+        {
+            parsingLog()->beginModel(model);
+
+            Parsing p( normalized, model );
+            QList<Parsing> parsings = model->possibleParsings(p, modelFlags);
+            candidates.append( parsings );
+
+            parsingLog()->end(); /// beginModel
+
+            /// with Parsing::OnlyOneResult, stop at the first model that succeeds
+            if( flags & Parsing::OnlyOneResult && !candidates.isEmpty() )
+            {
+                break;
+            }
+        }
+
+        parsingLog()->end(); /// beginParse
+    }
 
-        parsingLog()->end(); /// beginModel
+    if( detach )
+    {
+        for(int i=0; i < candidates.count(); i++)
+        {
+            candidates[i].detachFromModel();
+        }
     }
 
-    parsingLog()->end(); /// beginParse
+    if( useCache )
+    {
+        QMutexLocker locker(&mParseCacheMutex);
+        mParseCache.insert( key, new QList<Parsing>(candidates) );
+    }
 
     return candidates;
 }
 
+QList<QList<Parsing> > Morphology::possibleParsingsBatch(const QList<Form> &forms, Parsing::Flags flags, int threads) const
+{
+    if( threads < 1 )
+    {
+        threads = QThread::idealThreadCount();
+    }
+
+    /// the debug log is a single stream, so with debug output everything is parsed in this thread
+    if( mDebugOutput || threads == 1 || forms.count() < 2 )
+    {
+        QList<QList<Parsing> > results;
+        foreach( Form f, forms )
+        {
+            results << possibleParsings( f, flags );
+        }
+        return results;
+    }
+
+    /// each element is written by exactly one task; the vector is not resized while the pool is running
+    QVector<QList<Parsing> > results( forms.count() );
+    QList<Parsing> * resultData = results.data();
+    QAtomicInt nextIndex(0);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount( qMin( threads, forms.count() ) );
+    for(int i=0; i < pool.maxThreadCount(); i++)
+    {
+        pool.start( new BatchParsingTask( this, &forms, flags, resultData, &nextIndex ) );
+    }
+    pool.waitForDone();
+
+    return QList<QList<Parsing> >( results.begin(), results.end() );
+}
+
 QSet<Parsing> Morphology::uniqueParsings(const Form &form, Parsing::Flags flags) const
 {
     QList<Parsing> parsings = possibleParsings(normalize(form), flags);
@@ -121,7 +433,12 @@ QList<Parsing> Morphology::guessStem(const Form &form) const
     foreach(MorphologicalModel *model,  mMorphologicalModels)
     {
         Parsing p( normalize(form), model );
-        candidates.append( model->possibleParsings(p, Parsing::GuessStem) );
+        candidates.append( model->possibleParsings(p, static_cast<Parsing::Flags>( Parsing::GuessStem | Parsing::ReferenceModelObjects ) ) );
+    }
+
+    for(int i=0; i < candidates.count(); i++)
+    {
+        candidates[i].detachFromModel();
     }
 
     return candidates;
@@ -192,7 +509,8 @@ QList<Generation> Morphology::replaceStemInto(const Form &husk, const LexicalSte
 {
     QList<Generation> result;
 
-    QList<Parsing> parsings = possibleParsings( husk );
+    /// the parsings are not kept, so they needn't be detached from the model
+    QList<Parsing> parsings = possibleParsings( husk, Parsing::ReferenceModelObjects );
 
     QListIterator<Parsing> oldParsingIterator(parsings);
     while( oldParsingIterator.hasNext() )
@@ -215,7 +533,8 @@ QList<Generation> Morphology::transduceInto(const Form &form, const WritingSyste
 {
     QList<Generation> result;
 
-    QList<Parsing> parsings = possibleParsings( form );
+    /// the parsings are not kept, so they needn't be detached from the model
+    QList<Parsing> parsings = possibleParsings( form, Parsing::ReferenceModelObjects );
 
     QListIterator<Parsing> oldParsingIterator(parsings);
     while( oldParsingIterator.hasNext() )
@@ -238,7 +557,7 @@ QList<Generation> Morphology::transduceInto(const Form &form, const WritingSyste
 
 Generation Morphology::getFirstTransduction(const Form &form, const WritingSystem &newWs) const
 {
-    QList<Parsing> parsings = possibleParsings( form, Parsing::OnlyOneResult );
+    QList<Parsing> parsings = possibleParsings( form, static_cast<Parsing::Flags>( Parsing::OnlyOneResult | Parsing::ReferenceModelObjects ) );
     if( parsings.count() > 0 )
     {
         Parsing oldParsing = parsings.first();
@@ -273,6 +592,7 @@ Form Morphology::normalize(const Form &f) const
 void Morphology::setNormalizationFunction(const WritingSystem &forWs, InputNormalizer n)
 {
     mNormalizationFunctions[forWs] = n;
+    clearParseCache();
 }
 
 QSet<const AbstractStemList *> Morphology::getMatchingStemLists(const LexicalStem &stem) const
@@ -297,12 +617,48 @@ LexicalStemInsertResult Morphology::addLexicalStem(const LexicalStem &stem)
     while( iter.hasNext() )
     {
         AbstractStemList* asl = iter.next();
-        bool thisResult = asl->addStem( new LexicalStem(stem) );
+        /// addStem writes the new id to the copy
+        LexicalStem copy(stem);
+        bool thisResult = asl->addStem( &copy );
         result.recordResult( asl, thisResult );
+        if( thisResult )
+        {
+            reindexLexicalStem( copy.id() );
+        }
     }
+    clearParseCache();
     return result;
 }
 
+QList<LexicalStemInsertResult> Morphology::addLexicalStems(const QList<LexicalStem> &stems)
+{
+    QList<LexicalStemInsertResult> results;
+    results.reserve( stems.count() );
+    for(int i=0; i < stems.count(); i++)
+    {
+        results << LexicalStemInsertResult();
+    }
+
+    QSetIterator<AbstractStemList*> iter(mStemAcceptingStemLists);
+    while( iter.hasNext() )
+    {
+        AbstractStemList* asl = iter.next();
+        /// addStems writes the new ids to the copies
+        QList<LexicalStem> copies = stems;
+        const QList<bool> added = asl->addStems( copies );
+        for(int i=0; i < copies.count(); i++)
+        {
+            results[i].recordResult( asl, added.at(i) );
+            if( added.at(i) )
+            {
+                reindexLexicalStem( copies.at(i).id() );
+            }
+        }
+    }
+    clearParseCache();
+    return results;
+}
+
 LexicalStemInsertResult Morphology::replaceLexicalStem(const LexicalStem &stem)
 {
     LexicalStemInsertResult result;
@@ -313,20 +669,31 @@ LexicalStemInsertResult Morphology::replaceLexicalStem(const LexicalStem &stem)
         bool thisResult = asl->replaceStem( stem );
         result.recordResult( asl, thisResult );
     }
+    reindexLexicalStem( stem.id() );
+    clearParseCache();
     return result;
 }
 
 LexicalStem * Morphology::getLexicalStem(qlonglong id) const
 {
-    LexicalStemInsertResult result;
+    LexicalStem * ls = mLexicalStemsById.value( id, nullptr );
+    if( ls != nullptr )
+    {
+        return ls;
+    }
+
+    /// stems that are loaded on demand are not in the index
     QSetIterator<AbstractStemList*> iter( mStemLists );
     while( iter.hasNext() )
     {
         AbstractStemList* asl = iter.next();
-        LexicalStem * ls = asl->getStem( id );
-        if( ls != nullptr )
+        if( asl->loadsStemsOnDemand() )
         {
-            return ls;
+            ls = asl->getStem( id );
+            if( ls != nullptr )
+            {
+                return ls;
+            }
         }
     }
     return nullptr;
@@ -334,13 +701,53 @@ LexicalStem * Morphology::getLexicalStem(qlonglong id) const
 
 void Morphology::removeLexicalStem(qlonglong id)
 {
-    LexicalStemInsertResult result;
     QSetIterator<AbstractStemList*> iter(mStemAcceptingStemLists);
     while( iter.hasNext() )
     {
         AbstractStemList* asl = iter.next();
         asl->removeLexicalStem(id);
     }
+    reindexLexicalStem( id );
+    clearParseCache();
+}
+
+void Morphology::rebuildLexicalStemIndex()
+{
+    mLexicalStemsById.clear();
+    QSetIterator<AbstractStemList*> iter( mStemLists );
+    while( iter.hasNext() )
+    {
+        QSetIterator<LexicalStem*> si( iter.next()->stems() );
+        while( si.hasNext() )
+        {
+            LexicalStem * stem = si.next();
+            if( !mLexicalStemsById.contains( stem->id() ) )
+            {
+                mLexicalStemsById.insert( stem->id(), stem );
+            }
+        }
+    }
+}
+
+void Morphology::reindexLexicalStem(qlonglong id)
+{
+    /// another stem list may still have a stem with this id
+    mLexicalStemsById.remove( id );
+    QSetIterator<AbstractStemList*> iter( mStemLists );
+    while( iter.hasNext() )
+    {
+        AbstractStemList* asl = iter.next();
+        if( asl->loadsStemsOnDemand() )
+        {
+            continue;
+        }
+        LexicalStem * ls = asl->getStem( id );
+        if( ls != nullptr )
+        {
+            mLexicalStemsById.insert( id, ls );
+            return;
+        }
+    }
 }
 
 void Morphology::printModelCheck(QTextStream &out) const
@@ -481,6 +888,21 @@ QString Morphology::morphologyPath() const
     return mMorphologyPath;
 }
 
+QList<QPair<QString, qint64> > Morphology::loadTimings() const
+{
+    return mLoadTimings;
+}
+
+void Morphology::setReadStemListsInParallel(bool parallel)
+{
+    mReadStemListsInParallel = parallel;
+}
+
+bool Morphology::readStemListsInParallel() const
+{
+    return mReadStemListsInParallel;
+}
+
 const ParsingLog *Morphology::parsingLog() const
 {
     if( mDebugOutput )
@@ -493,6 +915,24 @@ const ParsingLog *Morphology::parsingLog() const
     }
 }
 
+AbstractConstraint::History Morphology::parseChartHistory() const
+{
+    if( mParseChartHistory == AbstractConstraint::AllSteps )
+    {
+        return AbstractConstraint::AllSteps;
+    }
+
+    QSetIterator<AbstractStemList*> iter(mStemLists);
+    while( iter.hasNext() )
+    {
+        if( iter.next()->hasStemPortmanteaux() )
+        {
+            return AbstractConstraint::AllSteps;
+        }
+    }
+    return mParseChartHistory;
+}
+
 void Morphology::setDebugOutput(bool newDebugOutput)
 {
     // if( newDebugOutput )
@@ -515,6 +955,61 @@ void Morphology::setStemDebugOutput(bool newStemDebugOutput)
     mStemDebugOutput = newStemDebugOutput;
 }
 
+void Morphology::setCollectStatistics(bool collect)
+{
+    mCollectStatistics = collect;
+}
+
+bool Morphology::collectStatistics() const
+{
+    return mCollectStatistics;
+}
+
+MorphologyStatistics Morphology::statistics() const
+{
+    MorphologyStatistics statistics;
+
+    QSet<const AbstractNode *> allNodes = nodes();
+    foreach( MorphologicalModel * mm, mMorphologicalModels )
+    {
+        allNodes << mm;
+    }
+    foreach( const AbstractNode * node, allNodes )
+    {
+        if( !node->counters().isEmpty() )
+        {
+            statistics.addNode( QString("%1, %2").arg(node->debugIdentifier(), node->id().toString()), node->counters() );
+        }
+    }
+
+    foreach( const AbstractConstraint * constraint, mConstraints )
+    {
+        if( !constraint->counters().isEmpty() )
+        {
+            const QString summary = constraint->oneLineSummary();
+            statistics.addConstraint( constraint->id().isEmpty() ? summary : QString("%1, %2").arg(constraint->id(), summary), constraint->counters() );
+        }
+    }
+
+    return statistics;
+}
+
+void Morphology::resetStatistics()
+{
+    foreach( AbstractNode * node, mNodes )
+    {
+        node->resetCounters();
+    }
+    foreach( MorphologicalModel * mm, mMorphologicalModels )
+    {
+        mm->resetCounters();
+    }
+    foreach( const AbstractConstraint * constraint, mConstraints )
+    {
+        constraint->resetCounters();
+    }
+}
+
 QString Morphology::summary() const
 {
     QString dbgString;
@@ -530,3 +1025,48 @@ QString Morphology::summary() const
 
     return dbgString;
 }
+
+void Morphology::setParseCacheSize(int maximumForms)
+{
+    QMutexLocker locker(&mParseCacheMutex);
+    mParseCache.setMaxCost( maximumForms );
+    mWellFormedCache.setMaxCost( maximumForms );
+}
+
+int Morphology::parseCacheSize() const
+{
+    QMutexLocker locker(&mParseCacheMutex);
+    return mParseCache.maxCost();
+}
+
+void Morphology::clearParseCache()
+{
+    QMutexLocker locker(&mParseCacheMutex);
+    mParseCache.clear();
+    mWellFormedCache.clear();
+}
+
+qint64 Morphology::parseCacheHits() const
+{
+    QMutexLocker locker(&mParseCacheMutex);
+    return mParseCacheHits;
+}
+
+qint64 Morphology::parseCacheMisses() const
+{
+    QMutexLocker locker(&mParseCacheMutex);
+    return mParseCacheMisses;
+}
+
+void Morphology::resetParseCacheCounters()
+{
+    QMutexLocker locker(&mParseCacheMutex);
+    mParseCacheHits = 0;
+    mParseCacheMisses = 0;
+}
+
+bool Morphology::parseCacheEnabled() const
+{
+    /// with debug output, the parse should actually be logged
+    return !mDebugOutput && parseCacheSize() > 0;
+}
@@ -3,6 +3,15 @@
   \brief A class representing the morphology of a language. The most important data structure is a list of MorphologicalModel objects. The most important method is possibleParsings, which returns a list of possible parsings for a given input.
 
   MorphologicalModel is a model of a particular part of a morphology, e.g., nouns or verbs.
+
+  \section Reentrancy
+  Once the model has been read, the const parsing functions (possibleParsings, uniqueParsings, isWellFormed, guessStem) may be called concurrently from several threads, provided that:
+  - debug output is off (the debug log is a single stream; see setDebugOutput());
+  - nothing modifies the model at the same time (readXmlFile, addLexicalStem, replaceLexicalStem, removeLexicalStem, setNormalizationFunction, etc.);
+  - Parsing::MAXIMUM_JUMPS is not changed while parsing;
+  - any normalization function set with setNormalizationFunction is itself reentrant.
+
+  possibleParsingsBatch() is a convenience function for parsing many forms this way.
 */
 
 #ifndef MORPHOLOGY_H
@@ -13,6 +22,9 @@
 
 #include "datatypes/lexicalstem.h"
 
+#include <QCache>
+#include <QMutex>
+
 namespace ME {
 
 class StemIdentityConstraint;
@@ -20,9 +32,22 @@ class MorphemeSequenceConstraint;
 class AbstractStemList;
 class LexicalStemInsertResult;
 class XmlParsingLog;
+class AbstractConstraint;
+class MorphologyStatistics;
 
 using InputNormalizer = std::function<QString(QString)>;
 
+/// the key of the parse cache: a normalized form, and the flags it was parsed with
+struct ParseCacheKey
+{
+    Form form;
+    int flags;
+
+    bool operator==(const ParseCacheKey & other) const { return flags == other.flags && form == other.form; }
+};
+
+inline uint qHash(const ParseCacheKey & key) { return qHash(key.form) ^ static_cast<uint>(key.flags); }
+
 
 class MORTAL_ENGINE_EXPORT Morphology
 {
@@ -37,6 +62,11 @@ public:
 
     /// Functions related to creating an object from XML
     void readXmlFile( const QString & path );
+
+    //! \brief Writes a snapshot of the stems of the model to \a path, which loadSnapshot() can use to avoid reading the stems from their sources. See MorphologySnapshot. Returns false if the snapshot could not be written. This reads the stems from their sources, so don't call it while other threads are parsing.
+    bool saveSnapshot( const QString & path ) const;
+    //! \brief Reads the morphology XML file that the snapshot at \a path was made from, taking the stems from the snapshot wherever their sources are unchanged. Returns the number of stem lists whose stems were taken from the snapshot; 0 means that every stem list was read from its source. Returns -1, without changing the model, if the snapshot cannot be read or the XML file has changed since the snapshot was made; call readXmlFile() (and perhaps saveSnapshot()) in that case.
+    int loadSnapshot( const QString & path );
     bool isWellFormed(const Form & form) const;
     void clearData();
 
@@ -46,8 +76,11 @@ public:
     QHash<QString, WritingSystem> writingSystems() const;
 
     /// Parsing/generating/transducing functions
+    //! \brief Returns the parsings of \a form from each of the models, in model order. With Parsing::OnlyOneResult, the results of the first model that has any are returned. With Parsing::ParallelModels, the models are tried concurrently on the global thread pool (unless debug output is on); the results are the same. With both flags, a model is abandoned as soon as a model before it has succeeded (see AbstractNode::setCancellationFlag). The parsings are detached from the model (see Parsing::detachFromModel) unless \a flags includes Parsing::ReferenceModelObjects, which is cheaper but only safe if the model is not changed while the parsings are in use.
     QList<Parsing> possibleParsings(const Form & form, Parsing::Flags flags = Parsing::None) const;
     QSet<Parsing> uniqueParsings(const Form & form, Parsing::Flags flags = Parsing::None) const;
+    //! \brief Returns possibleParsings() for each of \a forms, in the same order, parsing the forms with \a threads threads (or QThread::idealThreadCount() if \a threads is less than 1). The forms are parsed in the calling thread if debug output is on.
+    QList<QList<Parsing> > possibleParsingsBatch(const QList<Form> & forms, Parsing::Flags flags = Parsing::None, int threads = 0) const;
     QList<Parsing> guessStem(const Form & form) const;
     QList<Generation> generateForms(const WritingSystem & ws, StemIdentityConstraint sic, MorphemeSequenceConstraint msc , const MorphologicalModel *model = nullptr) const;
     QList<Generation> generateForms(const WritingSystem & ws, const LexicalStem & stem, const MorphemeSequence & morphemeSequence, const MorphologicalModel *model = nullptr) const;
@@ -63,7 +96,10 @@ public:
     /// Lexicon functions
     QSet<const AbstractStemList *> getMatchingStemLists(const LexicalStem & stem) const;
     LexicalStemInsertResult addLexicalStem(const LexicalStem & stem);
+    //! \brief Adds each of \a stems as addLexicalStem() does, returning the results in the same order. Each stem list receives all of its stems at once, which SQL stem lists write in a single transaction; this is much faster for large imports.
+    QList<LexicalStemInsertResult> addLexicalStems(const QList<LexicalStem> & stems);
     LexicalStemInsertResult replaceLexicalStem(const LexicalStem & stem);
+    //! \brief Returns the stem with \a id, or nullptr. The stem is owned by its stem list; for a stem list that loads its stems on demand, the pointer is only valid for a limited time (see AbstractSqlStemList::getStem()).
     LexicalStem * getLexicalStem(qlonglong id) const;
     void removeLexicalStem(qlonglong id);
 
@@ -102,8 +138,18 @@ public:
 
     QString morphologyPath() const;
 
+    //! \brief Returns the name and duration (in milliseconds) of each phase of the last call to readXmlFile() or loadSnapshot(), in order
+    QList< QPair<QString,qint64> > loadTimings() const;
+
+    //! \brief Sets whether readXmlFile() and loadSnapshot() read the stems of several stem lists at the same time, for those stem lists that allow it (see AbstractStemList::canReadStemsInParallel()). This is on by default; turning it off is mainly useful for comparing the two.
+    void setReadStemListsInParallel(bool parallel);
+    bool readStemListsInParallel() const;
+
     const ParsingLog *parsingLog() const;
 
+    //! \brief Returns how many of the steps of a parsing ParseChart has to compare: the most that any constraint examines (see AbstractConstraint::historyInspected()), or all of them if the model has portmanteaux, since a portmanteau clash can span any number of steps
+    AbstractConstraint::History parseChartHistory() const;
+
     void setDebugOutput(bool newDebugOutput);
 
     bool debugOutput() const;
@@ -111,6 +157,23 @@ public:
     bool stemDebugOutput() const;
     void setStemDebugOutput(bool newStemDebugOutput);
 
+    /// Parse cache
+    //! \brief Sets the number of forms whose parsings are kept, with the least recently used being discarded first. The cache is disabled when \a maximumForms is 0, which is the default. The cache is cleared when the model changes (readXmlFile, addLexicalStem, replaceLexicalStem, removeLexicalStem, setNormalizationFunction), and is not used when debug output is on. Call clearParseCache() after changing Parsing::MAXIMUM_JUMPS.
+    void setParseCacheSize(int maximumForms);
+    int parseCacheSize() const;
+    void clearParseCache();
+    qint64 parseCacheHits() const;
+    qint64 parseCacheMisses() const;
+    void resetParseCacheCounters();
+
+    /// Statistics
+    //! \brief Turns on or off the HotPathCounters of the nodes and constraints of the model. Collecting statistics is off by default; when it is off, the counters are not updated. Don't change this while other threads are parsing. Parsings that come from the parse cache are not counted.
+    void setCollectStatistics(bool collect);
+    bool collectStatistics() const;
+    //! \brief Returns the counters of each node and constraint that has been used since the statistics were last reset. The times of a node include the nodes that follow it.
+    MorphologyStatistics statistics() const;
+    void resetStatistics();
+
 private:
     QList<MorphologicalModel*> mMorphologicalModels;
     QHash<QString,WritingSystem> mWritingSystems;
@@ -122,11 +185,31 @@ private:
     QSet<AbstractStemList*> mStemAcceptingStemLists;
     QSet<AbstractStemList*> mStemLists;
     QSet<MorphemeNode*> mMorphemeNodes;
+    /// every constraint that was read from the XML file, for statistics()
+    QSet<const AbstractConstraint*> mConstraints;
+    /// the stems of every stem list by id, except those that are loaded on demand. If several stem lists have a stem with the same id, the first is kept.
+    QHash<qlonglong,LexicalStem*> mLexicalStemsById;
     QHash<WritingSystem,InputNormalizer> mNormalizationFunctions;
     QString mMorphologyPath;
+    QList< QPair<QString,qint64> > mLoadTimings;
     XmlParsingLog * mParsingLog;
     bool mDebugOutput;
     bool mStemDebugOutput;
+    bool mCollectStatistics;
+    bool mReadStemListsInParallel;
+    /// the history that the constraints and morpheme nodes call for, which MorphologyXmlReader::calculateModelProperties() sets; stem portmanteaux are checked in parseChartHistory(), since stems can be added later
+    AbstractConstraint::History mParseChartHistory;
+
+    void rebuildLexicalStemIndex();
+    //! \brief Updates mLexicalStemsById for \a id after a stem with that id has been added, replaced, or removed
+    void reindexLexicalStem(qlonglong id);
+
+    bool parseCacheEnabled() const;
+    mutable QMutex mParseCacheMutex;
+    mutable QCache<ParseCacheKey, QList<Parsing> > mParseCache;
+    mutable QCache<Form, bool> mWellFormedCache;
+    mutable qint64 mParseCacheHits;
+    mutable qint64 mParseCacheMisses;
 
     static ParsingLog NULL_PARSING_LOG;
 };
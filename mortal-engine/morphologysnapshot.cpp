@@ -0,0 +1,336 @@
+#include "morphologysnapshot.h"
+
+#include "morphology.h"
+#include "nodes/abstractstemlist.h"
+#include "datatypes/lexicalstem.h"
+#include "datatypes/allomorph.h"
+#include "datatypes/writingsystem.h"
+
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtDebug>
+
+using namespace ME;
+
+/// "MESN"
+quint32 MorphologySnapshot::MAGIC = 0x4D45534E;
+/// increment this whenever the format changes
+quint32 MorphologySnapshot::VERSION = 2;
+
+namespace {
+
+/// the stream version is fixed so that snapshots don't depend on the Qt version that wrote them
+const QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_12;
+
+}
+
+MorphologySnapshot::MorphologySnapshot() : mData(nullptr), mBlocksStart(0)
+{
+
+}
+
+MorphologySnapshot::~MorphologySnapshot()
+{
+    if( mData != nullptr )
+    {
+        mFile.unmap( const_cast<uchar*>(mData) );
+    }
+}
+
+bool MorphologySnapshot::save(const Morphology *morphology, const QString &path)
+{
+    const QString morphologyPath = QFileInfo( morphology->morphologyPath() ).absoluteFilePath();
+    const QByteArray modelChecksum = fileChecksum( morphologyPath );
+    if( modelChecksum.isEmpty() )
+    {
+        qWarning() << "MorphologySnapshot::save()" << "Could not read the morphology file:" << morphologyPath;
+        return false;
+    }
+
+    /// stem lists with the same source have the same stems, so they are stored once
+    QList<QByteArray> fingerprints;
+    QList<QByteArray> blocks;
+    QSetIterator<AbstractStemList *> i( morphology->stemLists() );
+    while( i.hasNext() )
+    {
+        AbstractStemList * stemList = i.next();
+        const QByteArray fingerprint = stemList->sourceFingerprint();
+        if( fingerprint.isEmpty() || fingerprints.contains(fingerprint) )
+        {
+            continue;
+        }
+        fingerprints << fingerprint;
+        blocks << stemListBlock( stemList, morphology->writingSystems() );
+    }
+
+    /// the payload is the path and checksum of the model, then a directory of the stem lists, then the stem lists
+    QByteArray payload;
+    QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+    payloadStream.setVersion(STREAM_VERSION);
+    payloadStream << morphologyPath << modelChecksum;
+    payloadStream << static_cast<qint32>( blocks.count() );
+    qint64 offset = 0;
+    for(int j=0; j < blocks.count(); j++)
+    {
+        payloadStream << fingerprints.at(j) << offset << static_cast<qint64>( blocks.at(j).size() );
+        offset += blocks.at(j).size();
+    }
+    for(int j=0; j < blocks.count(); j++)
+    {
+        payloadStream.writeRawData( blocks.at(j).constData(), blocks.at(j).size() );
+    }
+
+    /// QSaveFile only replaces the existing snapshot once the new one is completely written
+    QSaveFile file(path);
+    if( !file.open(QIODevice::WriteOnly) )
+    {
+        qWarning() << "MorphologySnapshot::save()" << "Could not open the file for writing:" << path << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(STREAM_VERSION);
+    out << MAGIC << VERSION << QCryptographicHash::hash( payload, QCryptographicHash::Sha1 );
+    out.writeRawData( payload.constData(), payload.size() );
+
+    if( out.status() != QDataStream::Ok || !file.commit() )
+    {
+        qWarning() << "MorphologySnapshot::save()" << "Could not write the file:" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool MorphologySnapshot::open(const QString &path)
+{
+    mFile.setFileName(path);
+    if( !mFile.open(QIODevice::ReadOnly) )
+    {
+        qWarning() << "MorphologySnapshot::open()" << "Could not open the file:" << path << mFile.errorString();
+        return false;
+    }
+
+    const qint64 size = mFile.size();
+    mData = mFile.map(0, size);
+    if( mData == nullptr )
+    {
+        qWarning() << "MorphologySnapshot::open()" << "Could not map the file:" << path << mFile.errorString();
+        return false;
+    }
+
+    const QByteArray data = QByteArray::fromRawData( reinterpret_cast<const char*>(mData), static_cast<int>(size) );
+    QDataStream in(data);
+    in.setVersion(STREAM_VERSION);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray checksum;
+    in >> magic >> version;
+    if( magic != MAGIC || version != VERSION )
+    {
+        qWarning() << "MorphologySnapshot::open()" << "The file is not a snapshot, or is from a different version:" << path;
+        return false;
+    }
+    in >> checksum;
+    if( in.status() != QDataStream::Ok )
+    {
+        qWarning() << "MorphologySnapshot::open()" << "The file is truncated:" << path;
+        return false;
+    }
+
+    const qint64 payloadStart = in.device()->pos();
+    const QByteArray payload = QByteArray::fromRawData( reinterpret_cast<const char*>(mData + payloadStart), static_cast<int>(size - payloadStart) );
+    if( QCryptographicHash::hash( payload, QCryptographicHash::Sha1 ) != checksum )
+    {
+        qWarning() << "MorphologySnapshot::open()" << "The file does not match its checksum:" << path;
+        return false;
+    }
+
+    QDataStream payloadStream(payload);
+    payloadStream.setVersion(STREAM_VERSION);
+    payloadStream >> mMorphologyPath >> mModelChecksum;
+
+    qint32 count = 0;
+    payloadStream >> count;
+    for(int i=0; i < count && payloadStream.status() == QDataStream::Ok; i++)
+    {
+        QByteArray fingerprint;
+        qint64 offset = 0;
+        qint64 length = 0;
+        payloadStream >> fingerprint >> offset >> length;
+        mBlocks.insert( fingerprint, qMakePair(offset, length) );
+    }
+
+    if( payloadStream.status() != QDataStream::Ok )
+    {
+        qWarning() << "MorphologySnapshot::open()" << "The file could not be read:" << path;
+        mBlocks.clear();
+        return false;
+    }
+
+    mBlocksStart = payloadStart + payloadStream.device()->pos();
+    return true;
+}
+
+bool MorphologySnapshot::modelIsUnchanged() const
+{
+    return !mModelChecksum.isEmpty() && fileChecksum( mMorphologyPath ) == mModelChecksum;
+}
+
+QString MorphologySnapshot::morphologyPath() const
+{
+    return mMorphologyPath;
+}
+
+bool MorphologySnapshot::restoreStems(AbstractStemList *stemList, const QHash<QString, WritingSystem> &writingSystems) const
+{
+    if( mData == nullptr )
+    {
+        return false;
+    }
+
+    const QByteArray fingerprint = stemList->sourceFingerprint();
+    if( fingerprint.isEmpty() || !mBlocks.contains(fingerprint) )
+    {
+        return false;
+    }
+
+    const QPair<qint64,qint64> block = mBlocks.value(fingerprint);
+    const QByteArray data = QByteArray::fromRawData( reinterpret_cast<const char*>(mData + mBlocksStart + block.first), static_cast<int>(block.second) );
+    QDataStream in(data);
+    in.setVersion(STREAM_VERSION);
+
+    qint32 stemCount = 0;
+    in >> stemCount;
+
+    QSet<LexicalStem*> stems;
+    for(int i=0; i < stemCount && in.status() == QDataStream::Ok; i++)
+    {
+        LexicalStem * stem = new LexicalStem;
+        stems << stem;
+
+        qlonglong stemId = -1;
+        QString liftGuid;
+        in >> stemId >> liftGuid;
+        stem->setId(stemId);
+        if( !liftGuid.isEmpty() )
+            stem->setLiftGuid( liftGuid );
+
+        qint32 glossCount = 0;
+        in >> glossCount;
+        for(int j=0; j < glossCount && in.status() == QDataStream::Ok; j++)
+        {
+            QString lang, text;
+            in >> lang >> text;
+            stem->setGloss( Form( writingSystems.value(lang), text ) );
+        }
+
+        qint32 allomorphCount = 0;
+        in >> allomorphCount;
+        for(int j=0; j < allomorphCount && in.status() == QDataStream::Ok; j++)
+        {
+            qlonglong allomorphId = -1;
+            bool useInGenerations = true;
+            QString portmanteau;
+            in >> allomorphId >> useInGenerations >> portmanteau;
+
+            Allomorph a(Allomorph::Original);
+            a.setId(allomorphId);
+            a.setUseInGenerations(useInGenerations);
+            if( portmanteau.length() > 0 )
+                a.setPortmanteau( Portmanteau(portmanteau) );
+
+            qint32 formCount = 0;
+            in >> formCount;
+            for(int k=0; k < formCount && in.status() == QDataStream::Ok; k++)
+            {
+                QString lang, text;
+                in >> lang >> text;
+                a.setForm( Form( writingSystems.value(lang), text ) );
+            }
+
+            QStringList tags;
+            in >> tags;
+            foreach( QString tag, tags )
+            {
+                a.addTag( tag );
+            }
+
+            stem->insert( a );
+        }
+    }
+
+    if( in.status() != QDataStream::Ok )
+    {
+        qWarning() << "MorphologySnapshot::restoreStems()" << "The stems could not be read for" << stemList->debugIdentifier();
+        qDeleteAll( stems );
+        return false;
+    }
+
+    stemList->mStems.unite( stems );
+    return true;
+}
+
+QByteArray MorphologySnapshot::fileChecksum(const QString &path)
+{
+    QFile file(path);
+    if( !file.open(QIODevice::ReadOnly) )
+    {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData( &file );
+    return hash.result();
+}
+
+QByteArray MorphologySnapshot::stemListBlock(AbstractStemList *stemList, const QHash<QString, WritingSystem> &writingSystems)
+{
+    const QSet<LexicalStem*> stems = stemList->readStemsFromSource( writingSystems );
+
+    QByteArray block;
+    QDataStream out(&block, QIODevice::WriteOnly);
+    out.setVersion(STREAM_VERSION);
+
+    out << static_cast<qint32>( stems.count() );
+    foreach( const LexicalStem * stem, stems )
+    {
+        out << stem->id() << stem->liftGuid();
+
+        const QHash<WritingSystem, Form> glosses = stem->glosses();
+        out << static_cast<qint32>( glosses.count() );
+        QHashIterator<WritingSystem, Form> gi( glosses );
+        while( gi.hasNext() )
+        {
+            gi.next();
+            out << gi.key().abbreviation() << gi.value().text();
+        }
+
+        out << static_cast<qint32>( stem->allomorphCount() );
+        for(int i=0; i < stem->allomorphCount(); i++)
+        {
+            const Allomorph & a = stem->allomorph(i);
+            out << a.id() << a.useInGenerations() << a.portmanteau().initializationString();
+
+            const QHash<WritingSystem, Form> forms = a.forms();
+            out << static_cast<qint32>( forms.count() );
+            QHashIterator<WritingSystem, Form> fi( forms );
+            while( fi.hasNext() )
+            {
+                fi.next();
+                out << fi.key().abbreviation() << fi.value().text();
+            }
+
+            QStringList tags;
+            foreach( Tag t, a.tags() )
+            {
+                tags << t.label();
+            }
+            out << tags;
+        }
+    }
+
+    qDeleteAll( stems );
+    return block;
+}
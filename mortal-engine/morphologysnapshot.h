@@ -0,0 +1,68 @@
+/*!
+  \class MorphologySnapshot
+  \brief A binary image of the stems of a Morphology, which can be used instead of reading the stems from their sources (SQLite databases, XML stem lists) when the Morphology is next loaded.
+
+  The snapshot records the path of the morphology XML file and a checksum of its contents, so that a snapshot of a model that has since changed is not used. Each stem list is stored under a fingerprint of its source (see AbstractStemList::sourceFingerprint), and when the model is read, a stem list takes its stems from the snapshot only if its fingerprint is unchanged; otherwise it reads them from the source as usual. Stem lists with no fingerprint are never stored.
+
+  The file is memory-mapped when it is read, and the stems of each stem list are decoded only when that stem list asks for them.
+
+  The stems are stored as they are in their sources, i.e., without the allomorphs that are derived from them with CreateAllomorphs. The derived allomorphs carry constraints that are created while the model is read, so they are generated again when the model is read.
+*/
+
+#ifndef MORPHOLOGYSNAPSHOT_H
+#define MORPHOLOGYSNAPSHOT_H
+
+#include <QFile>
+#include <QHash>
+#include <QByteArray>
+#include <QPair>
+
+class QDataStream;
+
+namespace ME {
+
+class Morphology;
+class AbstractStemList;
+class WritingSystem;
+
+class MorphologySnapshot
+{
+public:
+    MorphologySnapshot();
+    ~MorphologySnapshot();
+    MorphologySnapshot(const MorphologySnapshot &) = delete;
+    MorphologySnapshot &operator=(const MorphologySnapshot &) = delete;
+
+    //! \brief Writes a snapshot of \a morphology to \a path. The stems are read again from their sources, so that derived allomorphs are not included. Returns false if the file could not be written.
+    static bool save(const Morphology * morphology, const QString & path);
+
+    //! \brief Opens and checks the snapshot at \a path. Returns false if the file cannot be read, has a different format version, or fails its checksum.
+    bool open(const QString & path);
+
+    //! \brief Returns true if the morphology XML file has the same contents as when the snapshot was made
+    bool modelIsUnchanged() const;
+
+    QString morphologyPath() const;
+
+    //! \brief If the snapshot has stems for the source of \a stemList, adds them to \a stemList and returns true; otherwise returns false.
+    bool restoreStems(AbstractStemList * stemList, const QHash<QString, WritingSystem> &writingSystems) const;
+
+    static quint32 MAGIC;
+    static quint32 VERSION;
+
+private:
+    static QByteArray fileChecksum(const QString & path);
+    static QByteArray stemListBlock(AbstractStemList * stemList, const QHash<QString, WritingSystem> &writingSystems);
+
+    QFile mFile;
+    const uchar * mData;
+    qint64 mBlocksStart;
+    QString mMorphologyPath;
+    QByteArray mModelChecksum;
+    /// for each stem list fingerprint, the offset and length of its block, relative to mBlocksStart
+    QHash<QByteArray, QPair<qint64,qint64> > mBlocks;
+};
+
+} // namespace ME
+
+#endif // MORPHOLOGYSNAPSHOT_H
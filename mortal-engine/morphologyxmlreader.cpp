@@ -3,12 +3,17 @@
 #include <QXmlStreamReader>
 
 #include "morphology.h"
+#include "morphologysnapshot.h"
 
 #include "datatypes/writingsystem.h"
 
 #include <QFile>
 #include <QStack>
 #include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
 
 /// these includes need to be there so we get the derived version of the static functions
 #include "nodes/morphologicalmodel.h"
@@ -41,6 +46,28 @@
 
 using namespace ME;
 
+namespace {
+
+/// reads the stems of one stem list, in a thread of the pool created by MorphologyXmlReader::readStemLists()
+class StemReadingTask : public QRunnable
+{
+public:
+    StemReadingTask(AbstractStemList * stemList, const QHash<QString,WritingSystem> * writingSystems) : mStemList(stemList), mWritingSystems(writingSystems)
+    {
+    }
+
+    void run() override
+    {
+        mStemList->readStems( *mWritingSystems );
+    }
+
+private:
+    AbstractStemList * mStemList;
+    const QHash<QString,WritingSystem> * mWritingSystems;
+};
+
+}
+
 QString MorphologyXmlReader::XML_MORPHOLOGY = "morphology";
 QString MorphologyXmlReader::XML_MAXIMUM_JUMPS = "maximum-jumps";
 QString MorphologyXmlReader::XML_PATH = "path";
@@ -56,7 +83,7 @@ QString MorphologyXmlReader::XML_REPLACE = "replace";
 QString MorphologyXmlReader::XML_THIS = "this";
 QString MorphologyXmlReader::XML_WITH = "with";
 
-MorphologyXmlReader::MorphologyXmlReader(Morphology *morphology) : mMorphology(morphology)
+MorphologyXmlReader::MorphologyXmlReader(Morphology *morphology) : mMorphology(morphology), mSnapshot(nullptr), mRestoredStemListCount(0)
 {
     registerConstraintMatcher<TagMatchCondition>();
     registerConstraintMatcher<PhonologicalCondition>();
@@ -93,33 +120,58 @@ MorphologyXmlReader::MorphologyXmlReader(Morphology *morphology) : mMorphology(m
 void MorphologyXmlReader::readXmlFile(const QString &path)
 {
     mMorphology->mMorphologyPath = path;
+    mPhaseTimings.clear();
+    mRestoredStemListCount = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    auto endPhase = [&](const QString & name)
+    {
+        mPhaseTimings << qMakePair( name, timer.restart() );
+    };
 
     /// read the xml from the file
     parseXml(path);
+    endPhase("parse XML");
+
+    /// read the stems of the stem lists found while parsing
+    readStemLists();
+    endPhase("read stems");
 
     /// populate
     populateNodeHashes();
+    endPhase("populate node hashes");
 
     /// for every jump pointer, fill in the pointer to the target of the to="node-id" attribute
     fillInJumpPointers();
+    endPhase("fill in jump pointers");
 
     /// for every constraint pointer, fill in the pointer to the target of the id="constraint-id" attribute
     fillInConstraintPointers();
+    endPhase("fill in constraint pointers");
 
     /// call generateAllomorphs for every node
     generateAllomorphsFromRules();
+    endPhase("generate allomorphs");
+
+    /// index the stems of every stem list by id, now that they are all read
+    mMorphology->rebuildLexicalStemIndex();
+    endPhase("index stems");
 
     /// call initializePortmanteaux for every node with portmanteau. can't recall right now whether the ordering here is significant but I think it is.
     parsePortmanteaux();
+    endPhase("parse portmanteaux");
 
     /// call calculateModelProperties for every node. At this point it only ends up calling checkHasOptionalCompletionPath, but it might do more in the future.
     calculateModelProperties();
+    endPhase("calculate model properties");
 
     /// need to check here whether there are inconsistent nested constraints, i.e., once the pointers have been filled in
     checkNestedConstraintConsistency();
 
     /// check whether there are any nodes with ambiguous node/label combinations
     checkForNonUniqueIdsAndLabels();
+    endPhase("check model");
 }
 
 void MorphologyXmlReader::parseXml(const QString &path)
@@ -259,6 +311,66 @@ void MorphologyXmlReader::recordStemList(AbstractStemList *stemList) const
     mMorphology->mStemLists.insert( stemList );
 }
 
+void MorphologyXmlReader::readStems(AbstractStemList *stemList)
+{
+    mPendingStemLists << stemList;
+}
+
+void MorphologyXmlReader::readStemLists()
+{
+    const QHash<QString,WritingSystem> writingSystems = mMorphology->writingSystems();
+
+    QList<AbstractStemList*> parallel;
+    foreach( AbstractStemList * stemList, mPendingStemLists )
+    {
+        if( mSnapshot != nullptr && mSnapshot->restoreStems( stemList, writingSystems ) )
+        {
+            mRestoredStemListCount++;
+            continue;
+        }
+
+        if( mMorphology->readStemListsInParallel() && stemList->canReadStemsInParallel() )
+        {
+            parallel << stemList;
+        }
+        else
+        {
+            stemList->readStems( writingSystems );
+        }
+    }
+    mPendingStemLists.clear();
+
+    if( parallel.count() == 1 )
+    {
+        parallel.first()->readStems( writingSystems );
+    }
+    else if( parallel.count() > 1 )
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount( qMin( QThread::idealThreadCount(), parallel.count() ) );
+        foreach( AbstractStemList * stemList, parallel )
+        {
+            pool.start( new StemReadingTask( stemList, &writingSystems ) );
+        }
+        pool.waitForDone();
+    }
+}
+
+QList<QPair<QString, qint64> > MorphologyXmlReader::phaseTimings() const
+{
+    return mPhaseTimings;
+}
+
+int MorphologyXmlReader::restoredStemListCount() const
+{
+    return mRestoredStemListCount;
+}
+
+void MorphologyXmlReader::setSnapshot(const MorphologySnapshot *snapshot)
+{
+    mSnapshot = snapshot;
+}
+
 AbstractNode *MorphologyXmlReader::readNodes(QXmlStreamReader &in, const QString &untilEndOf, const MorphologicalModel * currentModel)
 {
     AbstractNode * initialNode = tryToReadMorphemeNode( in, currentModel );
@@ -413,7 +525,12 @@ AbstractConstraint *MorphologyXmlReader::tryToReadConstraint(QXmlStreamReader &i
         ConstraintMatcher acm = i.next();
         if( acm.matcher(in) )
         {
-            return acm.reader( in, this );
+            AbstractConstraint * constraint = acm.reader( in, this );
+            if( constraint != nullptr )
+            {
+                mMorphology->mConstraints << constraint;
+            }
+            return constraint;
         }
     }
     return nullptr;
@@ -549,6 +666,22 @@ void MorphologyXmlReader::calculateModelProperties()
         AbstractNode * n = i.next();
         n->calculateModelProperties();
     }
+
+    /// the parse chart compares as many steps as any constraint examines, or every step if there are portmanteaux
+    mMorphology->mParseChartHistory = AbstractConstraint::NoHistory;
+    QSetIterator<const AbstractConstraint *> ci( mMorphology->mConstraints );
+    while( ci.hasNext() )
+    {
+        mMorphology->mParseChartHistory = qMax( mMorphology->mParseChartHistory, ci.next()->historyInspected() );
+    }
+    QSetIterator<MorphemeNode *> mi( mMorphology->mMorphemeNodes );
+    while( mi.hasNext() )
+    {
+        if( mi.next()->hasPortmanteaux() )
+        {
+            mMorphology->mParseChartHistory = AbstractConstraint::AllSteps;
+        }
+    }
 }
 
 void MorphologyXmlReader::checkNestedConstraintConsistency()
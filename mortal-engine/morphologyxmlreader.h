@@ -34,6 +34,7 @@ class MorphologicalModel;
 class MorphemeNode;
 class Jump;
 class CopyNode;
+class MorphologySnapshot;
 
 class MORTAL_ENGINE_EXPORT MorphologyXmlReader
 {
@@ -53,6 +54,10 @@ public:
     void recordStemAcceptingNewStems( AbstractStemList* stemList ) const;
     void recordStemList( AbstractStemList* stemList ) const;
 
+    //! \brief Records that the stems of \a stemList are to be read once the XML has been parsed (see readStemLists())
+    void readStems( AbstractStemList* stemList );
+    void setSnapshot(const MorphologySnapshot * snapshot);
+
     AbstractConstraint* tryToReadConstraint(QXmlStreamReader &in);
     bool currentNodeMatchesConstraint(QXmlStreamReader &in) const;
 
@@ -65,9 +70,18 @@ public:
 
     QHash<QString,WritingSystem> writingSystems() const;
 
+    //! \brief Returns the name and duration (in milliseconds) of each phase of readXmlFile(), in order
+    QList< QPair<QString,qint64> > phaseTimings() const;
+
+    //! \brief Returns the number of stem lists whose stems the last call to readXmlFile() took from the snapshot (see setSnapshot())
+    int restoredStemListCount() const;
+
 private:
     void parseXml(const QString &path );
 
+    //! \brief Reads the stems of the stem lists passed to readStems(): from the snapshot if one has been set and it has them, and otherwise from the stem list's source. Stem lists that allow it are read in parallel, unless Morphology::readStemListsInParallel() is false.
+    void readStemLists();
+
     void populateNodeHashes();
     /// NB: this currently only checks MorphemeNodes
     void checkForNonUniqueIdsAndLabels();
@@ -125,6 +139,10 @@ private:
     QSet<PointerToConstraint *> mPointers;
     QSet<AbstractStemList*> mStemNodes;
     QSet<const AbstractNestedConstraint*> mNestedConstraints;
+    const MorphologySnapshot * mSnapshot;
+    QList<AbstractStemList*> mPendingStemLists;
+    int mRestoredStemListCount;
+    QList< QPair<QString,qint64> > mPhaseTimings;
 };
 
 } // namespace ME
@@ -6,14 +6,21 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamAttributes>
 #include <QDomElement>
+#include <QElapsedTimer>
 
 #include "morphologyxmlreader.h"
 #include "morphology.h"
 #include "datatypes/generation.h"
+#include "datatypes/parsechart.h"
 #include "logging/parsinglog.h"
 
 using namespace ME;
 
+namespace {
+/// see AbstractNode::setCancellationFlag()
+thread_local const QAtomicInt * sCancellationFlag = nullptr;
+}
+
 QString AbstractNode::XML_OPTIONAL = "optional";
 QString AbstractNode::XML_ADD_ALLOMORPHS = "add-allomorphs";
 
@@ -28,12 +35,83 @@ AbstractNode::AbstractNode(const Morphology *morphology, const MorphologicalMode
 }
 
 QList<Parsing> AbstractNode::possibleParsings(const Parsing &parsing, Parsing::Flags flags) const
+{
+    if( sCancellationFlag != nullptr && sCancellationFlag->loadAcquire() != 0 )
+    {
+        return QList<Parsing>();
+    }
+
+    if( flags & Parsing::UseParseChart )
+    {
+        if( parsing.parseChart() == nullptr )
+        {
+            /// with debug output the stack traces and the log would differ, so don't share results
+            if( mMorphology->debugOutput() )
+            {
+                return possibleParsings( parsing, static_cast<Parsing::Flags>( flags & ~Parsing::UseParseChart ) );
+            }
+
+            /// this is the top-level call, so the chart lasts for the duration of this parse
+            ParseChart chart( mMorphology->parseChartHistory() );
+            Parsing p = parsing;
+            p.setParseChart( &chart );
+            QList<Parsing> candidates = possibleParsings( p, flags );
+            for(int i=0; i<candidates.count(); i++)
+            {
+                candidates[i].setParseChart( nullptr );
+            }
+            return candidates;
+        }
+
+        QList<Parsing> candidates;
+        if( parsing.parseChart()->lookup( this, parsing, candidates ) )
+        {
+            return candidates;
+        }
+        candidates = possibleParsingsFromThisNode( parsing, flags );
+        parsing.parseChart()->insert( this, parsing, candidates );
+        return candidates;
+    }
+    else
+    {
+        return possibleParsingsFromThisNode( parsing, flags );
+    }
+}
+
+const QAtomicInt *AbstractNode::setCancellationFlag(const QAtomicInt *flag)
+{
+    const QAtomicInt * previous = sCancellationFlag;
+    sCancellationFlag = flag;
+    return previous;
+}
+
+QList<Parsing> AbstractNode::possibleParsingsFromThisNode(const Parsing &parsing, Parsing::Flags flags) const
+{
+    if( !collectStatistics() )
+    {
+        return possibleParsingsFromThisNodeUncounted( parsing, flags );
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QList<Parsing> candidates = possibleParsingsFromThisNodeUncounted( parsing, flags );
+    mCounters.add( HotPathCounters::Visits );
+    mCounters.add( HotPathCounters::CandidatesProduced, candidates.count() );
+    mCounters.add( HotPathCounters::Nanoseconds, timer.nsecsElapsed() );
+    return candidates;
+}
+
+QList<Parsing> AbstractNode::possibleParsingsFromThisNodeUncounted(const Parsing &parsing, Parsing::Flags flags) const
 {
     bool nodeRequired = parsing.nextNodeRequired();
     Parsing p = parsing;
 
-    /// Parsing::addToStackTrace is only actually called in the XmlParsingLog implementation
-    parsingLog()->addToStackTrace( p, QString("%1, %2").arg(debugIdentifier(), id().toString()) );
+    /// Parsing::addToStackTrace is only actually called in the XmlParsingLog implementation,
+    /// so don't build the label for a log that is not enabled
+    if( parsingLog()->isEnabled() )
+    {
+        parsingLog()->addToStackTrace( p, QString("%1, %2").arg(debugIdentifier(), id().toString()) );
+    }
 
     /// TODO keep thinking about this logic. This means that we only stop requiring a node when a
     /// morpheme is appended. At the least the input should be something like next-morpheme-required="true"
@@ -212,6 +290,26 @@ const ParsingLog *AbstractNode::parsingLog() const
     return mMorphology->parsingLog();
 }
 
+bool AbstractNode::collectStatistics() const
+{
+    return mMorphology->collectStatistics();
+}
+
+const HotPathCounters &AbstractNode::counters() const
+{
+    return mCounters;
+}
+
+void AbstractNode::resetCounters() const
+{
+    mCounters.reset();
+}
+
+HotPathCounters *AbstractNode::statisticsCounters() const
+{
+    return collectStatistics() ? &mCounters : nullptr;
+}
+
 void AbstractNode::setNext(AbstractNode *next)
 {
     mNext = next;
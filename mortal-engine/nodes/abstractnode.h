@@ -12,10 +12,12 @@
 
 #include <QString>
 #include <QMap>
+#include <QAtomicInt>
 
 #include "datatypes/morphemelabel.h"
 #include "datatypes/nodeid.h"
 #include "datatypes/parsing.h"
+#include "datatypes/hotpathcounters.h"
 #include "mortal-engine_global.h"
 
 class QXmlStreamWriter;
@@ -56,7 +58,10 @@ public:
     virtual QString summary(const AbstractNode * doNotFollow = nullptr) const;
     QString oneLineSummary() const;
 
+    //! \brief Returns the parsings that can be made from \a parsing, starting at this node. With Parsing::UseParseChart, the results for identical parsing states are computed only once per parse.
     QList<Parsing> possibleParsings( const Parsing & parsing, Parsing::Flags flags) const;
+    //! \brief Sets the flag that possibleParsings() checks in the current thread: once \a flag is nonzero, no further parsings are made, so that a parse whose results will be discarded can be abandoned. Pass nullptr to stop checking. Returns the flag that was set before, so that it can be restored.
+    static const QAtomicInt * setCancellationFlag(const QAtomicInt * flag);
     QList<Generation> generateForms( const Generation & generation ) const;
     bool appendIfComplete(QList<Generation> &candidates, const Generation & generation) const;
     void appendIfComplete(QList<Parsing> &candidates, const Parsing & parsing) const;
@@ -141,11 +146,22 @@ public:
 
     const ParsingLog * parsingLog() const;
 
+    //! \brief Returns true if the model is collecting statistics (see Morphology::setCollectStatistics())
+    bool collectStatistics() const;
+    //! \brief Returns the counters of this node, which are only updated when statistics are being collected
+    const HotPathCounters & counters() const;
+    void resetCounters() const;
+
 protected:
+    //! \brief Returns the counters of this node if statistics are being collected, or nullptr otherwise. This can be passed to Parsing::allomorphMatches().
+    HotPathCounters * statisticsCounters() const;
+
     QHash<WritingSystem,Form> mGlosses;
     const Morphology * mMorphology;
 
 private:
+    QList<Parsing> possibleParsingsFromThisNode( const Parsing & parsing, Parsing::Flags flags) const;
+    QList<Parsing> possibleParsingsFromThisNodeUncounted( const Parsing & parsing, Parsing::Flags flags) const;
     virtual QList<Parsing> parsingsUsingThisNode( const Parsing & parsing, Parsing::Flags flags) const = 0;
     virtual QList<Generation> generateFormsUsingThisNode( const Generation & generation ) const = 0;
 
@@ -156,6 +172,7 @@ private:
     bool mOptional;
     NodeId mId;
     bool mHasPathToEnd;
+    mutable HotPathCounters mCounters;
 };
 
 } // namespace ME
@@ -1,13 +1,17 @@
 #include "abstractsqlstemlist.h"
 
+#include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlDriver>
 #include <QSqlError>
 #include <QXmlStreamReader>
 #include <QtDebug>
 #include <QElapsedTimer>
+#include <QThread>
+#include <QAtomicInt>
 
 #include "datatypes/lexicalstem.h"
+#include "morphology.h"
 
 using namespace ME;
 
@@ -25,9 +29,51 @@ QString AbstractSqlStemList::TABLE_TAGMEMBERS = "TagMembers";
 
 QString AbstractSqlStemList::STEM_CONNECTION = "stem-connection";
 QString AbstractSqlStemList::ALLOMORPH_CONNECTION = "allomorph-connection";
+QString AbstractSqlStemList::ON_DEMAND_CONNECTION = "on-demand-connection";
+QString AbstractSqlStemList::READER_CONNECTION = "reader-connection";
+const int AbstractSqlStemList::DEFAULT_CACHE_SIZE = 10000;
+
+namespace {
+
+QString onDemandKey(const WritingSystem & ws, const QString & form)
+{
+    return ws.abbreviation() + QChar('\t') + form;
+}
+
+/// numbers the on-demand connections, since a thread's address may be reused once it has finished
+QAtomicInt onDemandConnectionCount;
+
+}
+
+/// The on-demand connection of one thread. It is deleted by QThreadStorage when the thread finishes, which removes the connection.
+class AbstractSqlStemList::OnDemandConnection
+{
+public:
+    explicit OnDemandConnection(const QString & name) : mName(name)
+    {
+    }
+
+    ~OnDemandConnection()
+    {
+        QSqlDatabase::removeDatabase(mName);
+    }
+
+    QString name() const
+    {
+        return mName;
+    }
+
+private:
+    QString mName;
+};
 
 AbstractSqlStemList::AbstractSqlStemList(const MorphologicalModel *model) :
     AbstractStemList(model),
+    mConnectionThread(QThread::currentThread()),
+    mLoadOnDemand(false),
+    mStemIdsByForm(DEFAULT_CACHE_SIZE),
+    mStemCache(DEFAULT_CACHE_SIZE),
+    mStemsLoadedById(DEFAULT_CACHE_SIZE),
     mDbName(DEFAULT_DBNAME),
     mReadGlosses(true),
     mCreateTables(true)
@@ -37,6 +83,9 @@ AbstractSqlStemList::AbstractSqlStemList(const MorphologicalModel *model) :
 
 AbstractSqlStemList::~AbstractSqlStemList()
 {
+    /// the queries have to be deleted before their connection is removed
+    clearPreparedQueries();
+
     /// 2024-12-31: I'm not actually sure this is necessary.
     foreach(QString connectionName, QSqlDatabase::connectionNames())
     {
@@ -53,6 +102,8 @@ void AbstractSqlStemList::setConnectionString(const QString &connectionString)
     // mDbName = QString("%1_0x%2").arg(DEFAULT_DBNAME).arg( reinterpret_cast<quintptr>(this),
     //                     QT_POINTER_SIZE * 2, 16, QChar('0'));
 
+    clearPreparedQueries();
+    mConnectionThread = QThread::currentThread();
     openDatabase(connectionString, mDbName);
     if( mCreateTables )
         createTables();
@@ -70,21 +121,51 @@ QString AbstractSqlStemList::dbName() const
 
 void AbstractSqlStemList::readStems(const QHash<QString, WritingSystem> & writingSystems)
 {
+    /// a connection can only be used in the thread that opened it, so in any other thread (see canReadStemsInParallel()) the stems are read with connections of their own
+    if( QThread::currentThread() != mConnectionThread )
+    {
+        readStemsWithOwnConnections( writingSystems );
+        return;
+    }
+
     QSqlDatabase db = QSqlDatabase::database(mDbName);
 
     if( !db.isOpen() )
         return;
 
-    /// this is the default. It's about 50% slower.
-    if( mReadGlosses )
+    if( mLoadOnDemand )
     {
-        readStemsMultipleQueries(writingSystems);
+        /// the derived allomorphs have forms that aren't in the database, and an in-memory database can't be shared with the other connections
+        if( !mCreateAllomorphs.isEmpty() || db.databaseName() == ":memory:" )
+        {
+            qWarning() << "AbstractSqlStemList::readStems()" << "Stems cannot be loaded on demand for" << debugIdentifier() << "(because it has CreateAllomorphs or an in-memory database). All of the stems will be read now.";
+            mLoadOnDemand = false;
+        }
+        else
+        {
+            QSqlQuery q(db);
+            if( !q.exec(qCreateFormsTextIdx()) )
+            {
+                qWarning() << "AbstractSqlStemList::readStems()" << "Could not index the forms, so lookups will be slow." << q.lastError().text() << q.executedQuery();
+            }
+            return;
+        }
     }
-    else /// this reads the stems about 50% faster. As a side effect it doesn't read the stem glosses.
+
+    QElapsedTimer timer;
+    timer.start();
+
+    /// the three queries are read at the same time, so each needs its own connection
+    openAlternateConnections();
+
+    const QList<LexicalStem*> stems = readStemsStreaming( writingSystems, tagsInSqlList(), QString(), db, QSqlDatabase::database(stemConnectionName()), QSqlDatabase::database(allomorphConnectionName()) );
+    foreach( LexicalStem * stem, stems )
     {
-        readStemsSingleQuery(writingSystems);
+        mStems.insert( stem );
     }
 
+    qInfo().noquote() << QString("Stems read in %1 ms").arg(timer.elapsed());
+
     /*
      * It's not nice to have this show up with every run. TODO think about a verbose warning mode.
     if( mStems.isEmpty() )
@@ -93,8 +174,55 @@ void AbstractSqlStemList::readStems(const QHash<QString, WritingSystem> & writin
     */
 }
 
+bool AbstractSqlStemList::canReadStemsInParallel() const
+{
+    /// a clone of an in-memory database is a different, empty, database
+    return !mLoadOnDemand && QSqlDatabase::database(mDbName, false).databaseName() != ":memory:";
+}
+
+void AbstractSqlStemList::readStemsWithOwnConnections(const QHash<QString, WritingSystem> &writingSystems)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const QString prefix = QString("%1:%2:%3").arg( mDbName, READER_CONNECTION ).arg( static_cast<qulonglong>( reinterpret_cast<quintptr>( this ) ), 0, 16 );
+    const QStringList names = QStringList() << prefix + ":forms" << prefix + ":tags" << prefix + ":glosses";
+    foreach( QString name, names )
+    {
+        cloneDatabase( mDbName, name );
+    }
+
+    /// the connections can only be removed once nothing refers to them
+    {
+        const QSqlDatabase formDb = QSqlDatabase::database( names.at(0) );
+        const QSqlDatabase tagDb = QSqlDatabase::database( names.at(1) );
+        const QSqlDatabase glossDb = QSqlDatabase::database( names.at(2) );
+        if( formDb.isOpen() && tagDb.isOpen() && glossDb.isOpen() )
+        {
+            const QList<LexicalStem*> stems = readStemsStreaming( writingSystems, tagsInSqlList(), QString(), formDb, tagDb, glossDb );
+            foreach( LexicalStem * stem, stems )
+            {
+                mStems.insert( stem );
+            }
+        }
+        else
+        {
+            qWarning() << "AbstractSqlStemList::readStemsWithOwnConnections()" << "Could not open connections to read the stems of" << debugIdentifier();
+        }
+    }
+
+    foreach( QString name, names )
+    {
+        QSqlDatabase::removeDatabase( name );
+    }
+
+    qInfo().noquote() << QString("Stems read in %1 ms").arg(timer.elapsed());
+}
+
 void AbstractSqlStemList::setExternalDatabase(const QString &dbName)
 {
+    clearPreparedQueries();
+    mConnectionThread = QThread::currentThread();
     mDbName = dbName;
 
     QSqlDatabase db = QSqlDatabase::database(mDbName);
@@ -107,127 +235,447 @@ void AbstractSqlStemList::setExternalDatabase(const QString &dbName)
         createTables();
 }
 
-void AbstractSqlStemList::readStemsMultipleQueries(const QHash<QString, WritingSystem> &writingSystems)
+QList<LexicalStem *> AbstractSqlStemList::readStemsStreaming(const QHash<QString, WritingSystem> &writingSystems, const QString &taglist, const QString &stemIds, const QSqlDatabase &formDb, const QSqlDatabase &tagDb, const QSqlDatabase &glossDb) const
 {
-    QElapsedTimer timer;
-    timer.start();
+    QList<LexicalStem*> stems;
 
-    QSqlDatabase db = QSqlDatabase::database(mDbName);
+    /// one row per form: stem, allomorph, form
+    QSqlQuery formQuery( formDb );
+    formQuery.setForwardOnly(true);
+    if( !formQuery.exec( qSelectAllomorphFormsStreaming(taglist, stemIds) ) )
+    {
+        qWarning() << "AbstractSqlStemList::readStemsStreaming()" << formQuery.lastError().text() << formQuery.executedQuery();
+        return stems;
+    }
 
-    openAlternateConnections();
+    /// one row per tag: stem, allomorph, label
+    QSqlQuery tagQuery( tagDb );
+    tagQuery.setForwardOnly(true);
+    if( !tagQuery.exec( qSelectTagsStreaming(taglist, stemIds) ) )
+    {
+        qWarning() << "AbstractSqlStemList::readStemsStreaming()" << tagQuery.lastError().text() << tagQuery.executedQuery();
+        return stems;
+    }
+    bool tagsLeft = tagQuery.next();
 
-    /// this is where the tag filtering takes place
-    QSqlQuery query(db);
-    query.setForwardOnly(true);
-    if( mTags.isEmpty() )
+    /// one row per gloss: stem, form, writing system
+    QSqlQuery glossQuery( glossDb );
+    glossQuery.setForwardOnly(true);
+    bool glossesLeft = false;
+    if( mReadGlosses )
     {
-        query.prepare(qSelectStemIds());
+        if( !glossQuery.exec( qSelectGlossesStreaming(taglist, stemIds) ) )
+        {
+            qWarning() << "AbstractSqlStemList::readStemsStreaming()" << glossQuery.lastError().text() << glossQuery.executedQuery();
+            return stems;
+        }
+        glossesLeft = glossQuery.next();
     }
-    else
+
+    LexicalStem * stem = nullptr;
+    Allomorph allomorph(Allomorph::Null);
+
+    /// add the tags of the current allomorph, skipping any rows for allomorphs that weren't read
+    auto finishAllomorph = [&]()
     {
-        const QString inStatement = tagsInSqlList();
-        query.prepare( qSelectStemIdsWithTags(inStatement) );
-    }    
+        if( allomorph.type() == Allomorph::Null )
+            return;
 
-    if(query.exec())
+        while( tagsLeft )
+        {
+            const qlonglong tagStemId = tagQuery.value(0).toLongLong();
+            const qlonglong tagAllomorphId = tagQuery.value(1).toLongLong();
+            if( tagStemId > stem->id() || ( tagStemId == stem->id() && tagAllomorphId > allomorph.id() ) )
+                break;
+            if( tagStemId == stem->id() && tagAllomorphId == allomorph.id() )
+                allomorph.addTag( tagQuery.value(2).toString() );
+            tagsLeft = tagQuery.next();
+        }
+
+        stem->insert( allomorph );
+        allomorph = Allomorph(Allomorph::Null);
+    };
+
+    /// add the glosses of the current stem, and add the stem to the list
+    auto finishStem = [&]()
     {
-        while(query.next())
+        if( stem == nullptr )
+            return;
+
+        finishAllomorph();
+
+        while( glossesLeft )
+        {
+            const qlonglong glossStemId = glossQuery.value(0).toLongLong();
+            if( glossStemId > stem->id() )
+                break;
+            if( glossStemId == stem->id() )
+                stem->setGloss( Form( writingSystems.value( glossQuery.value(2).toString() ), glossQuery.value(1).toString() ) );
+            glossesLeft = glossQuery.next();
+        }
+
+        stems << stem;
+        stem = nullptr;
+    };
+
+    while( formQuery.next() )
+    {
+        const qlonglong stemId = formQuery.value(0).toLongLong();
+        if( stem == nullptr || stem->id() != stemId )
         {
-            const qlonglong stemId = query.value(0).toLongLong();
-            const QString liftGuid = query.value(1).toString();
-            mStems << lexicalStemFromId(stemId, liftGuid, writingSystems);
+            finishStem();
+            stem = new LexicalStem;
+            stem->setId(stemId);
+            const QString liftGuid = formQuery.value(1).toString();
+            if( !liftGuid.isEmpty() )
+                stem->setLiftGuid( liftGuid );
         }
+
+        /// a stem without allomorphs has a single row with null allomorph columns
+        if( formQuery.value(2).isNull() )
+            continue;
+
+        const qlonglong allomorphId = formQuery.value(2).toLongLong();
+        if( allomorph.type() == Allomorph::Null || allomorph.id() != allomorphId )
+        {
+            finishAllomorph();
+            allomorph = Allomorph(Allomorph::Original);
+            allomorph.setId(allomorphId);
+            allomorph.setUseInGenerations( formQuery.value(3).toLongLong() > 0 );
+            const QString portmanteau = formQuery.value(4).toString();
+            if( portmanteau.length() > 0 )
+                allomorph.setPortmanteau( Portmanteau(portmanteau) );
+        }
+
+        /// likewise an allomorph without forms
+        if( !formQuery.value(5).isNull() )
+            allomorph.setForm( Form( writingSystems.value( formQuery.value(6).toString() ), formQuery.value(5).toString() ) );
     }
-    else
+    finishStem();
+
+    return stems;
+}
+
+void AbstractSqlStemList::setLoadOnDemand(bool loadOnDemand, int cacheSize)
+{
+    if( loadOnDemand && !supportsLoadOnDemand() )
     {
-        qWarning() << "AbstractSqlStemList::readStemsMultipleQueries()" << query.lastError().text() << query.executedQuery();
+        qWarning() << "AbstractSqlStemList::setLoadOnDemand()" << "Stems cannot be loaded on demand from this kind of database, so all of the stems will be read for" << debugIdentifier();
+        loadOnDemand = false;
     }
+    mLoadOnDemand = loadOnDemand;
+    mStemIdsByForm.setMaxCost( cacheSize );
+    mStemCache.setMaxCost( cacheSize );
+    mStemsLoadedById.setMaxCost( cacheSize );
+}
 
-    qInfo().noquote() << QString("Stems read in %1 ms").arg(timer.elapsed());
+bool AbstractSqlStemList::loadsStemsOnDemand() const
+{
+    return mLoadOnDemand;
 }
 
-void AbstractSqlStemList::readStemsSingleQuery(const QHash<QString, WritingSystem> &writingSystems)
+bool AbstractSqlStemList::supportsLoadOnDemand() const
 {
-    QSqlDatabase db = QSqlDatabase::database(mDbName);
+    return false;
+}
 
-    /// this is where the tag filtering takes place
-    QSqlQuery query(db);
-    query.setForwardOnly(true);
-    if( mTags.isEmpty() )
+LexicalStem *AbstractSqlStemList::getStem(qlonglong id) const
+{
+    LexicalStem * stem = AbstractStemList::getStem(id);
+    if( stem != nullptr || !mLoadOnDemand )
     {
-        query.prepare(qSelectStemsSingleQuery());
+        return stem;
     }
-    else
+
     {
-        const QString inStatement = tagIdsInSqlList();
-        query.prepare(qSelectStemsSingleQueryWithTags(inStatement));
+        QMutexLocker locker(&mOnDemandMutex);
+        stem = mStemsLoadedById.object(id);
+        if( stem != nullptr )
+        {
+            return stem;
+        }
     }
 
-    if(query.exec())
+    /// the database is queried without the lock, as in stemsOnDemand(); the tags are checked so that only the stems of this list are found
+    const QSqlDatabase db = onDemandConnection();
+    QList<LexicalStem*> stems = readStemsStreaming( mMorphology->writingSystems(), tagsInSqlList(), QString::number(id), db, db, db );
+    if( stems.isEmpty() )
     {
-        qlonglong previousStemId = -1;
-        qlonglong previousAllomorphId = -1;
-        Allomorph allomorph(Allomorph::Original);
-        LexicalStem * stem = nullptr;
+        return nullptr;
+    }
+    LexicalStem * loaded = stems.takeFirst();
+    qDeleteAll( stems );
+    loaded->initializePortmanteaux(this);
+
+    QMutexLocker locker(&mOnDemandMutex);
+    /// another thread may have loaded the same stem in the meantime, and it may already have been returned
+    stem = mStemsLoadedById.object(id);
+    if( stem != nullptr )
+    {
+        delete loaded;
+        return stem;
+    }
+    mStemsLoadedById.insert(id, loaded);
+    return loaded;
+}
+
+QList<QPair<Allomorph, LexicalStem> > AbstractSqlStemList::matchingAllomorphs(const Parsing &parsing) const
+{
+    if( !mLoadOnDemand )
+    {
+        return AbstractStemList::matchingAllomorphs(parsing);
+    }
+
+    QList<QPair<Allomorph, LexicalStem> > list;
+
+    /// as with the form index, only stems with an allomorph that is a prefix of the remainder can match,
+    /// so look up each prefix of the remainder, up to the longest form in the database
+    const WritingSystem ws = parsing.writingSystem();
+    const QString text = parsing.form().text();
+    const int maxLength = qMin( longestFormOnDemand(ws), static_cast<int>( text.length() ) - parsing.position() );
+    QStringList prefixes;
+    for(int length = 1; length <= maxLength; length++)
+    {
+        prefixes << text.mid( parsing.position(), length );
+    }
+    if( prefixes.isEmpty() )
+    {
+        return list;
+    }
 
-        while(query.next())
+    const QHash<QString, QList<qlonglong> > stemIds = stemIdsOnDemand(ws, prefixes);
+    QSet<qlonglong> allIds;
+    foreach( const QList<qlonglong> & ids, stemIds )
+    {
+        foreach( qlonglong id, ids )
         {
-            /// every row has a new form
-            const WritingSystem ws = writingSystems.value( query.value(5).toString() );
-            const Form f( ws, query.value(4).toString() );
+            allIds << id;
+        }
+    }
+    const QHash<qlonglong, QSharedPointer<const LexicalStem> > stems = stemsOnDemand(allIds);
+    HotPathCounters * counters = statisticsCounters();
 
-            const qlonglong allomorphId = query.value(2).toLongLong();
-            if( allomorphId != previousAllomorphId )
+    /// stems that have been added since the model was read are also in the database, so they are found here too
+    foreach( const QString & prefix, prefixes )
+    {
+        foreach( qlonglong id, stemIds.value(prefix) )
+        {
+            const QSharedPointer<const LexicalStem> s = stems.value(id);
+            if( s.isNull() )
             {
-                /// first, save the previous allomorph, if it has forms
-                if( ! allomorph.isEmpty() )
-                {
-                    stem->insert( allomorph );
-                }
-                /// then reset the allomorph object, and add this form
-                allomorph = Allomorph(Allomorph::Original);
-                allomorph.setId(allomorphId);
-                allomorph.setTags( Tag::fromString( query.value(6).toString() ) );
-                if( query.value(7).toString().length() > 0 )
-                    allomorph.setPortmanteau(Portmanteau( query.value(7).toString() ));
+                continue;
             }
-            allomorph.setForm( f );
-
-            const qlonglong stemId = query.value(0).toLongLong();
-            if( stemId != previousStemId )
+            for(int i=0; i < s->allomorphCount(); i++)
             {
-                /// first save the previous LexicalStem
-                if( stem != nullptr )
+                const Allomorph & a = s->allomorph(i);
+                if( a.form(ws).text() == prefix && parsing.allomorphMatches( a, mMorphology->stemDebugOutput(), counters ) )
                 {
-                    mStems << stem;
+                    list << QPair<Allomorph, LexicalStem>( a, *s );
                 }
-                /// create a new LexicalStem
-                stem = new LexicalStem;
-                stem->setId(stemId);
             }
+        }
+    }
+
+    return list;
+}
 
-            previousStemId = stemId;
-            previousAllomorphId = allomorphId;
+int AbstractSqlStemList::longestFormOnDemand(const WritingSystem &ws) const
+{
+    {
+        QMutexLocker locker(&mOnDemandMutex);
+        if( mLongestFormOnDemand.contains(ws) )
+        {
+            return mLongestFormOnDemand.value(ws);
         }
+    }
 
-        /// now at the end, add the allomorph to the stem, and the stem to the list
-        if( stem != nullptr && !allomorph.isEmpty() )
+    QSqlQuery query( onDemandConnection() );
+    query.setForwardOnly(true);
+    query.prepare( qSelectLongestForm() );
+    query.bindValue( 0, ws.abbreviation() );
+    if( !query.exec() )
+    {
+        qWarning() << "AbstractSqlStemList::longestFormOnDemand()" << query.lastError().text() << query.executedQuery();
+        return 0;
+    }
+    const int longest = query.next() ? query.value(0).toInt() : 0;
+
+    QMutexLocker locker(&mOnDemandMutex);
+    mLongestFormOnDemand.insert(ws, longest);
+    return longest;
+}
+
+QHash<QString, QList<qlonglong> > AbstractSqlStemList::stemIdsOnDemand(const WritingSystem &ws, const QStringList &forms) const
+{
+    QHash<QString, QList<qlonglong> > ids;
+    QStringList missing;
+    {
+        QMutexLocker locker(&mOnDemandMutex);
+        foreach( const QString & form, forms )
         {
-            stem->insert( allomorph );
-            mStems << stem;
+            const QList<qlonglong> * cached = mStemIdsByForm.object( onDemandKey(ws, form) );
+            if( cached == nullptr )
+            {
+                missing << form;
+            }
+            else
+            {
+                ids.insert( form, *cached );
+            }
         }
     }
-    else
+
+    if( missing.isEmpty() )
+    {
+        return ids;
+    }
+
+    /// the forms that weren't cached are looked up with a single query
+    QSqlQuery query( onDemandConnection() );
+    query.setForwardOnly(true);
+    query.prepare( qSelectStemIdsFromForms( tagsInSqlList(), missing.count() ) );
+    query.bindValue( 0, ws.abbreviation() );
+    for(int i=0; i < missing.count(); i++)
+    {
+        query.bindValue( i + 1, missing.at(i) );
+    }
+    if( !query.exec() )
     {
-        qWarning() << "AbstractSqlStemList::readStemsSingleQuery()" << query.lastError().text() << query.executedQuery();
+        qWarning() << "AbstractSqlStemList::stemIdsOnDemand()" << query.lastError().text() << query.executedQuery();
+        return ids;
     }
+
+    QHash<QString, QList<qlonglong> > found;
+    while( query.next() )
+    {
+        found[ query.value(1).toString() ] << query.value(0).toLongLong();
+    }
+
+    QMutexLocker locker(&mOnDemandMutex);
+    foreach( const QString & form, missing )
+    {
+        /// forms without stems are cached as well, since most prefixes of a word are not stems
+        const QList<qlonglong> formIds = found.value(form);
+        ids.insert( form, formIds );
+        mStemIdsByForm.insert( onDemandKey(ws, form), new QList<qlonglong>(formIds) );
+    }
+    return ids;
+}
+
+QHash<qlonglong, QSharedPointer<const LexicalStem> > AbstractSqlStemList::stemsOnDemand(const QSet<qlonglong> &ids) const
+{
+    QHash<qlonglong, QSharedPointer<const LexicalStem> > stems;
+    QStringList missing;
+    {
+        QMutexLocker locker(&mOnDemandMutex);
+        foreach( qlonglong id, ids )
+        {
+            const QSharedPointer<const LexicalStem> * cached = mStemCache.object(id);
+            if( cached == nullptr )
+            {
+                missing << QString::number(id);
+            }
+            else
+            {
+                stems.insert( id, *cached );
+            }
+        }
+    }
+
+    if( missing.isEmpty() )
+    {
+        return stems;
+    }
+
+    /// the stem ids come from a query that has already checked the tags; and SQLite allows several active queries on one connection
+    const QSqlDatabase db = onDemandConnection();
+    const QList<LexicalStem*> loaded = readStemsStreaming( mMorphology->writingSystems(), QString(), missing.join(","), db, db, db );
+    foreach( LexicalStem * stem, loaded )
+    {
+        stem->initializePortmanteaux(this);
+    }
+
+    /// the shared pointers keep a stem alive for the caller, even if the cache drops it
+    QMutexLocker locker(&mOnDemandMutex);
+    foreach( LexicalStem * stem, loaded )
+    {
+        const QSharedPointer<const LexicalStem> shared(stem);
+        stems.insert( stem->id(), shared );
+        mStemCache.insert( stem->id(), new QSharedPointer<const LexicalStem>(shared) );
+    }
+    return stems;
+}
+
+void AbstractSqlStemList::clearOnDemandCache()
+{
+    if( !mLoadOnDemand )
+    {
+        return;
+    }
+
+    QMutexLocker locker(&mOnDemandMutex);
+    mStemIdsByForm.clear();
+    mStemCache.clear();
+    mStemsLoadedById.clear();
+    mLongestFormOnDemand.clear();
+}
+
+QSqlDatabase AbstractSqlStemList::onDemandConnection() const
+{
+    /// a connection can only be used in the thread that opened it, so each thread that parses gets its own
+    if( !mOnDemandConnections.hasLocalData() )
+    {
+        const QString name = QString("%1:%2:%3").arg( mDbName, ON_DEMAND_CONNECTION ).arg( onDemandConnectionCount.fetchAndAddRelaxed(1) );
+        cloneDatabase(mDbName, name);
+        mOnDemandConnections.setLocalData( new OnDemandConnection(name) );
+    }
+    return QSqlDatabase::database( mOnDemandConnections.localData()->name() );
 }
 
 void AbstractSqlStemList::insertStemIntoDataModel(LexicalStem *stem)
 {
-    stem->generateAllomorphs(mCreateAllomorphs);
-    mStems.insert(stem);
-    addStemToDatabase(stem);
+    insertStemsIntoDataModel( QList<LexicalStem*>() << stem );
+}
+
+bool AbstractSqlStemList::insertStemsIntoDataModel(const QList<LexicalStem *> &stems)
+{
+    foreach( LexicalStem * stem, stems )
+    {
+        generateDerivedAllomorphs(stem);
+    }
+
+    /// a single transaction for all of the stems is much faster than one per stem
+    QSqlDatabase db = QSqlDatabase::database(mDbName);
+    db.transaction();
+    foreach( LexicalStem * stem, stems )
+    {
+        if( !addStemToDatabase(stem) )
+        {
+            qWarning() << "AbstractSqlStemList::insertStemsIntoDataModel()" << "Rolling back the insertion of" << stems.count() << "stem(s) into" << debugIdentifier();
+            db.rollback();
+            clearOnDemandCache();
+            return false;
+        }
+    }
+    if( !db.commit() )
+    {
+        qWarning() << "AbstractSqlStemList::insertStemsIntoDataModel()" << "Could not commit the insertion of" << stems.count() << "stem(s) into" << debugIdentifier() << db.lastError().text();
+        db.rollback();
+        clearOnDemandCache();
+        return false;
+    }
+
+    /// the stems only join the list once they are in the database; stems that are loaded on demand are read from there instead
+    if( !mLoadOnDemand )
+    {
+        foreach( LexicalStem * stem, stems )
+        {
+            mStems.insert(stem);
+        }
+    }
+
+    clearOnDemandCache();
+    return true;
 }
 
 void AbstractSqlStemList::removeStemFromDataModel(qlonglong id)
@@ -290,102 +738,8 @@ void AbstractSqlStemList::removeStemFromDataModel(qlonglong id)
     }
 
     db.commit();
-}
-
-LexicalStem *AbstractSqlStemList::lexicalStemFromId(qlonglong stemId, const QString & liftGuid, const QHash<QString, WritingSystem> &writingSystems)
-{
-    LexicalStem * ls = new LexicalStem;
-    ls->setId(stemId);
-    if( !liftGuid.isEmpty() )
-        ls->setLiftGuid( liftGuid );
-
-    QSqlDatabase db = QSqlDatabase::database(stemConnectionName());
-    QSqlQuery query(db);
-    query.setForwardOnly(true);
-
-    query.prepare(qSelectAllomorphsFromStemId());
-    query.bindValue( 0, stemId );
-    if(query.exec())
-    {
-        while(query.next())
-        {
-            qlonglong allomorph_id = query.value(0).toLongLong();
-            bool useInGenerations =  query.value(1).toLongLong() > 0;
-            QString portmanteau = query.value(2).toString();
-            ls->insert( allomorphFromId( allomorph_id, writingSystems, useInGenerations, portmanteau ) );
-        }
-    }
-    else
-    {
-        qWarning() << "AbstractSqlStemList::lexicalStemFromId()" << query.lastError().text() << query.executedQuery();
-    }
-    query.finish();
-
-    query.prepare(qSelectGlossesFromStemId());
-    query.bindValue( 0, stemId );
-    if(query.exec())
-    {
-        while(query.next())
-        {
-            QString form = query.value(0).toString();
-            QString ws = query.value(1).toString();
-
-            ls->setGloss( Form( writingSystems.value( ws ), form ) );
-        }
-    }
-    else
-    {
-        qWarning() << "AbstractSqlStemList::readStems()" << query.lastError().text() << query.executedQuery();
-    }
-    query.finish();
-
-    return ls;
-}
-
-Allomorph AbstractSqlStemList::allomorphFromId(qlonglong allomorphId, const QHash<QString, WritingSystem> &writingSystems, bool useInGenerations, const QString &portmanteau)
-{
-    QSqlDatabase db = QSqlDatabase::database(allomorphConnectionName());
-    QSqlQuery query(db);
-    query.setForwardOnly(true);
-
-    Allomorph a(Allomorph::Original);
-    a.setId(allomorphId);
-    a.setUseInGenerations(useInGenerations);
-    if( portmanteau.length() > 0 )
-        a.setPortmanteau( Portmanteau(portmanteau) );
-
-    query.prepare(qSelectFormsFromAllomorphId());
-    query.bindValue(0, allomorphId);
-    if(query.exec())
-    {
-        while(query.next())
-        {
-            WritingSystem ws = writingSystems.value( query.value(1).toString() );
-            a.setForm( Form( ws, query.value(0).toString() ) );
-        }
-    }
-    else
-    {
-        qWarning() << "AbstractSqlStemList::allomorphFromId()" << query.lastError().text() << query.executedQuery();
-    }
-    query.finish();
 
-    query.prepare(qSelectTagLabelsFromAllomorphId());
-    query.bindValue(0, allomorphId);
-    if(query.exec())
-    {
-        while(query.next())
-        {
-            QString label = query.value(0).toString();
-            a.addTag( label );
-        }
-    }
-    else
-    {
-        qWarning() << "AbstractSqlStemList::allomorphFromId()" << query.lastError().text() << query.executedQuery();
-    }
-
-    return a;
+    clearOnDemandCache();
 }
 
 void AbstractSqlStemList::createTables()
@@ -464,26 +818,17 @@ void AbstractSqlStemList::createTables()
     }
 }
 
-void AbstractSqlStemList::addStemToDatabase(LexicalStem *stem)
+bool AbstractSqlStemList::addStemToDatabase(LexicalStem *stem)
 {
-    QSqlDatabase db = QSqlDatabase::database(mDbName);
-
-    db.transaction();
-
     qlonglong stem_id = insertOrReplaceStemRow(stem);
+    if( stem_id == -1 )
+    {
+        return false;
+    }
 
-    QSqlQuery allomorphQuery(db);
-    allomorphQuery.setForwardOnly(true);
-    allomorphQuery.prepare(qInsertAllomorph());
-    allomorphQuery.bindValue(0, stem_id ); /// this will be the same for all subsequent calls
-
-    QSqlQuery formQuery(db);
-    formQuery.setForwardOnly(true);
-    formQuery.prepare(qInsertForm());
-
-    QSqlQuery tagQuery(db);
-    tagQuery.setForwardOnly(true);
-    tagQuery.prepare(qInsertTagMember());
+    QSqlQuery & allomorphQuery = preparedQuery(qInsertAllomorph());
+    QSqlQuery & formQuery = preparedQuery(qInsertForm());
+    QSqlQuery & tagQuery = preparedQuery(qInsertTagMember());
 
     QListIterator<Allomorph> ai = stem->allomorphIterator();
     while(ai.hasNext())
@@ -493,9 +838,14 @@ void AbstractSqlStemList::addStemToDatabase(LexicalStem *stem)
         /// only add Original allomorphs to the SQL database, not Derived
         if( a.type() == Allomorph::Original )
         {
-            allomorphQuery.bindValue(1, a.useInGenerations() ); /// this will be the same for all subsequent calls
-            allomorphQuery.bindValue(2, a.portmanteau().morphemes().toString() ); /// this will be the same for all subsequent calls
-            allomorphQuery.exec(); /// using previously bound values
+            allomorphQuery.bindValue(0, stem_id );
+            allomorphQuery.bindValue(1, a.useInGenerations() );
+            allomorphQuery.bindValue(2, a.portmanteau().morphemes().toString() );
+            if(!allomorphQuery.exec())
+            {
+                qWarning() << "AbstractSqlStemList::addStemToDatabase()" << allomorphQuery.lastError().text() << allomorphQuery.executedQuery();
+                return false;
+            }
             qlonglong allomorph_id = allomorphQuery.lastInsertId().toLongLong();
 
             /// add each form to the Forms table
@@ -505,7 +855,6 @@ void AbstractSqlStemList::addStemToDatabase(LexicalStem *stem)
             {
                 fi.next();
 
-                /// stem_id bound above
                 formQuery.bindValue(0, allomorph_id);
                 formQuery.bindValue(1, fi.value().text() );
                 formQuery.bindValue(2, fi.key().abbreviation() );
@@ -513,8 +862,7 @@ void AbstractSqlStemList::addStemToDatabase(LexicalStem *stem)
                 if(!formQuery.exec())
                 {
                     qWarning() << "AbstractSqlStemList::addStemToDatabase()" << formQuery.lastError().text() << formQuery.executedQuery();
-                    db.rollback();
-                    return;
+                    return false;
                 }
             }
 
@@ -528,49 +876,40 @@ void AbstractSqlStemList::addStemToDatabase(LexicalStem *stem)
                 if(!tagQuery.exec())
                 {
                     qWarning() << "AbstractSqlStemList::addStemToDatabase()" << tagQuery.lastError().text() << tagQuery.executedQuery();
-                    db.rollback();
-                    return;
+                    return false;
                 }
             }
         }
     }
 
-    QSqlQuery glossQuery(db);
-    glossQuery.setForwardOnly(true);
-    glossQuery.prepare(qInsertGloss());
-    glossQuery.bindValue(0, stem_id ); /// this will be the same for all subsequent calls
+    QSqlQuery & glossQuery = preparedQuery(qInsertGloss());
     QHashIterator<WritingSystem, Form> gi( stem->glosses() );
     while( gi.hasNext() )
     {
         gi.next();
+        glossQuery.bindValue(0, stem_id );
         glossQuery.bindValue(1, gi.value().text() );
         glossQuery.bindValue(2, gi.key().abbreviation() );
         if(!glossQuery.exec())
         {
             qWarning() << "AbstractSqlStemList::addStemToDatabase()" << glossQuery.lastError().text() << glossQuery.executedQuery();
-            db.rollback();
-            return;
+            return false;
         }
     }
 
-    db.commit();
+    return true;
 }
 
 qlonglong AbstractSqlStemList::insertOrReplaceStemRow(LexicalStem *stem)
 {
-    QSqlDatabase db = QSqlDatabase::database(mDbName);
-
-    QSqlQuery stemQuery(db);
-    stemQuery.setForwardOnly(true);
+    QSqlQuery & stemQuery = preparedQuery( stem->id() == -1 ? qInsertStem() : qReplaceStem() );
 
     if( stem->id() == -1 )
     {
-        stemQuery.prepare(qInsertStem());
         stemQuery.bindValue(0, stem->liftGuid() );
     }
     else
     {
-        stemQuery.prepare(qReplaceStem());
         stemQuery.bindValue(0, stem->id() );
         stemQuery.bindValue(1, stem->liftGuid() );
     }
@@ -590,48 +929,70 @@ qlonglong AbstractSqlStemList::insertOrReplaceStemRow(LexicalStem *stem)
     }
     else
     {
-        qWarning() << "AbstractSqlStemList::addStemToDatabase()" << stemQuery.lastError().text() << stemQuery.executedQuery();
-        db.rollback();
+        qWarning() << "AbstractSqlStemList::insertOrReplaceStemRow()" << stemQuery.lastError().text() << stemQuery.executedQuery();
         return -1;
     }
 }
 
 qlonglong AbstractSqlStemList::ensureTagInDatabase(const QString &tag)
 {
-    QSqlDatabase db = QSqlDatabase::database(mDbName);
-
-    QSqlQuery query(db);
-    query.setForwardOnly(true);
-    query.prepare(qSelectTagIdFromLabel());
+    QSqlQuery & query = preparedQuery(qSelectTagIdFromLabel());
     query.bindValue(0, tag);
     if(query.exec())
     {
         if( query.first() )
         {
-            return query.value(0).toLongLong();
+            const qlonglong tagId = query.value(0).toLongLong();
+            query.finish();
+            return tagId;
         }
         else
         {
-            query.prepare(qInsertTag());
-            query.bindValue(0, tag);
-            if( query.exec() )
+            query.finish();
+            QSqlQuery & insertQuery = preparedQuery(qInsertTag());
+            insertQuery.bindValue(0, tag);
+            if( insertQuery.exec() )
             {
-                return query.lastInsertId().toLongLong();
+                return insertQuery.lastInsertId().toLongLong();
             }
             else
             {
-                qWarning() << "AbstractSqlStemList::readStems()" << query.lastError().text() << query.executedQuery();
+                qWarning() << "AbstractSqlStemList::ensureTagInDatabase()" << insertQuery.lastError().text() << insertQuery.executedQuery();
                 return 0;
             }
         }
     }
     else
     {
-        qWarning() << "AbstractSqlStemList::readStems()" << query.lastError().text() << query.executedQuery();
+        qWarning() << "AbstractSqlStemList::ensureTagInDatabase()" << query.lastError().text() << query.executedQuery();
         return 0;
     }
 }
 
+QSqlQuery &AbstractSqlStemList::preparedQuery(const QString &sql)
+{
+    QHash<QString, QSqlQuery*>::const_iterator i = mPreparedQueries.constFind(sql);
+    if( i != mPreparedQueries.constEnd() )
+    {
+        return *i.value();
+    }
+
+    QSqlQuery * query = new QSqlQuery( QSqlDatabase::database(mDbName) );
+    query->setForwardOnly(true);
+    if( !query->prepare(sql) )
+    {
+        qWarning() << "AbstractSqlStemList::preparedQuery()" << query->lastError().text() << sql;
+    }
+    mPreparedQueries.insert(sql, query);
+    return *query;
+}
+
+void AbstractSqlStemList::clearPreparedQueries()
+{
+    qDeleteAll(mPreparedQueries);
+    mPreparedQueries.clear();
+}
+
 void AbstractSqlStemList::openAlternateConnections() const
 {
     if( !QSqlDatabase::database(stemConnectionName()).isOpen() )
@@ -652,6 +1013,7 @@ QString AbstractSqlStemList::allomorphConnectionName() const
 
 void AbstractSqlStemList::setDbName(const QString &newDbName)
 {
+    clearPreparedQueries();
     mDbName = newDbName;
 }
 
@@ -690,26 +1052,74 @@ QString AbstractSqlStemList::tableTagMembers() const
     return mTablePrefix + TABLE_TAGMEMBERS;
 }
 
-QString AbstractSqlStemList::tagsInSqlList() const
+QString AbstractSqlStemList::qSelectAllomorphFormsStreaming(const QString &taglist, const QString &stemIds) const
 {
-    if( mTags.count() == 0 )
+    const QString conditions = qStemConditions("S._id", taglist, stemIds);
+    return "SELECT S._id, S.liftGuid, A._id, A.use_in_generations, A.portmanteau, F.Form, F.WritingSystem "
+           "FROM " + tableStems() + " AS S "
+           "LEFT JOIN " + tableAllomorphs() + " AS A ON A.stem_id=S._id "
+           "LEFT JOIN " + tableForms() + " AS F ON F.allomorph_id=A._id"
+           + ( conditions.isEmpty() ? QString() : " WHERE " + conditions ) +
+           " ORDER BY S._id, A._id, F._id;";
+}
+
+QString AbstractSqlStemList::qSelectTagsStreaming(const QString &taglist, const QString &stemIds) const
+{
+    const QString conditions = qStemConditions("A.stem_id", taglist, stemIds);
+    return "SELECT A.stem_id, TM.allomorph_id, T.Label "
+           "FROM " + tableTagMembers() + " AS TM "
+           "INNER JOIN " + tableAllomorphs() + " AS A ON A._id=TM.allomorph_id "
+           "INNER JOIN " + tableTags() + " AS T ON T._id=TM.tag_id"
+           + ( conditions.isEmpty() ? QString() : " WHERE " + conditions ) +
+           " ORDER BY A.stem_id, TM.allomorph_id;";
+}
+
+QString AbstractSqlStemList::qSelectGlossesStreaming(const QString &taglist, const QString &stemIds) const
+{
+    const QString conditions = qStemConditions("G.stem_id", taglist, stemIds);
+    return "SELECT G.stem_id, G.Form, G.WritingSystem "
+           "FROM " + tableGlosses() + " AS G"
+           + ( conditions.isEmpty() ? QString() : " WHERE " + conditions ) +
+           " ORDER BY G.stem_id, G._id;";
+}
+
+QString AbstractSqlStemList::qStemConditions(const QString &stemIdColumn, const QString &taglist, const QString &stemIds) const
+{
+    QStringList conditions;
+    if( !stemIds.isEmpty() )
     {
-        return QString();
+        conditions << stemIdColumn + " IN (" + stemIds + ")";
     }
-    else /// it has at least one
+    /// a stem is read if any of its allomorphs has one of the tags
+    if( !taglist.isEmpty() )
     {
-        QStringList asList;
-        QSetIterator<Tag> i( mTags );
-        while( i.hasNext() )
-        {
-            asList << i.next().label();
-        }
-        const QString ret("'" + asList.join("','") + "'");
-        return ret;
+        conditions << stemIdColumn + " IN ("
+                      "SELECT TA.stem_id FROM " + tableTagMembers() + " AS TTM "
+                      "INNER JOIN " + tableTags() + " AS TT ON TT._id=TTM.tag_id "
+                      "INNER JOIN " + tableAllomorphs() + " AS TA ON TA._id=TTM.allomorph_id "
+                      "WHERE TT.Label IN (" + taglist + "))";
     }
+    return conditions.join(" AND ");
+}
+
+QString AbstractSqlStemList::qSelectStemIdsFromForms(const QString &taglist, int formCount) const
+{
+    Q_UNUSED(taglist)
+    Q_UNUSED(formCount)
+    return QString();
 }
 
-QString AbstractSqlStemList::tagIdsInSqlList() const
+QString AbstractSqlStemList::qSelectLongestForm() const
+{
+    return QString();
+}
+
+QString AbstractSqlStemList::qCreateFormsTextIdx() const
+{
+    return QString();
+}
+
+QString AbstractSqlStemList::tagsInSqlList() const
 {
     if( mTags.count() == 0 )
     {
@@ -717,26 +1127,14 @@ QString AbstractSqlStemList::tagIdsInSqlList() const
     }
     else /// it has at least one
     {
-        QSqlDatabase db = QSqlDatabase::database(mDbName);
-        QSqlQuery query(db);
-        query.setForwardOnly(true);
-        query.prepare(qSelectTagIdFromLabel());
-
-        QStringList ids;
+        QStringList asList;
         QSetIterator<Tag> i( mTags );
         while( i.hasNext() )
         {
-            query.bindValue( 0, i.next().label() );
-            if( !query.exec() )
-            {
-                qWarning() << "AbstractSqlStemList::tagIdsInSqlList()" << query.lastError().text() << query.executedQuery();
-                break;
-            }
-            if( query.next() )
-            {
-                ids << query.value(0).toString();
-            }
+            asList << i.next().label();
         }
-        return ids.join(",");
+        const QString ret("'" + asList.join("','") + "'");
+        return ret;
     }
 }
+
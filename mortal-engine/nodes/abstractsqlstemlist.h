@@ -5,6 +5,15 @@
 
 #include "mortal-engine_global.h"
 
+#include <QCache>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThreadStorage>
+
+class QSqlDatabase;
+class QSqlQuery;
+class QThread;
+
 namespace ME {
 
 class MORTAL_ENGINE_EXPORT AbstractSqlStemList : public AbstractStemList
@@ -21,6 +30,7 @@ public:
     void setReadGlosses(bool newReadGlosses);
 
     void readStems(const QHash<QString, WritingSystem> &writingSystems) override;
+    bool canReadStemsInParallel() const override;
 
     void setExternalDatabase(const QString & dbName);
 
@@ -32,6 +42,18 @@ public:
 
     void setDbName(const QString &newDbName);
 
+    //! \brief If \a loadOnDemand is true, the stems are not read when the model is loaded. Instead, matchingAllomorphs() looks up the forms that begin the remainder of the parsing in the database, and keeps the stems that it finds in a cache of up to \a cacheSize stems (and as many lookups). This is not possible for stem lists with CreateAllomorphs, since the derived forms are not in the database; readStems() reads all of the stems in that case. It is also not possible if the database does not support it (see supportsLoadOnDemand()), in which case this warns and leaves the setting off.
+    void setLoadOnDemand(bool loadOnDemand, int cacheSize = DEFAULT_CACHE_SIZE);
+    bool loadsStemsOnDemand() const override;
+    //! \brief Returns true if the subclass provides the queries for loading stems on demand. The default is false.
+    virtual bool supportsLoadOnDemand() const;
+
+    //! \brief Returns the stem with \a id. If the stems are loaded on demand, the stem is read from the database and kept in a cache of the same size as the other caches (see setLoadOnDemand()); the pointer is then only valid until getStem() has been called for that many other stems, or until the stems of the list change.
+    LexicalStem *getStem( qlonglong id ) const override;
+    QList< QPair<Allomorph,LexicalStem> > matchingAllomorphs(const Parsing &parsing) const override;
+
+    const static int DEFAULT_CACHE_SIZE;
+
 protected:
     /// Table names
     QString tableStems() const;
@@ -42,23 +64,12 @@ protected:
     QString tableTagMembers() const;
 
     /// Queries
-    virtual QString qSelectStemIds() const = 0;
-    virtual QString qSelectStemIdsWithTags(const QString & taglist) const = 0;
-    virtual QString qSelectStemsSingleQuery() const = 0;
-    virtual QString qSelectStemsSingleQueryWithTags(const QString & taglist) const = 0;
-
     virtual QString qDeleteFromTagMembers() const = 0;
     virtual QString qDeleteFromForms() const = 0;
     virtual QString qDeleteFromGlosses() const = 0;
     virtual QString qDeleteFromAllomorphs() const = 0;
     virtual QString qDeleteFromStems() const = 0;
 
-    virtual QString qSelectAllomorphsFromStemId() const = 0;
-    virtual QString qSelectGlossesFromStemId() const = 0;
-
-    virtual QString qSelectFormsFromAllomorphId() const = 0;
-    virtual QString qSelectTagLabelsFromAllomorphId() const = 0;
-
     virtual QString qInsertStem() const = 0;
     virtual QString qReplaceStem() const = 0;
 
@@ -70,6 +81,17 @@ protected:
 
     virtual QString qSelectTagIdFromLabel() const = 0;
 
+    /// Queries for readStemsStreaming(). Each is ordered by stem id (and then by allomorph id), so that the results can be merged in one pass. \a taglist is empty, or the result of tagsInSqlList(); \a stemIds is empty, or a comma-separated list of the stems to read. The defaults are plain SQL that both SQLite and SQL Server accept.
+    virtual QString qSelectAllomorphFormsStreaming(const QString & taglist, const QString & stemIds = QString()) const;
+    virtual QString qSelectTagsStreaming(const QString & taglist, const QString & stemIds = QString()) const;
+    virtual QString qSelectGlossesStreaming(const QString & taglist, const QString & stemIds = QString()) const;
+    QString qStemConditions(const QString & stemIdColumn, const QString & taglist, const QString & stemIds) const;
+
+    /// Queries for loading stems on demand, which are only used if supportsLoadOnDemand() returns true. The first binds the writing system and then \a formCount forms, and returns the stem id and form of each match. The defaults are empty.
+    virtual QString qSelectStemIdsFromForms(const QString & taglist, int formCount) const;
+    virtual QString qSelectLongestForm() const;
+    virtual QString qCreateFormsTextIdx() const;
+
     /// create database tables
     virtual QString qCreateStems() const = 0;
     virtual QString qCreateAllomorphs() const = 0;
@@ -88,18 +110,36 @@ protected:
 
 
 private:
-    void readStemsMultipleQueries(const QHash<QString, WritingSystem> &writingSystems);
-    void readStemsSingleQuery(const QHash<QString, WritingSystem> &writingSystems);
+    //! \brief Reads the stems as readStems() does, but with new connections, so that it can be called from any thread
+    void readStemsWithOwnConnections(const QHash<QString, WritingSystem> &writingSystems);
+
+    //! \brief Reads the stems with the three streaming queries, using \a formDb, \a tagDb and \a glossDb respectively. The caller owns the returned stems.
+    QList<LexicalStem*> readStemsStreaming(const QHash<QString, WritingSystem> &writingSystems, const QString & taglist, const QString & stemIds, const QSqlDatabase & formDb, const QSqlDatabase & tagDb, const QSqlDatabase & glossDb) const;
+
+    /// on-demand loading
+    int longestFormOnDemand(const WritingSystem & ws) const;
+    QHash<QString, QList<qlonglong> > stemIdsOnDemand(const WritingSystem & ws, const QStringList & forms) const;
+    QHash<qlonglong, QSharedPointer<const LexicalStem> > stemsOnDemand(const QSet<qlonglong> & ids) const;
+    void clearOnDemandCache();
+    //! \brief Returns the connection that the current thread uses to load stems on demand, opening it if necessary. The connection is removed when the thread finishes.
+    QSqlDatabase onDemandConnection() const;
+    class OnDemandConnection;
+    mutable QThreadStorage<OnDemandConnection*> mOnDemandConnections;
 
     void insertStemIntoDataModel( LexicalStem * stem ) override;
+    bool insertStemsIntoDataModel( const QList<LexicalStem*> & stems ) override;
     void removeStemFromDataModel( qlonglong id ) override;
-    LexicalStem * lexicalStemFromId(qlonglong stemId, const QString &liftGuid, const QHash<QString, WritingSystem> &writingSystems);
-    Allomorph allomorphFromId(qlonglong allomorphId, const QHash<QString, WritingSystem> &writingSystems, bool useInGenerations, const QString & portmanteau);
 
-    void addStemToDatabase( LexicalStem * stem );
+    //! \brief Writes \a stem to the database, returning false if any query fails. The caller is responsible for the transaction.
+    bool addStemToDatabase( LexicalStem * stem );
     qlonglong insertOrReplaceStemRow( LexicalStem * stem );
     qlonglong ensureTagInDatabase( const QString & tag );
 
+    //! \brief Returns a query on the main connection that has been prepared with \a sql. The query is prepared the first time it is requested and kept until the connection changes.
+    QSqlQuery & preparedQuery( const QString & sql );
+    void clearPreparedQueries();
+    QHash<QString, QSqlQuery*> mPreparedQueries;
+
     void openAlternateConnections() const;
 
     /// prevent subclasses from accessing these, so that they have to use the table name functions
@@ -113,6 +153,21 @@ private:
 
     static QString STEM_CONNECTION;
     static QString ALLOMORPH_CONNECTION;
+    static QString ON_DEMAND_CONNECTION;
+    static QString READER_CONNECTION;
+
+    /// the thread that opened the main connection, which is the only one that can use it
+    QThread * mConnectionThread;
+
+    bool mLoadOnDemand;
+    /// the caches are shared by the threads that are parsing, so they are guarded by mOnDemandMutex
+    mutable QMutex mOnDemandMutex;
+    /// for each writing system and form, the ids of the stems with that form
+    mutable QCache<QString, QList<qlonglong> > mStemIdsByForm;
+    mutable QCache<qlonglong, QSharedPointer<const LexicalStem> > mStemCache;
+    mutable QHash<WritingSystem, int> mLongestFormOnDemand;
+    /// stems that have been returned by getStem(), which are kept apart from mStemCache since the caller gets a plain pointer
+    mutable QCache<qlonglong, LexicalStem> mStemsLoadedById;
 
     QString stemConnectionName() const;
     QString allomorphConnectionName() const;
@@ -124,7 +179,6 @@ protected:
 
     void createTables();
     QString tagsInSqlList() const;
-    QString tagIdsInSqlList() const;
 
     virtual void openDatabase(const QString & connectionString, const QString & databaseName) const = 0;
     virtual void cloneDatabase(const QString & databaseName, const QString & newConnectionName) const = 0;
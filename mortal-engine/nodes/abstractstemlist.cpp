@@ -8,13 +8,76 @@
 
 #include "debug.h"
 
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+#include <QVector>
+#include <QMutexLocker>
+#include <QXmlStreamReader>
+
 using namespace ME;
 
+namespace {
+
+/// below this many stems per thread, generating the allomorphs in one thread is faster
+const int MINIMUM_STEMS_PER_THREAD = 2000;
+
+/// Each task takes the next stem until none are left. The derived allomorphs of
+/// one stem don't depend on any other stem.
+class AllomorphGenerationTask : public QRunnable
+{
+public:
+    AllomorphGenerationTask(const QVector<LexicalStem*> * stems, const QList<CreateAllomorphs> * createAllomorphs, QAtomicInt * nextIndex)
+        : mStems(stems), mCreateAllomorphs(createAllomorphs), mNextIndex(nextIndex)
+    {
+    }
+
+    void run() override
+    {
+        int i;
+        while( ( i = mNextIndex->fetchAndAddRelaxed(1) ) < mStems->count() )
+        {
+            mStems->at(i)->generateAllomorphs( *mCreateAllomorphs );
+        }
+    }
+
+private:
+    const QVector<LexicalStem*> * mStems;
+    const QList<CreateAllomorphs> * mCreateAllomorphs;
+    QAtomicInt * mNextIndex;
+};
+
+/// the stems in parsings have already been given their derived allomorphs
+bool hasDerivedAllomorphs(const LexicalStem & stem)
+{
+    QListIterator<Allomorph> ai = stem.allomorphIterator();
+    while( ai.hasNext() )
+    {
+        if( ai.next().type() == Allomorph::Derived )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 QString AbstractStemList::XML_FILENAME = "filename";
 QString AbstractStemList::XML_MATCHING_TAG = "matching-tag";
+QString AbstractStemList::XML_LAZY_ALLOMORPHS = "lazy-allomorphs";
+QString AbstractStemList::XML_ALLOMORPH_CACHE_SIZE = "allomorph-cache-size";
+const int AbstractStemList::DEFAULT_DERIVED_ALLOMORPH_CACHE_SIZE = 10000;
 
 
-AbstractStemList::AbstractStemList(const MorphologicalModel *model) : AbstractNode(model->morphology(), model, AbstractNode::StemNodeType)
+AbstractStemList::AbstractStemList(const MorphologicalModel *model) : AbstractNode(model->morphology(), model, AbstractNode::StemNodeType),
+    mLazyDerivedAllomorphs(false),
+    mHasStemPortmanteaux(false),
+    mExpansions(DEFAULT_DERIVED_ALLOMORPH_CACHE_SIZE)
 {
 
 }
@@ -40,12 +103,61 @@ bool AbstractStemList::addStem(LexicalStem *stem)
     {
         LexicalStem * newStem = new LexicalStem( * stem );
         newStem->initializePortmanteaux(this);
-        insertStemIntoDataModel( newStem );
+        if( !insertStemsIntoDataModel( QList<LexicalStem*>() << newStem ) )
+        {
+            delete newStem;
+            return false;
+        }
+        /// insertStemsIntoDataModel generates the derived allomorphs and the id, so index the stem afterward
+        stem->setId( newStem->id() );
+        finishInsertedStem( newStem );
     }
 
     return shouldInsert;
 }
 
+QList<bool> AbstractStemList::addStems(QList<LexicalStem> &stems)
+{
+    QList<bool> results;
+    QList<LexicalStem*> newStems;
+    QList<int> indices;
+    for(int i=0; i < stems.count(); i++)
+    {
+        const bool shouldInsert = matchesForInsert( stems.at(i) );
+        results << shouldInsert;
+        if( shouldInsert )
+        {
+            LexicalStem * newStem = new LexicalStem( stems.at(i) );
+            newStem->initializePortmanteaux(this);
+            newStems << newStem;
+            indices << i;
+        }
+    }
+
+    if( newStems.isEmpty() )
+    {
+        return results;
+    }
+
+    if( !insertStemsIntoDataModel( newStems ) )
+    {
+        qDeleteAll( newStems );
+        foreach( int i, indices )
+        {
+            results[i] = false;
+        }
+        return results;
+    }
+
+    for(int i=0; i < newStems.count(); i++)
+    {
+        stems[ indices.at(i) ].setId( newStems.at(i)->id() );
+        finishInsertedStem( newStems.at(i) );
+    }
+
+    return results;
+}
+
 bool AbstractStemList::replaceStem(const LexicalStem & stem)
 {
     bool removed = removeLexicalStem(stem.id());
@@ -54,24 +166,35 @@ bool AbstractStemList::replaceStem(const LexicalStem & stem)
     {
         LexicalStem * newStem = new LexicalStem(stem);
         newStem->initializePortmanteaux(this);
-        mStems.insert(newStem);
-        insertStemIntoDataModel(newStem);
+        if( insertStemsIntoDataModel( QList<LexicalStem*>() << newStem ) )
+        {
+            finishInsertedStem(newStem);
+        }
+        else
+        {
+            delete newStem;
+        }
     }
     return removed;
 }
 
 LexicalStem *AbstractStemList::getStem(qlonglong id) const
 {
-    QSetIterator<LexicalStem*> i(mStems);
-    while( i.hasNext() )
+    /// stems without an id (e.g., those read from XML) all have the id -1, so they aren't in mStemsById
+    if( id == -1 )
     {
-        LexicalStem * current = i.next();
-        if( current->id() == id )
+        QSetIterator<LexicalStem*> i(mStems);
+        while( i.hasNext() )
         {
-            return current;
+            LexicalStem * current = i.next();
+            if( current->id() == id )
+            {
+                return current;
+            }
         }
+        return nullptr;
     }
-    return nullptr;
+    return mStemsById.value(id, nullptr);
 }
 
 bool AbstractStemList::matchesForInsert(const LexicalStem &stem) const
@@ -91,6 +214,18 @@ bool AbstractStemList::matchesForInsert(const LexicalStem &stem) const
 QList<LexicalStem *> AbstractStemList::stemsFromAllomorph(const Form &form, const QSet<Tag> containingTags, const QSet<Tag> withoutTags, bool includeDerivedAllomorphs) const
 {
     QList<LexicalStem *> stems;
+    if( mLazyDerivedAllomorphs )
+    {
+        foreach( LexicalStem * current, stemsIndexedUnder(form) )
+        {
+            if( expandedStem(current)->hasAllomorph( form, containingTags, withoutTags, includeDerivedAllomorphs ) )
+            {
+                stems << current;
+            }
+        }
+        return stems;
+    }
+
     QSetIterator<LexicalStem*> i(mStems);
     while( i.hasNext() )
     {
@@ -106,6 +241,31 @@ QList<LexicalStem *> AbstractStemList::stemsFromAllomorph(const Form &form, cons
 QList<LexicalStem *> AbstractStemList::stemsFromAllomorph(const Allomorph &allomorph, bool matchConstraints) const
 {
     QList<LexicalStem *> stems;
+    if( mLazyDerivedAllomorphs )
+    {
+        /// a stem with the allomorph is indexed under each of its forms, so only those stems need to be expanded
+        Form indexForm;
+        QHashIterator<WritingSystem, Form> fi( allomorph.forms() );
+        while( fi.hasNext() )
+        {
+            fi.next();
+            if( !fi.value().text().isEmpty() )
+            {
+                indexForm = fi.value();
+                break;
+            }
+        }
+
+        foreach( LexicalStem * current, stemsIndexedUnder(indexForm) )
+        {
+            if( expandedStem(current)->hasAllomorph( allomorph, matchConstraints ) )
+            {
+                stems << current;
+            }
+        }
+        return stems;
+    }
+
     QSetIterator<LexicalStem*> i(mStems);
     while( i.hasNext() )
     {
@@ -120,6 +280,29 @@ QList<LexicalStem *> AbstractStemList::stemsFromAllomorph(const Allomorph &allom
 
 LexicalStem *AbstractStemList::lexicalStem(const LexicalStem &stem) const
 {
+    /// an identical stem has identical allomorphs, so it is in the form index under any form of the first allomorph
+    if( stem.allomorphCount() > 0 )
+    {
+        QHashIterator<WritingSystem, Form> fi( stem.allomorph(0).forms() );
+        while( fi.hasNext() )
+        {
+            fi.next();
+            if( fi.value().text().isEmpty() )
+            {
+                continue;
+            }
+            const QList<LexicalStem*> candidates = mFormIndex.value( fi.key() ).values( fi.value().text() );
+            foreach( LexicalStem * current, candidates )
+            {
+                if( *current == stem )
+                {
+                    return current;
+                }
+            }
+            return nullptr;
+        }
+    }
+
     QSetIterator<LexicalStem*> i(mStems);
     while( i.hasNext() )
     {
@@ -134,17 +317,22 @@ LexicalStem *AbstractStemList::lexicalStem(const LexicalStem &stem) const
 
 bool AbstractStemList::removeLexicalStem(qlonglong id)
 {
-    QSetIterator<LexicalStem*> i(mStems);
-    while( i.hasNext() )
+    LexicalStem * current = AbstractStemList::getStem(id);
+    if( current != nullptr )
     {
-        LexicalStem * current = i.next();
-        if( current->id() == id )
-        {            
-            bool result = mStems.remove(current);
-            removeStemFromDataModel(id);
-            return result;
-        }
+        removeFromIndices(current);
+        bool result = mStems.remove(current);
+        removeStemFromDataModel(id);
+        return result;
     }
+
+    /// a stem that is loaded on demand needn't be in mStems
+    if( loadsStemsOnDemand() && getStem(id) != nullptr )
+    {
+        removeStemFromDataModel(id);
+        return true;
+    }
+
     return false;
 }
 
@@ -152,7 +340,18 @@ QList<Parsing> AbstractStemList::parsingsUsingThisNode(const Parsing &parsing, P
 {
     QList<Parsing> candidates;
 
-    QList< QPair<Allomorph, LexicalStem> > allomorphMatches = matchingAllomorphs(parsing);
+    /// with Parsing::ReferenceModelObjects, the steps refer to the stems in this list rather than copying them
+    /// (stems that are loaded on demand or expanded lazily can be dropped from their caches, so they are always copied)
+    QList< QPair<const Allomorph*, const LexicalStem*> > allomorphReferences;
+    QList< QPair<Allomorph, LexicalStem> > allomorphMatches;
+    if( flags & Parsing::ReferenceModelObjects && !loadsStemsOnDemand() && !mLazyDerivedAllomorphs )
+    {
+        allomorphReferences = matchingAllomorphReferences(parsing);
+    }
+    else
+    {
+        allomorphMatches = matchingAllomorphs(parsing);
+    }
 
     /// if the parsing is suppose to guess the stem, we should try all possible parsings
     /// but if the parsing already has a hypothetical stem, we shouldn't try to find another
@@ -162,21 +361,27 @@ QList<Parsing> AbstractStemList::parsingsUsingThisNode(const Parsing &parsing, P
         allomorphMatches.append( possibleStemForms(parsing) );
     }
 
-    parsingLog()->info( QObject::tr("%1 candidate stem matches.").arg( allomorphMatches.count() ) );
+    parsingLog()->deferredInfo( [&]{ return QObject::tr("%1 candidate stem matches.").arg( allomorphReferences.count() + allomorphMatches.count() ); } );
 
-    QListIterator< QPair<Allomorph, LexicalStem> > ai(allomorphMatches);
-    while(ai.hasNext())
+    for(int i=0; i < allomorphReferences.count() + allomorphMatches.count(); i++)
     {
-        QPair<Allomorph, LexicalStem> pair = ai.next();
-        Allomorph a = pair.first;
-        LexicalStem ls = pair.second;
         Parsing p = parsing;
-        p.append(this, a, ls, true);
+        const bool isReference = i < allomorphReferences.count();
+        if( isReference )
+        {
+            p.append(this, allomorphReferences.at(i).first, allomorphReferences.at(i).second, true);
+        }
+        else
+        {
+            const QPair<Allomorph, LexicalStem> & pair = allomorphMatches.at( i - allomorphReferences.count() );
+            p.append(this, pair.first, pair.second, true);
+        }
+        const Allomorph & a = isReference ? *allomorphReferences.at(i).first : allomorphMatches.at( i - allomorphReferences.count() ).first;
         parsingLog()->parsingStatus(p);
 
         if( p.hasNotFailed() )
         {
-            parsingLog()->output("stem-match", a.oneLineSummary());
+            parsingLog()->deferredOutput( "stem-match", [&]{ return a.oneLineSummary(); } );
         }
 
         /// we want to move to the next node either 1) the parse hasn't been completed, or 2) there
@@ -205,18 +410,29 @@ QList<Generation> AbstractStemList::generateFormsUsingThisNode(const Generation
     if( generation.stemIdentityConstraint()->hasStemRequirement() )
     {
         const LexicalStem s = generation.stemIdentityConstraint()->currentLexicalStem();
+        const LexicalStem * listed = getStem( s.id() );
         /// only proceed if the specified stem is found in this stem list
-        if( getStem( s.id() ) != nullptr )
+        if( listed != nullptr )
         {
+            /// if the derived allomorphs are generated lazily, the stem only has its original allomorphs,
+            /// unless it comes from a parsing
+            QSharedPointer<const LexicalStem> expanded;
+            if( mLazyDerivedAllomorphs && !hasDerivedAllomorphs( s ) )
+            {
+                /// stems without an id (e.g., those read from XML) are all -1, so listed may be a different stem;
+                /// only a stem that was found by its id can use the cached expansion
+                expanded = s.id() != -1 ? expandedStem( listed ) : QSharedPointer<const LexicalStem>( new LexicalStem( expansionOf( s ) ) );
+            }
+
             /// check all the allomorphs of the stem
-            QListIterator<Allomorph> ai = s.allomorphIterator();
+            QListIterator<Allomorph> ai = expanded.isNull() ? s.allomorphIterator() : expanded->allomorphIterator();
             while(ai.hasNext())
             {
                 Allomorph a = ai.next();
                 /// make sure that the Allomorph has a form for the generation's writing system
                 if( a.useInGenerations() && a.hasForm( generation.writingSystem() ) && generation.allomorphMatchConditionsSatisfied(a) ) /// this just checks for match conditions (e.g., tags)
                 {
-                    parsingLog()->output("stem-match", a.oneLineSummary());
+                    parsingLog()->deferredOutput( "stem-match", [&]{ return a.oneLineSummary(); } );
 
                     Generation g = generation;
                     g.append(this, a, s, true);
@@ -228,9 +444,9 @@ QList<Generation> AbstractStemList::generateFormsUsingThisNode(const Generation
                     if( g.isOngoing() && hasNext() ) /// more morphemes remain in the model
                     {
                         const AbstractNode * nextNode;
-                        if( g.steps().last().allomorph().hasPortmanteau( g.writingSystem() ) )
+                        if( g.lastStep().allomorph().hasPortmanteau( g.writingSystem() ) )
                         {
-                            nextNode = g.steps().last().allomorph().portmanteau().next();
+                            nextNode = g.lastStep().allomorph().portmanteau().next();
                         }
                         else
                         {
@@ -240,7 +456,7 @@ QList<Generation> AbstractStemList::generateFormsUsingThisNode(const Generation
                         /// nextNode can be null, e.g., if the last node of a portmanteau stem has no following node
                         if( nextNode != nullptr )
                         {
-                            parsingLog()->info( QObject::tr("Appended: %1").arg( a.oneLineSummary() ) );
+                            parsingLog()->deferredInfo( [&]{ return QObject::tr("Appended: %1").arg( a.oneLineSummary() ); } );
                             candidates.append( nextNode->generateForms( g ) );
                         }
                     }
@@ -254,24 +470,85 @@ QList<Generation> AbstractStemList::generateFormsUsingThisNode(const Generation
     return candidates;
 }
 
+template<typename F>
+void AbstractStemList::forEachIndexedPrefix(const Parsing &parsing, F f) const
+{
+    const WritingSystem ws = parsing.writingSystem();
+    QHash<WritingSystem, QMultiHash<QString, LexicalStem*> >::const_iterator wsIndex = mFormIndex.constFind(ws);
+    if( wsIndex == mFormIndex.constEnd() )
+    {
+        return;
+    }
+
+    /// only stems with an allomorph that is a prefix of the remainder can match,
+    /// so look up each prefix of the remainder, up to the longest form in the index
+    /// (stems should never be null morphemes, so the prefixes start at length 1)
+    const QString text = parsing.form().text();
+    const int maxLength = qMin( mLongestIndexedForm.value(ws, 0), static_cast<int>( text.length() ) - parsing.position() );
+    for(int length = 1; length <= maxLength; length++)
+    {
+        const QString prefix = text.mid( parsing.position(), length );
+        const QList<LexicalStem*> stems = wsIndex.value().values(prefix);
+        if( !stems.isEmpty() )
+        {
+            f( prefix, stems );
+        }
+    }
+}
+
 QList<QPair<Allomorph, LexicalStem> > AbstractStemList::matchingAllomorphs(const Parsing &parsing) const
 {
     QList<QPair<Allomorph, LexicalStem> > list;
+    if( mLazyDerivedAllomorphs )
+    {
+        const WritingSystem ws = parsing.writingSystem();
+        HotPathCounters * counters = statisticsCounters();
+        forEachIndexedPrefix( parsing, [&](const QString & prefix, const QList<LexicalStem*> & stems)
+        {
+            foreach( LexicalStem *s, stems )
+            {
+                const QSharedPointer<const LexicalStem> expanded = expandedStem( s );
+                for(int i=0; i < expanded->allomorphCount(); i++)
+                {
+                    const Allomorph & a = expanded->allomorph(i);
+                    if( a.form(ws).text() == prefix && parsing.allomorphMatches( a, mMorphology->stemDebugOutput(), counters ) )
+                    {
+                        list << QPair<Allomorph, LexicalStem>( a, *expanded );
+                    }
+                }
+            }
+        });
+        return list;
+    }
+
+    const QList< QPair<const Allomorph*, const LexicalStem*> > references = matchingAllomorphReferences(parsing);
+    for(int i=0; i < references.count(); i++)
+    {
+        list << QPair<Allomorph, LexicalStem>( *references.at(i).first, *references.at(i).second );
+    }
+    return list;
+}
+
+QList<QPair<const Allomorph *, const LexicalStem *> > AbstractStemList::matchingAllomorphReferences(const Parsing &parsing) const
+{
+    QList<QPair<const Allomorph *, const LexicalStem *> > list;
 
-    /// cycle through each form
-    foreach( LexicalStem *s, mStems )
+    const WritingSystem ws = parsing.writingSystem();
+    HotPathCounters * counters = statisticsCounters();
+    forEachIndexedPrefix( parsing, [&](const QString & prefix, const QList<LexicalStem*> & stems)
     {
-        QListIterator<Allomorph> ai = s->allomorphIterator();
-        while(ai.hasNext())
+        foreach( LexicalStem *s, stems )
         {
-            Allomorph a = ai.next();
-            /// stems should never be null morphemes, so we can check for that
-            if( a.form( parsing.writingSystem() ).text().length() > 0 && parsing.allomorphMatches( a, mMorphology->stemDebugOutput() ) )
+            for(int i=0; i < s->allomorphCount(); i++)
             {
-                list << QPair<Allomorph, LexicalStem>( a, * s );
+                const Allomorph & a = s->allomorph(i);
+                if( a.form(ws).text() == prefix && parsing.allomorphMatches( a, mMorphology->stemDebugOutput(), counters ) )
+                {
+                    list << QPair<const Allomorph *, const LexicalStem *>( &a, s );
+                }
             }
         }
-    }
+    });
 
     return list;
 }
@@ -285,7 +562,7 @@ QString AbstractStemList::summary(const AbstractNode *doNotFollow) const
 {
     QString dbgString;
     Debug dbg(&dbgString);
-    Debug::atBeginning = false;
+    Debug::setAtBeginning(false);
     dbg << "StemList(" << Debug::endl;
     dbg.indent();
     dbg << "Label: " << label().toString() << Debug::endl;
@@ -314,16 +591,142 @@ QString AbstractStemList::summary(const AbstractNode *doNotFollow) const
         dbg << next()->summary(doNotFollow);
     }
 
-    Debug::atBeginning = true;
+    Debug::setAtBeginning(true);
 
     return dbgString;
 }
 
+bool AbstractStemList::insertStemsIntoDataModel(const QList<LexicalStem *> &stems)
+{
+    foreach( LexicalStem * stem, stems )
+    {
+        insertStemIntoDataModel( stem );
+    }
+    return true;
+}
+
 bool AbstractStemList::match(const Allomorph &allomorph) const
 {
     return allomorph.tags().contains(mTags);
 }
 
+void AbstractStemList::readStemListAttributes(QXmlStreamReader &in)
+{
+    if( in.attributes().value(XML_LAZY_ALLOMORPHS).toString() == "true" )
+    {
+        bool ok = false;
+        const int cacheSize = in.attributes().value(XML_ALLOMORPH_CACHE_SIZE).toString().toInt(&ok);
+        setLazyDerivedAllomorphs( true, ok && cacheSize > 0 ? cacheSize : DEFAULT_DERIVED_ALLOMORPH_CACHE_SIZE );
+    }
+}
+
+void AbstractStemList::generateDerivedAllomorphs(LexicalStem *stem) const
+{
+    if( !mLazyDerivedAllomorphs )
+    {
+        stem->generateAllomorphs(mCreateAllomorphs);
+    }
+}
+
+QByteArray AbstractStemList::sourceFingerprint() const
+{
+    return QByteArray();
+}
+
+bool AbstractStemList::loadsStemsOnDemand() const
+{
+    return false;
+}
+
+bool AbstractStemList::canReadStemsInParallel() const
+{
+    return true;
+}
+
+void AbstractStemList::setLazyDerivedAllomorphs(bool lazy, int cacheSize)
+{
+    QMutexLocker locker(&mExpansionMutex);
+    mLazyDerivedAllomorphs = lazy;
+    mExpansions.clear();
+    mExpansions.setMaxCost( cacheSize );
+}
+
+bool AbstractStemList::lazyDerivedAllomorphs() const
+{
+    return mLazyDerivedAllomorphs;
+}
+
+QSharedPointer<const LexicalStem> AbstractStemList::expandedStem(const LexicalStem *stem) const
+{
+    {
+        QMutexLocker locker(&mExpansionMutex);
+        const QSharedPointer<const LexicalStem> * cached = mExpansions.object( stem );
+        if( cached != nullptr )
+        {
+            return *cached;
+        }
+    }
+
+    /// expand outside of the lock, so that other threads aren't held up; at worst two threads expand the same stem
+    const QSharedPointer<const LexicalStem> expanded( new LexicalStem( expansionOf( *stem ) ) );
+
+    QMutexLocker locker(&mExpansionMutex);
+    mExpansions.insert( stem, new QSharedPointer<const LexicalStem>( expanded ) );
+    return expanded;
+}
+
+LexicalStem AbstractStemList::expansionOf(const LexicalStem &stem) const
+{
+    LexicalStem expanded( stem );
+    expanded.generateAllomorphs( mCreateAllomorphs );
+    expanded.initializePortmanteaux( this );
+    return expanded;
+}
+
+QList<LexicalStem *> AbstractStemList::stemsIndexedUnder(const Form &form) const
+{
+    if( form.text().isEmpty() )
+    {
+        return QList<LexicalStem*>( mStems.begin(), mStems.end() );
+    }
+    return mFormIndex.value( form.writingSystem() ).values( form.text() );
+}
+
+QByteArray AbstractStemList::fingerprintForFile(const QString &kind, const QString &filename, const QStringList &settings) const
+{
+    const QFileInfo info(filename);
+    if( !info.exists() )
+    {
+        return QByteArray();
+    }
+
+    QStringList tags;
+    foreach( Tag t, mTags )
+    {
+        tags << t.label();
+    }
+    tags.sort();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData( kind.toUtf8() );
+    hash.addData( info.absoluteFilePath().toUtf8() );
+    hash.addData( QByteArray::number( info.size() ) );
+    hash.addData( QByteArray::number( info.lastModified().toMSecsSinceEpoch() ) );
+    hash.addData( tags.join(",").toUtf8() );
+    hash.addData( settings.join(",").toUtf8() );
+    return hash.result();
+}
+
+QSet<LexicalStem *> AbstractStemList::readStemsFromSource(const QHash<QString, WritingSystem> &writingSystems)
+{
+    /// readStems() adds to mStems, so give it an empty set and then put the current stems back
+    QSet<LexicalStem*> current;
+    current.swap( mStems );
+    readStems( writingSystems );
+    current.swap( mStems );
+    return current;
+}
+
 QSet<LexicalStem *> AbstractStemList::stems() const
 {
     return mStems;
@@ -336,9 +739,15 @@ void AbstractStemList::initializePortmanteaux()
     {
         LexicalStem *stem = i.next();
         stem->initializePortmanteaux(this);
+        mHasStemPortmanteaux = mHasStemPortmanteaux || stem->hasPortmanteaux();
     }
 }
 
+bool AbstractStemList::hasStemPortmanteaux() const
+{
+    return mHasStemPortmanteaux || loadsStemsOnDemand();
+}
+
 template<typename T>
 void AbstractStemList::filterOutPortmanteauClashes(QList<T> &candidates) const
 {
@@ -355,10 +764,28 @@ void AbstractStemList::filterOutPortmanteauClashes(QList<T> &candidates) const
 void AbstractStemList::addCreateAllomorphs(const CreateAllomorphs &createAllomorphs)
 {
     mCreateAllomorphs << createAllomorphs;
+
+    QMutexLocker locker(&mExpansionMutex);
+    mExpansions.clear();
+}
+
+QList<CreateAllomorphs> AbstractStemList::createAllomorphs() const
+{
+    return mCreateAllomorphs;
 }
 
 bool AbstractStemList::someStemContainsForm(const Form &f) const
 {
+    if( mLazyDerivedAllomorphs )
+    {
+        foreach( LexicalStem * stem, stemsIndexedUnder(f) )
+        {
+            if( expandedStem(stem)->hasAllomorphWithForm(f) )
+                return true;
+        }
+        return false;
+    }
+
     QSetIterator<LexicalStem*> i(mStems);
     while(i.hasNext())
     {
@@ -406,11 +833,137 @@ QList<QPair<Allomorph, LexicalStem> > AbstractStemList::possibleStemForms(const
 
 void AbstractStemList::generateAllomorphsFromRules()
 {
-    QSetIterator<LexicalStem*> stemIterator(mStems);
-    
-    while( stemIterator.hasNext() )
+    /// with lazy derived allomorphs, the stems keep their original allomorphs, and the derived ones are only indexed (which still generates them once; see addToIndices)
+    if( mLazyDerivedAllomorphs )
+    {
+        rebuildIndices();
+        return;
+    }
+
+    const int threads = mCreateAllomorphs.isEmpty() ? 1 : qMin( QThread::idealThreadCount(), mStems.count() / MINIMUM_STEMS_PER_THREAD );
+
+    if( threads < 2 )
+    {
+        QSetIterator<LexicalStem*> stemIterator(mStems);
+
+        while( stemIterator.hasNext() )
+        {
+            LexicalStem * stem = stemIterator.next();
+            stem->generateAllomorphs( mCreateAllomorphs );
+        }
+    }
+    else
+    {
+        const QVector<LexicalStem*> stems( mStems.begin(), mStems.end() );
+        QAtomicInt nextIndex(0);
+
+        QThreadPool pool;
+        pool.setMaxThreadCount( threads );
+        for(int i=0; i < threads; i++)
+        {
+            pool.start( new AllomorphGenerationTask( &stems, &mCreateAllomorphs, &nextIndex ) );
+        }
+        pool.waitForDone();
+    }
+
+    rebuildIndices();
+}
+
+void AbstractStemList::rebuildIndices()
+{
+    mStemsById.clear();
+    mFormIndex.clear();
+    mLongestIndexedForm.clear();
+
+    QSetIterator<LexicalStem*> i(mStems);
+    while( i.hasNext() )
     {
-        LexicalStem * stem = stemIterator.next();
-        stem->generateAllomorphs( mCreateAllomorphs );
+        addToIndices( i.next() );
+    }
+}
+
+void AbstractStemList::addToIndices(LexicalStem *stem)
+{
+    if( stem->id() != -1 )
+    {
+        mStemsById.insert( stem->id(), stem );
+    }
+    mHasStemPortmanteaux = mHasStemPortmanteaux || stem->hasPortmanteaux();
+
+    addFormsToIndex( stem, *stem );
+    /// the derived forms are only known once they are generated, so each stem is expanded here in full;
+    /// the expansion isn't cached, since every stem is indexed when the model is read
+    if( mLazyDerivedAllomorphs && !mCreateAllomorphs.isEmpty() )
+    {
+        addFormsToIndex( stem, expansionOf( *stem ) );
+    }
+}
+
+void AbstractStemList::finishInsertedStem(LexicalStem *stem)
+{
+    if( loadsStemsOnDemand() )
+    {
+        delete stem;
+    }
+    else
+    {
+        addToIndices( stem );
+    }
+}
+
+void AbstractStemList::addFormsToIndex(LexicalStem *stem, const LexicalStem &formSource)
+{
+    QListIterator<Allomorph> ai = formSource.allomorphIterator();
+    while( ai.hasNext() )
+    {
+        QHashIterator<WritingSystem, Form> fi( ai.next().forms() );
+        while( fi.hasNext() )
+        {
+            fi.next();
+            const QString text = fi.value().text();
+            QMultiHash<QString, LexicalStem*> & index = mFormIndex[ fi.key() ];
+            /// a stem is listed once per form, even if several of its allomorphs share the form
+            if( text.isEmpty() || index.contains(text, stem) )
+            {
+                continue;
+            }
+            index.insert(text, stem);
+            mLongestIndexedForm[ fi.key() ] = qMax( mLongestIndexedForm.value( fi.key(), 0 ), static_cast<int>( text.length() ) );
+        }
+    }
+}
+
+void AbstractStemList::removeFromIndices(LexicalStem *stem)
+{
+    if( mStemsById.value( stem->id() ) == stem )
+    {
+        mStemsById.remove( stem->id() );
+    }
+
+    /// mLongestIndexedForm is left alone; an overestimate just means a few extra lookups
+    removeFormsFromIndex( stem, *stem );
+    if( mLazyDerivedAllomorphs )
+    {
+        if( !mCreateAllomorphs.isEmpty() )
+        {
+            removeFormsFromIndex( stem, expansionOf( *stem ) );
+        }
+
+        QMutexLocker locker(&mExpansionMutex);
+        mExpansions.remove( stem );
+    }
+}
+
+void AbstractStemList::removeFormsFromIndex(LexicalStem *stem, const LexicalStem &formSource)
+{
+    QListIterator<Allomorph> ai = formSource.allomorphIterator();
+    while( ai.hasNext() )
+    {
+        QHashIterator<WritingSystem, Form> fi( ai.next().forms() );
+        while( fi.hasNext() )
+        {
+            fi.next();
+            mFormIndex[ fi.key() ].remove( fi.value().text(), stem );
+        }
     }
 }
@@ -9,12 +9,19 @@
 #include "datatypes/lexicalstem.h"
 #include "create-allomorphs/createallomorphs.h"
 
+#include <QCache>
+#include <QMutex>
+#include <QSharedPointer>
+
 namespace ME {
 
 class LexicalStem;
+class MorphologySnapshot;
 
 class MORTAL_ENGINE_EXPORT AbstractStemList : public AbstractNode
 {
+    friend class MorphologySnapshot;
+
 public:
     explicit AbstractStemList(const MorphologicalModel * model);
     ~AbstractStemList() override;
@@ -25,16 +32,25 @@ public:
 
     virtual void readStems( const QHash<QString,WritingSystem> &writingSystems ) = 0;
 
+    //! \brief Returns true if readStems() may be called from another thread, at the same time as other stem lists are reading their stems. MorphologyXmlReader reads such stem lists in parallel.
+    virtual bool canReadStemsInParallel() const;
+
+    //! \brief Returns a value that changes whenever the stems that readStems() would read change (e.g., because the source file has been modified), or an empty QByteArray if that cannot be known. Stem lists with an empty fingerprint are not stored in a MorphologySnapshot.
+    virtual QByteArray sourceFingerprint() const;
+
     /// BEGIN STEM MODIFICATION FUNCTIONS
 
-    //! \brief If any allomorph in \a stem meets the match() condition, add this stem to the database and return true. Otherwise delete the pointer and return false.
+    //! \brief If any allomorph in \a stem meets the match() condition, add a copy of this stem to the database and return true; the id of the copy (which may be assigned by the database) is written back to \a stem. Otherwise, or if the database could not store the copy, return false. The caller keeps ownership of \a stem.
     bool addStem( LexicalStem * stem );
 
+    //! \brief Adds copies of the stems in \a stems that meet the match() condition, as addStem() does, but passes them to the data model all at once. Returns whether each stem was added, in the same order (if the data model cannot store them, none is added); the ids of the added stems are written back to \a stems.
+    QList<bool> addStems( QList<LexicalStem> & stems );
+
     //! \brief Replace a lexical stem having the same mId as \a stem with the data in \a stem
     bool replaceStem(const LexicalStem &stem );
 
     //!
-    LexicalStem *getStem( qlonglong id ) const;
+    virtual LexicalStem *getStem( qlonglong id ) const;
 
     bool matchesForInsert( const LexicalStem & stem ) const;
     QList<LexicalStem *> stemsFromAllomorph(const Form & form, const QSet<Tag> containingTags = QSet<Tag>(), const QSet<Tag> withoutTags = QSet<Tag>(), bool includeDerivedAllomorphs = false ) const;
@@ -45,7 +61,17 @@ public:
 
     //// END OF STEM FUNCTIONS
 
-    QList< QPair<Allomorph,LexicalStem> > matchingAllomorphs(const Parsing &parsing) const;
+    virtual QList< QPair<Allomorph,LexicalStem> > matchingAllomorphs(const Parsing &parsing) const;
+    //! \brief Returns the same matches as matchingAllomorphs(), but as pointers to the allomorphs and stems of this list rather than copies. This only searches the stems in memory, so it should not be used if loadsStemsOnDemand() or lazyDerivedAllomorphs() is true.
+    QList< QPair<const Allomorph*, const LexicalStem*> > matchingAllomorphReferences(const Parsing &parsing) const;
+
+    //! \brief Returns true if the stems are looked up in the source as they are needed, rather than read into memory when the model is loaded. In that case stems() and the functions that search it only see the stems that have been loaded.
+    virtual bool loadsStemsOnDemand() const;
+
+    //! \brief Sets whether the stems keep only their original allomorphs in memory. The derived allomorphs (see addCreateAllomorphs) are then generated again whenever a stem is a candidate for a parse or a generation, and the \a cacheSize most recently used stems are kept with their derived allomorphs. Only the forms of the derived allomorphs are kept in the form index. This must be set before generateAllomorphsFromRules() is called.
+    //! This saves memory, not time: every stem is still expanded once when the model is loaded (or the stem is added), since its derived forms can only be indexed by generating them, and the expansions are then discarded. In this mode stems() and getStem() return stems with only their original allomorphs.
+    void setLazyDerivedAllomorphs(bool lazy, int cacheSize = DEFAULT_DERIVED_ALLOMORPH_CACHE_SIZE);
+    bool lazyDerivedAllomorphs() const;
 
     void addConditionTag(const QString & tag);
 
@@ -56,9 +82,14 @@ public:
      */
     QString summary(const AbstractNode * doNotFollow) const override;
 
+    //! \brief Generates the derived allomorphs of every stem and then calls rebuildIndices(). The stems of a large stem list are divided among several threads.
     void generateAllomorphsFromRules();
 
+    //! \brief Rebuilds the indices of stems by id and by allomorph form. This is called by generateAllomorphsFromRules(), since allomorph forms are final after that point.
+    void rebuildIndices();
+
     void addCreateAllomorphs(const CreateAllomorphs &createAllomorphs);
+    QList<CreateAllomorphs> createAllomorphs() const;
 
     bool someStemContainsForm(const Form & f) const;
 
@@ -68,28 +99,76 @@ public:
 
     static QString XML_FILENAME;
     static QString XML_MATCHING_TAG;
+    static QString XML_LAZY_ALLOMORPHS;
+    static QString XML_ALLOMORPH_CACHE_SIZE;
+    static const int DEFAULT_DERIVED_ALLOMORPH_CACHE_SIZE;
 
     QSet<LexicalStem *> stems() const;
 
     void initializePortmanteaux();
+    //! \brief Returns true if any stem that has been added to the list has a portmanteau allomorph (this is not reset when the stem is removed), or if the stems are loaded on demand, in which case it cannot be known in advance
+    bool hasStemPortmanteaux() const;
 
     template<typename T>
     void filterOutPortmanteauClashes(QList<T> &candidates) const;
 
 private:
+    //! \brief Calls \a f with each prefix of the remainder of \a parsing that is in the form index, and the stems listed under it
+    template<typename F>
+    void forEachIndexedPrefix(const Parsing & parsing, F f) const;
+
+    //! \brief Returns a copy of \a stem with its derived allomorphs, from the cache if possible
+    QSharedPointer<const LexicalStem> expandedStem(const LexicalStem * stem) const;
+    LexicalStem expansionOf(const LexicalStem & stem) const;
+    //! \brief Returns the stems that may have an allomorph with \a form: the stems listed under it in the form index, or every stem if the form is empty
+    QList<LexicalStem*> stemsIndexedUnder(const Form & form) const;
+    void addFormsToIndex(LexicalStem * stem, const LexicalStem & formSource);
+    void removeFormsFromIndex(LexicalStem * stem, const LexicalStem & formSource);
+
     QList<Parsing> parsingsUsingThisNode(const Parsing & parsing, Parsing::Flags flags) const override;
     QList<QPair<Allomorph, LexicalStem>> possibleStemForms(const Parsing & parsing) const;
     QList<Generation> generateFormsUsingThisNode(const Generation & generation) const override;
 
 protected:
     virtual void insertStemIntoDataModel( LexicalStem * stem ) = 0;
+    //! \brief Inserts all of \a stems, as insertStemIntoDataModel() does for one, and returns true. If the stems cannot be stored, none of them is added to the list and false is returned; the caller keeps ownership of them in that case. If the stems are loaded on demand (see loadsStemsOnDemand()), they are only written to the data model, and the caller keeps ownership of them as well. The default implementation calls insertStemIntoDataModel() for each stem.
+    virtual bool insertStemsIntoDataModel( const QList<LexicalStem*> & stems );
     virtual void removeStemFromDataModel( qlonglong id ) = 0;
 
     bool match(const Allomorph &allomorph) const;
 
+    //! \brief Reads the attributes of the stem list element that all stem lists have (lazy-allomorphs, allomorph-cache-size)
+    void readStemListAttributes(QXmlStreamReader &in);
+
+    //! \brief Generates the derived allomorphs of a stem that is being added to the data model, unless they are generated lazily (see setLazyDerivedAllomorphs)
+    void generateDerivedAllomorphs(LexicalStem * stem) const;
+
+    //! \brief Returns a fingerprint of the file \a filename (its path, size, and modification time), the stem list type \a kind, the condition tags, and any other \a settings that affect which stems are read
+    QByteArray fingerprintForFile(const QString & kind, const QString & filename, const QStringList & settings = QStringList()) const;
+
+    //! \brief Reads the stems from the source without changing the stems of the stem list. The caller owns the returned stems.
+    QSet<LexicalStem*> readStemsFromSource( const QHash<QString,WritingSystem> &writingSystems );
+
+    void addToIndices(LexicalStem * stem);
+    void removeFromIndices(LexicalStem * stem);
+    //! \brief Indexes \a stem once insertStemsIntoDataModel() has stored it, or deletes it if the stems are loaded on demand, since they are then read from the data model when they are needed
+    void finishInsertedStem(LexicalStem * stem);
+
     QSet<LexicalStem*> mStems;
+    /// the stems of mStems by id, except for those without an id (-1)
+    QHash<qlonglong, LexicalStem*> mStemsById;
+    /// for each writing system, the stems that have an allomorph with the given (non-empty) form
+    QHash<WritingSystem, QMultiHash<QString, LexicalStem*> > mFormIndex;
+    /// for each writing system, the length of the longest form in mFormIndex
+    QHash<WritingSystem, int> mLongestIndexedForm;
     QSet<Tag> mTags;
     QList<CreateAllomorphs> mCreateAllomorphs;
+
+    bool mLazyDerivedAllomorphs;
+    bool mHasStemPortmanteaux;
+    /// the stems most recently expanded with their derived allomorphs. The cache is shared by the threads that are parsing, so it is guarded by mExpansionMutex.
+    mutable QMutex mExpansionMutex;
+    mutable QCache<const LexicalStem*, QSharedPointer<const LexicalStem> > mExpansions;
 };
 
 } // namespace ME
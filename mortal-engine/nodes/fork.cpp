@@ -192,7 +192,7 @@ QString Fork::summary(const AbstractNode *doNotFollow) const
 {
     QString dbgString;
     Debug dbg(&dbgString);
-    Debug::atBeginning = false;
+    Debug::setAtBeginning(false);
 
     dbg << "Fork(" << newline;
     dbg.indent();
@@ -215,6 +215,6 @@ QString Fork::summary(const AbstractNode *doNotFollow) const
         dbg << next()->summary( doNotFollow );
     }
 
-    Debug::atBeginning = true;
+    Debug::setAtBeginning(true);
     return dbgString;
 }
@@ -53,7 +53,7 @@ QString Jump::summary(const AbstractNode *doNotFollow) const
 
     QString dbgString;
     Debug dbg(&dbgString);
-    Debug::atBeginning = false;
+    Debug::setAtBeginning(false);
 
     dbg << QObject::tr("Jump(Label: %1, Target ID: %2, Pointer: %3, optional: %4, target node required: %5)")
             .arg(label().toString(),
@@ -62,7 +62,7 @@ QString Jump::summary(const AbstractNode *doNotFollow) const
                 optional() ? "true" : "false",
                 mTargetNodeRequired ? "true" : "false" );
 
-    Debug::atBeginning = true;
+    Debug::setAtBeginning(true);
     return dbgString;
 }
 
@@ -73,12 +73,12 @@ QList<Parsing> Jump::parsingsUsingThisNode(const Parsing &parsing, Parsing::Flag
         Parsing p = parsing;
         p.incrementJumpCounter(this);
         p.setNextNodeRequired( mTargetNodeRequired );
-        parsingLog()->info( QObject::tr("Jumping to: %1").arg( mNodeTarget->debugIdentifier() ) );
+        parsingLog()->deferredInfo( [&]{ return QObject::tr("Jumping to: %1").arg( mNodeTarget->debugIdentifier() ); } );
         return mNodeTarget->possibleParsings( p, flags );
     }
     else
     {
-        parsingLog()->info( QObject::tr("Jump not permitted. To: %1. Number of jumps: %2 out of %3").arg( mNodeTarget->debugIdentifier() ).arg(parsing.jumpCounter(this)).arg(Parsing::MAXIMUM_JUMPS) );
+        parsingLog()->deferredInfo( [&]{ return QObject::tr("Jump not permitted. To: %1. Number of jumps: %2 out of %3").arg( mNodeTarget->debugIdentifier() ).arg(parsing.jumpCounter(this)).arg(Parsing::MAXIMUM_JUMPS); } );
         return QList<Parsing>();
     }
 }
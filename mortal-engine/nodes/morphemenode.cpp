@@ -46,6 +46,8 @@ MorphemeNode *MorphemeNode::copy(MorphologyXmlReader *morphologyReader, const No
 
     /// copy local data
     m->mAllomorphs = mAllomorphs;
+    m->mAllomorphsByInitial = mAllomorphsByInitial;
+    m->mZeroLengthAllomorphs = mZeroLengthAllomorphs;
     m->mCreateAllomorphs = mCreateAllomorphs;
     m->mPortmanteauSequences = mPortmanteauSequences;
 
@@ -56,23 +58,35 @@ MorphemeNode *MorphemeNode::copy(MorphologyXmlReader *morphologyReader, const No
 
 void MorphemeNode::addAllomorph(const Allomorph & allomorph)
 {
+    /// identical allomorphs are indexed once (see rebuildAllomorphIndex)
+    const bool alreadyIndexed = mAllomorphs.contains( allomorph );
     mAllomorphs.append( allomorph );
+    if( !alreadyIndexed )
+    {
+        addToAllomorphIndex( mAllomorphs.count() - 1 );
+    }
 }
 
 QList<Parsing> MorphemeNode::parsingsUsingThisNode(const Parsing &parsing, Parsing::Flags flags) const
 {
     QList<Parsing> candidates;
 
-    QSet<Allomorph> matches = matchingAllomorphs(parsing);
+    const QList<int> matches = matchingAllomorphs(parsing);
 
-    parsingLog()->info( QObject::tr("%1 allomorph matches.").arg(matches.count()) );
+    parsingLog()->deferredInfo( [&]{ return QObject::tr("%1 allomorph matches.").arg(matches.count()); } );
 
-    QSetIterator<Allomorph> matchesIterator( matches );
-    while( matchesIterator.hasNext() )
+    foreach( int index, matches )
     {
-        Allomorph a = matchesIterator.next();
+        const Allomorph & a = mAllomorphs.at(index);
         Parsing p = parsing;
-        p.append( this, a );
+        if( flags & Parsing::ReferenceModelObjects )
+        {
+            p.append( this, &a );
+        }
+        else
+        {
+            p.append( this, a );
+        }
         parsingLog()->parsingStatus(p);
 
         appendIfComplete(candidates, p);
@@ -80,7 +94,7 @@ QList<Parsing> MorphemeNode::parsingsUsingThisNode(const Parsing &parsing, Parsi
 
         if( hasNext(a, p.writingSystem()) && p.isOngoing() )/// there are further morphemes in the model
         {
-            parsingLog()->info( QObject::tr("Appended: %1").arg( a.oneLineSummary() ) );
+            parsingLog()->deferredInfo( [&]{ return QObject::tr("Appended: %1").arg( a.oneLineSummary() ); } );
             candidates.append( next(a, p.writingSystem())->possibleParsings( p, flags ) );
             MAYBE_RETURN_EARLY
         }
@@ -101,7 +115,7 @@ QList<Generation> MorphemeNode::generateFormsUsingThisNode(const Generation &gen
     /// test whether this node fits the morpheme sequence constraint
     if( ! generation.ableToAppend(label()) )
     {
-        parsingLog()->info("Current node does not match the morpheme sequence constraint.");
+        parsingLog()->deferredInfo( []{ return QString("Current node does not match the morpheme sequence constraint."); } );
         return candidates;
     }
 
@@ -224,24 +238,48 @@ QList<Generation> MorphemeNode::generateFormsWithAllomorphs(const Generation &ge
     return candidates;
 }
 
-QSet<Allomorph> MorphemeNode::matchingAllomorphs(const Parsing &parsing) const
+QList<int> MorphemeNode::matchingAllomorphs(const Parsing &parsing) const
 {
-    QSet<Allomorph> matches;
+    QList<int> matches;
 
-    /// check all allomorphs
-    QListIterator<Allomorph> i(mAllomorphs);
-    while( i.hasNext() )
+    /// only allomorphs beginning with the next character, or zero-length allomorphs, can match;
+    /// the two lists are checked where they are, rather than being copied into one
+    const WritingSystem ws = parsing.writingSystem();
+    QHash<WritingSystem, QList<int> >::const_iterator zeroLength = mZeroLengthAllomorphs.constFind( ws );
+    if( zeroLength != mZeroLengthAllomorphs.constEnd() )
     {
-        Allomorph a = i.next();
-        if( parsing.allomorphMatches(a) )
+        appendMatchingAllomorphs( parsing, zeroLength.value(), matches );
+    }
+
+    const QString text = parsing.form().text();
+    if( parsing.position() < text.length() )
+    {
+        QHash<WritingSystem, QHash<QChar, QList<int> > >::const_iterator byInitial = mAllomorphsByInitial.constFind( ws );
+        if( byInitial != mAllomorphsByInitial.constEnd() )
         {
-            matches << a;
+            QHash<QChar, QList<int> >::const_iterator initial = byInitial.value().constFind( text.at( parsing.position() ) );
+            if( initial != byInitial.value().constEnd() )
+            {
+                appendMatchingAllomorphs( parsing, initial.value(), matches );
+            }
         }
     }
 
     return matches;
 }
 
+void MorphemeNode::appendMatchingAllomorphs(const Parsing &parsing, const QList<int> &candidates, QList<int> &matches) const
+{
+    for(int i=0; i < candidates.count(); i++)
+    {
+        const int index = candidates.at(i);
+        if( parsing.allomorphMatches( mAllomorphs.at(index), true, statisticsCounters() ) )
+        {
+            matches << index;
+        }
+    }
+}
+
 void MorphemeNode::matchingAllomorphs(const Generation &generation, QSet<Allomorph> &portmanteaux, QSet<Allomorph> &nonPortmanteau) const
 {
     /// check all allomorphs
@@ -345,11 +383,21 @@ void MorphemeNode::initializePortmanteaux()
     }
 }
 
+bool MorphemeNode::hasPortmanteaux() const
+{
+    return !mPortmanteauSequences.isEmpty();
+}
+
 void MorphemeNode::addCreateAllomorphs(const CreateAllomorphs &ca)
 {
     mCreateAllomorphs << ca;
 }
 
+QList<CreateAllomorphs> MorphemeNode::createAllomorphs() const
+{
+    return mCreateAllomorphs;
+}
+
 void MorphemeNode::generateAllomorphs()
 {
     for(int i=0; i < mCreateAllomorphs.count(); i++ )
@@ -361,6 +409,47 @@ void MorphemeNode::generateAllomorphs()
         }
         mAllomorphs = newAllomorphs.values();
     }
+    /// this is called after constraint pointers have been filled in
+    for(int i=0; i < mAllomorphs.count(); i++ )
+    {
+        mAllomorphs[i].partitionConstraints();
+    }
+    rebuildAllomorphIndex();
+}
+
+void MorphemeNode::rebuildAllomorphIndex()
+{
+    mAllomorphsByInitial.clear();
+    mZeroLengthAllomorphs.clear();
+
+    /// identical allomorphs are indexed once, since a parsing should only be produced once for them
+    QSet<Allomorph> indexed;
+    for(int i=0; i < mAllomorphs.count(); i++ )
+    {
+        if( ! indexed.contains( mAllomorphs.at(i) ) )
+        {
+            indexed << mAllomorphs.at(i);
+            addToAllomorphIndex(i);
+        }
+    }
+}
+
+void MorphemeNode::addToAllomorphIndex(int index)
+{
+    QHashIterator<WritingSystem, Form> fi( mAllomorphs.at(index).forms() );
+    while( fi.hasNext() )
+    {
+        fi.next();
+        const QString text = fi.value().text();
+        if( text.isEmpty() )
+        {
+            mZeroLengthAllomorphs[ fi.key() ] << index;
+        }
+        else
+        {
+            mAllomorphsByInitial[ fi.key() ][ text.at(0) ] << index;
+        }
+    }
 }
 
 void MorphemeNode::filterOutPortmanteauClashes(QList<Parsing> &candidates, const WritingSystem & ws) const
@@ -382,7 +471,7 @@ QString MorphemeNode::summaryWithoutFollowing() const
 {
     QString dbgString;
     Debug dbg(&dbgString);
-    Debug::atBeginning = false;
+    Debug::setAtBeginning(false);
 
     dbg << "MorphemeNode(" << newline;
     dbg.indent();
@@ -404,7 +493,7 @@ QString MorphemeNode::summaryWithoutFollowing() const
     dbg.unindent();
     dbg << ")" << newline;
 
-    Debug::atBeginning = true;
+    Debug::setAtBeginning(true);
 
     return dbgString;
 }
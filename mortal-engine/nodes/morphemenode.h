@@ -9,7 +9,7 @@
 
 namespace ME {
 
-class MorphemeNode : public AbstractNode
+class MORTAL_ENGINE_EXPORT MorphemeNode : public AbstractNode
 {
 public:
     explicit MorphemeNode(const MorphologicalModel * model);
@@ -34,7 +34,8 @@ public:
 
     QList<Generation> generateFormsWithAllomorphs(const Generation & generation, QSet<Allomorph> &potentialAllomorphs) const;
 
-    QSet<Allomorph> matchingAllomorphs( const Parsing & parsing ) const;
+    //! \brief Returns the indices (in allomorphs()) of the allomorphs that match \a parsing
+    QList<int> matchingAllomorphs( const Parsing & parsing ) const;
     void matchingAllomorphs(const Generation &generation, QSet<Allomorph> &portmanteau, QSet<Allomorph> &nonPortmanteau ) const;
 
     static QString elementName();
@@ -42,8 +43,11 @@ public:
     static bool matchesElement(QXmlStreamReader &in);
 
     void initializePortmanteaux();
+    //! \brief Returns true if any allomorph of the node is a portmanteau. Call this after initializePortmanteaux().
+    bool hasPortmanteaux() const;
 
     void addCreateAllomorphs( const CreateAllomorphs & ca );
+    QList<CreateAllomorphs> createAllomorphs() const;
     void generateAllomorphs();
 
     QList<Allomorph> allomorphs() const;
@@ -71,7 +75,16 @@ private:
     void filterOutPortmanteauClashes(QList<Parsing> &candidates, const WritingSystem &ws) const;
     QList<Generation> generateFormsUsingThisNode( const Generation & parsing) const override;
 
+    void rebuildAllomorphIndex();
+    void addToAllomorphIndex(int index);
+    //! \brief Appends to \a matches those of the allomorphs at \a candidates (indices into mAllomorphs) that match \a parsing
+    void appendMatchingAllomorphs(const Parsing & parsing, const QList<int> & candidates, QList<int> & matches) const;
+
     QList<Allomorph> mAllomorphs;
+    /// indices into mAllomorphs, by writing system and by the first character of the form
+    QHash<WritingSystem, QHash<QChar, QList<int> > > mAllomorphsByInitial;
+    /// indices into mAllomorphs of allomorphs with a zero-length form, by writing system
+    QHash<WritingSystem, QList<int> > mZeroLengthAllomorphs;
     QList<CreateAllomorphs> mCreateAllomorphs;
     QMultiHash<WritingSystem, MorphemeSequence> mPortmanteauSequences;
 };
@@ -77,7 +77,7 @@ QString MorphologicalModel::summary(const AbstractNode *doNotFollow) const
 {
     QString dbgString;
     Debug dbg(&dbgString);
-    Debug::atBeginning = false;
+    Debug::setAtBeginning(false);
 
     dbg << QString("MorphologicalModel[%1] (").arg(label().toString()) << Debug::endl << Debug::endl;
     dbg.indent();
@@ -93,7 +93,7 @@ QString MorphologicalModel::summary(const AbstractNode *doNotFollow) const
     dbg.unindent();
     dbg << ")" << newline;
 
-    Debug::atBeginning = true;
+    Debug::setAtBeginning(true);
 
     return dbgString;
 }
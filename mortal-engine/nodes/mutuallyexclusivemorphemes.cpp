@@ -210,7 +210,7 @@ QString MutuallyExclusiveMorphemes::summary(const AbstractNode *doNotFollow) con
 {
     QString dbgString;
     Debug dbg(&dbgString);
-    Debug::atBeginning = false;
+    Debug::setAtBeginning(false);
 
     dbg << "MutuallyExclusiveMorphemes(" << newline;
     dbg.indent();
@@ -236,7 +236,7 @@ QString MutuallyExclusiveMorphemes::summary(const AbstractNode *doNotFollow) con
         dbg << next()->summary(doNotFollow);
     }
 
-    Debug::atBeginning = true;
+    Debug::setAtBeginning(true);
 
     return dbgString;
 }
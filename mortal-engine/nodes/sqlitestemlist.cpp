@@ -10,6 +10,8 @@
 #include "morphologyxmlreader.h"
 #include <QXmlStreamReader>
 #include <QtDebug>
+#include <QFileInfo>
+#include <QDateTime>
 
 using namespace ME;
 
@@ -29,6 +31,7 @@ AbstractNode *SqliteStemList::readFromXml(QXmlStreamReader &in, MorphologyXmlRea
     Q_ASSERT( in.isStartElement() );
     SqliteStemList* sl = new SqliteStemList(model);
     sl->readInitialNodeAttributes(in, morphologyReader);
+    sl->readStemListAttributes(in);
 
     if( in.attributes().value("accepts-stems").toString() == "true" )
         morphologyReader->recordStemAcceptingNewStems( sl );
@@ -42,6 +45,13 @@ AbstractNode *SqliteStemList::readFromXml(QXmlStreamReader &in, MorphologyXmlRea
         sl->setReadGlosses(false);
     }
 
+    if( in.attributes().value("load-on-demand").toString() == "true" )
+    {
+        bool ok = false;
+        const int cacheSize = in.attributes().value("cache-size").toString().toInt(&ok);
+        sl->setLoadOnDemand( true, ok && cacheSize > 0 ? cacheSize : AbstractSqlStemList::DEFAULT_CACHE_SIZE );
+    }
+
     morphologyReader->recordStemList( sl );
 
     while(!in.atEnd() && !(in.tokenType() == QXmlStreamReader::EndElement && in.name() == elementName() ) )
@@ -52,7 +62,18 @@ AbstractNode *SqliteStemList::readFromXml(QXmlStreamReader &in, MorphologyXmlRea
         {
             if( in.name() == AbstractStemList::XML_FILENAME )
             {
-                sl->setConnectionString( in.readElementText() );
+                const QString filename = in.readElementText();
+                /// an open connection is reused, so stem lists that read different files need differently named connections
+                if( filename == ":memory:" )
+                {
+                    /// every connection to :memory: is a database of its own, so each list gets its own connection
+                    sl->setDbName( QString("%1:memory:0x%2").arg( AbstractSqlStemList::DEFAULT_DBNAME ).arg( reinterpret_cast<quintptr>(sl), QT_POINTER_SIZE * 2, 16, QChar('0') ) );
+                }
+                else
+                {
+                    sl->setDbName( QString("%1:%2").arg( AbstractSqlStemList::DEFAULT_DBNAME, QFileInfo(filename).absoluteFilePath() ) );
+                }
+                sl->setConnectionString( filename );
             }
             else if( in.name() == XML_EXTERNAL_DATABASE )
             {
@@ -77,7 +98,7 @@ AbstractNode *SqliteStemList::readFromXml(QXmlStreamReader &in, MorphologyXmlRea
         }
     }
 
-    sl->readStems( morphologyReader->morphology()->writingSystems() );
+    morphologyReader->readStems( sl );
 
     Q_ASSERT( in.isEndElement() && in.name() == elementName() );
     return sl;
@@ -88,6 +109,31 @@ bool SqliteStemList::matchesElement(QXmlStreamReader &in)
     return in.isStartElement() && in.name() == elementName();
 }
 
+QByteArray SqliteStemList::sourceFingerprint() const
+{
+    /// there is nothing to store if the stems are loaded on demand
+    if( loadsStemsOnDemand() )
+    {
+        return QByteArray();
+    }
+
+    const QString filename = QSqlDatabase::database(mDbName, false).databaseName();
+    if( filename.isEmpty() || filename == ":memory:" )
+    {
+        return QByteArray();
+    }
+
+    QStringList settings;
+    settings << tableStems() << ( mReadGlosses ? "glosses" : "no-glosses" );
+    /// changes can sit in the write-ahead log without touching the database file
+    const QFileInfo wal( filename + "-wal" );
+    if( wal.exists() )
+    {
+        settings << QString::number( wal.size() ) << QString::number( wal.lastModified().toMSecsSinceEpoch() );
+    }
+    return fingerprintForFile( elementName(), filename, settings );
+}
+
 void SqliteStemList::openDatabase(const QString &connectionString, const QString &databaseName) const
 {
     SqliteStemList::openSqliteDatabase(connectionString, databaseName);
@@ -143,49 +189,6 @@ void SqliteStemList::cloneSqliteDatabase(const QString &databaseName, const QStr
     }
 }
 
-QString SqliteStemList::qSelectStemIds() const
-{
-    return "SELECT DISTINCT _id, liftGuid from " + tableStems() + ";";
-}
-
-QString SqliteStemList::qSelectStemIdsWithTags(const QString &taglist) const
-{
-    return "SELECT DISTINCT stem_id, liftGuid from " + tableTagMembers() + " LEFT JOIN " + tableTags() + ", " + tableAllomorphs() + "," + tableStems() + " ON " + tableTags() + "._id=" + tableTagMembers() + ".tag_id AND " + tableAllomorphs() + "._id=" + tableTagMembers() + ".allomorph_id AND " + tableStems() + "._id=" + tableAllomorphs() + ".stem_id WHERE Label IN ("+taglist+");";
-}
-
-QString SqliteStemList::qSelectStemsSingleQuery() const
-{
-    return "SELECT stem_id, liftGuid," + tableAllomorphs() + "._id AS allomorph_id,use_in_generations,Form,writingsystem,group_concat(label),portmanteau "
-                                                             "FROM " + tableStems() + ", " + tableAllomorphs() + ", " + tableForms() + ", " + tableTags() + ", " + tableTagMembers() + " "
-                                                                                                                             "ON "
-                                                                                                                             "" + tableStems() + "._id=" + tableAllomorphs() + ".stem_id "
-                                                          "AND " + tableAllomorphs() + "._id=" + tableForms() + ".allomorph_id "
-                                                          "AND " + tableTags() + "._id=" + tableTagMembers() + ".tag_id "
-                                                         "AND " + tableTagMembers() + ".allomorph_id=" + tableForms() + ".allomorph_id "
-                                                                   "GROUP BY " + tableForms() + "._id "
-           + "ORDER BY "
-           + tableAllomorphs() + ".stem_id ASC,  "
-           + tableAllomorphs() + "._id ASC, "
-           + tableForms() + "._id ASC;";
-}
-
-QString SqliteStemList::qSelectStemsSingleQueryWithTags(const QString &taglist) const
-{
-    return "SELECT stem_id, liftGuid,allomorphs._id AS allomorph_id,use_in_generations,Form,writingsystem,group_concat(label),portmanteau "
-           "FROM " + tableStems() + ", " + tableAllomorphs() + ", " + tableForms() + ", " +  tableTags()  + ", " + tableTagMembers() + " "
-                                                                                                                                     "ON "
-                                                                                                                                     "" + tableStems() + "._id=" + tableAllomorphs() + ".stem_id "
-                                                          "AND " + tableAllomorphs() + "._id=" + tableForms() + ".allomorph_id "
-                                                          "AND " + tableTags() + "._id=" + tableTagMembers() + ".tag_id "
-                                                         "AND " + tableTagMembers() + ".allomorph_id=" + tableForms() + ".allomorph_id "
-                                                                   "WHERE " + tableTagMembers() + ".allomorph_id IN (SELECT allomorph_id FROM " + tableTagMembers() + " WHERE tag_id IN ( " + taglist + " ) ) "
-                                                                                                                                       "GROUP BY " + tableForms() + "._id "
-           + "ORDER BY "
-           + tableAllomorphs() + ".stem_id ASC,  "
-           + tableAllomorphs() + "._id ASC, "
-           + tableForms() + "._id ASC;";
-}
-
 QString SqliteStemList::qDeleteFromTagMembers() const
 {
     return "DELETE from " + tableTagMembers() + " WHERE allomorph_id IN (SELECT _id FROM " + tableAllomorphs() + " WHERE stem_id=?);";
@@ -211,26 +214,6 @@ QString SqliteStemList::qDeleteFromStems() const
     return "DELETE FROM " + tableStems() + " WHERE _id=?;";
 }
 
-QString SqliteStemList::qSelectAllomorphsFromStemId() const
-{
-    return "SELECT _id,use_in_generations,portmanteau FROM " + tableAllomorphs() + " WHERE stem_id=?;";
-}
-
-QString SqliteStemList::qSelectGlossesFromStemId() const
-{
-    return "SELECT Form, WritingSystem FROM " + tableGlosses() + " WHERE stem_id=?;";
-}
-
-QString SqliteStemList::qSelectFormsFromAllomorphId() const
-{
-    return "SELECT form, writingsystem FROM " + tableForms() + " WHERE allomorph_id=?;";
-}
-
-QString SqliteStemList::qSelectTagLabelsFromAllomorphId() const
-{
-    return "SELECT label from " + tableTagMembers() + " LEFT JOIN Tags ON " + tableTags() + "._id=" + tableTagMembers() + ".tag_id WHERE allomorph_id=?;";
-}
-
 QString SqliteStemList::qInsertStem() const
 {
     return "INSERT INTO " + tableStems() + " (_id, liftGuid) VALUES (null, ?);";
@@ -330,3 +313,35 @@ QString SqliteStemList::qCreateTagsIdx2() const
 {
     return "CREATE INDEX IF NOT EXISTS tagIdxTwo ON " + tableTagMembers() + " (tag_id);";
 }
+
+bool SqliteStemList::supportsLoadOnDemand() const
+{
+    return true;
+}
+
+QString SqliteStemList::qSelectStemIdsFromForms(const QString &taglist, int formCount) const
+{
+    QStringList placeholders;
+    for(int i=0; i < formCount; i++)
+    {
+        placeholders << "?";
+    }
+    const QString conditions = qStemConditions("A.stem_id", taglist, QString());
+    return "SELECT DISTINCT A.stem_id, F.Form "
+           "FROM " + tableForms() + " AS F "
+           "INNER JOIN " + tableAllomorphs() + " AS A ON A._id=F.allomorph_id "
+           "WHERE F.WritingSystem=? AND F.Form IN (" + placeholders.join(",") + ")"
+           + ( conditions.isEmpty() ? QString() : " AND " + conditions ) + ";";
+}
+
+QString SqliteStemList::qSelectLongestForm() const
+{
+    /// this is the length in UTF-8 bytes, which is never less than the length of the QString
+    return "SELECT MAX(LENGTH(CAST(Form AS BLOB))) FROM " + tableForms() + " WHERE WritingSystem=?;";
+}
+
+QString SqliteStemList::qCreateFormsTextIdx() const
+{
+    /// index names are shared by the whole database, so this one includes the table prefix
+    return "CREATE INDEX IF NOT EXISTS " + tableForms() + "TextIdx ON " + tableForms() + " (WritingSystem, Form);";
+}
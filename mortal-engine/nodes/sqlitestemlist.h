@@ -22,10 +22,7 @@ public:
     static AbstractNode *readFromXml(QXmlStreamReader &in, MorphologyXmlReader * morphologyReader, const MorphologicalModel * model);
     static bool matchesElement(QXmlStreamReader &in);
 
-    QString qSelectStemIds() const override;
-    QString qSelectStemIdsWithTags(const QString & taglist) const override;
-    QString qSelectStemsSingleQuery() const override;
-    QString qSelectStemsSingleQueryWithTags(const QString & taglist) const override;
+    QByteArray sourceFingerprint() const override;
 
     QString qDeleteFromTagMembers() const override;
     QString qDeleteFromForms() const override;
@@ -33,12 +30,6 @@ public:
     QString qDeleteFromAllomorphs() const override;
     QString qDeleteFromStems() const override;
 
-    QString qSelectAllomorphsFromStemId() const override;
-    QString qSelectGlossesFromStemId() const override;
-
-    QString qSelectFormsFromAllomorphId() const override;
-    QString qSelectTagLabelsFromAllomorphId() const override;
-
     QString qInsertStem() const override;
     QString qReplaceStem() const override;
     QString qInsertAllomorph() const override;
@@ -62,6 +53,11 @@ public:
     QString qCreateTagsIdx1() const override;
     QString qCreateTagsIdx2() const override;
 
+    bool supportsLoadOnDemand() const override;
+    QString qSelectStemIdsFromForms(const QString & taglist, int formCount) const override;
+    QString qSelectLongestForm() const override;
+    QString qCreateFormsTextIdx() const override;
+
 protected:
     void openDatabase(const QString & connectionString, const QString & databaseName) const override;
     void cloneDatabase(const QString & databaseName, const QString & newConnectionName) const override;
@@ -91,6 +91,7 @@ AbstractNode *SqlServerStemList::readFromXml(QXmlStreamReader &in, MorphologyXml
 
     SqlServerStemList* sl = new SqlServerStemList(model);
     sl->readInitialNodeAttributes(in, morphologyReader);
+    sl->readStemListAttributes(in);
 
     if( in.attributes().value("accepts-stems").toString() == "true" )
         morphologyReader->recordStemAcceptingNewStems( sl );
@@ -139,7 +140,7 @@ AbstractNode *SqlServerStemList::readFromXml(QXmlStreamReader &in, MorphologyXml
         }
     }
 
-    sl->readStems( morphologyReader->morphology()->writingSystems() );
+    morphologyReader->readStems( sl );
 
     Q_ASSERT( in.isEndElement() && in.name() == elementName() );
     return sl;
@@ -220,11 +221,6 @@ QString SqlServerStemList::qCreateTagsIdx2() const
     return "IF NOT EXISTS(SELECT * FROM sys.indexes WHERE name = 'tagIdxTwo' AND object_id = OBJECT_ID('" + tableTagMembers() + "')) BEGIN CREATE INDEX tagIdxTwo ON " + tableTagMembers() + " (tag_id) END;";
 }
 
-QString SqlServerStemList::qSelectStemIdsWithTags(const QString &taglist) const
-{
-    return "SELECT DISTINCT stem_id, liftGuid from " + tableTagMembers() + " LEFT JOIN " + tableTags() + " ON " + tableTags() + "._id=" + tableTagMembers() + ".tag_id LEFT JOIN " + tableAllomorphs() + " ON " + tableAllomorphs() + "._id=" + tableTagMembers() + ".allomorph_id LEFT JOIN " + tableStems() + " ON " + tableStems() + "._id=" + tableAllomorphs() + ".stem_id WHERE Label IN ("+taglist+");";
-}
-
 QString SqlServerStemList::qInsertStem() const
 {
     return "INSERT INTO " + tableStems() + " (liftGuid) VALUES (?);";
@@ -237,59 +233,6 @@ QString SqlServerStemList::qReplaceStem() const
 
 /// DEBUG BEGIN UNTESTED METHODS
 
-QString SqlServerStemList::qSelectStemIds() const
-{
-    return "SELECT DISTINCT _id, liftGuid from " + tableStems() + ";";
-}
-
-QString SqlServerStemList::qSelectStemsSingleQuery() const
-{
-    return "SELECT stem_id, liftGuid, " + tableAllomorphs() + "._id AS allomorph_id, use_in_generations, Form, writingsystem, STRING_AGG(label, ','), portmanteau "
-              "FROM " + tableStems() +
-              " INNER JOIN " + tableAllomorphs() + " ON " + tableStems() + "._id = " + tableAllomorphs() + ".stem_id "
-                                 "INNER JOIN " + tableForms() + " ON " + tableAllomorphs() + "._id = " + tableForms() + ".allomorph_id "
-                 "INNER JOIN " + tableTagMembers() + " ON " + tableTagMembers() + ".allomorph_id = " + tableForms() + ".allomorph_id "
-                 "INNER JOIN " + tableTags() + " ON " + tableTags() + "._id = " + tableTagMembers() + ".tag_id "
-                 "GROUP BY " + tableAllomorphs() + ".stem_id, "
-                   + tableStems() + ".liftGuid, "
-                   + tableAllomorphs() + "._id, "
-                   + tableAllomorphs() + ".use_in_generations, "
-                   + tableForms() + "._id, "
-                   + tableForms() + ".Form, "
-                   + tableForms() + ".writingsystem, "
-           + tableAllomorphs() + ".portmanteau;";
-}
-
-QString SqlServerStemList::qSelectStemsSingleQueryWithTags(const QString &taglist) const
-{
-    return "SELECT stem_id, liftGuid," + tableAllomorphs() + "._id AS allomorph_id,use_in_generations,Form,writingsystem,STRING_AGG(label, ','),portmanteau "
-           "FROM  "
-           + tableStems() + " "
-           "INNER JOIN  "
-           + tableAllomorphs() + " ON " + tableStems() + "._id = " + tableAllomorphs() + ".stem_id "
-           "INNER JOIN  "
-           + tableForms() + " ON " + tableAllomorphs() + "._id = " + tableForms() + ".allomorph_id "
-           "INNER JOIN  "
-           + tableTagMembers() + " ON " + tableTagMembers() + ".allomorph_id = " + tableForms() + ".allomorph_id "
-           "INNER JOIN  "
-           + tableTags() + " ON " + tableTags() + "._id = " + tableTagMembers() + ".tag_id "
-           "WHERE  "
-           + tableTagMembers() + ".allomorph_id IN (SELECT allomorph_id FROM " + tableTagMembers() + " WHERE tag_id IN ( " + taglist + " )) "
-           "GROUP BY  "
-           + tableAllomorphs() + ".stem_id,  "
-           + tableStems() + ".liftGuid, "
-           + tableAllomorphs() + "._id, "
-           + tableAllomorphs() + ".use_in_generations, "
-           + tableForms() + "._id, "
-           + tableForms() + ".Form, "
-           + tableForms() + ".writingsystem, "
-           + tableAllomorphs() + ".portmanteau "
-           + "ORDER BY "
-           + tableAllomorphs() + ".stem_id ASC,  "
-           + tableAllomorphs() + "._id ASC, "
-           + tableForms() + "._id ASC;";
-}
-
 QString SqlServerStemList::qDeleteFromTagMembers() const
 {
     return "DELETE from " + tableTagMembers() + " WHERE allomorph_id IN (SELECT _id FROM " + tableAllomorphs() + " WHERE stem_id=?);";
@@ -315,26 +258,6 @@ QString SqlServerStemList::qDeleteFromStems() const
     return "DELETE FROM " + tableStems() + " WHERE _id=?;";
 }
 
-QString SqlServerStemList::qSelectAllomorphsFromStemId() const
-{
-    return "SELECT _id,use_in_generations,portmanteau FROM " + tableAllomorphs() + " WHERE stem_id=?;";
-}
-
-QString SqlServerStemList::qSelectGlossesFromStemId() const
-{
-    return "SELECT Form, WritingSystem FROM " + tableGlosses() + " WHERE stem_id=?;";
-}
-
-QString SqlServerStemList::qSelectFormsFromAllomorphId() const
-{
-    return "SELECT form, writingsystem FROM " + tableForms() + " WHERE allomorph_id=?;";
-}
-
-QString SqlServerStemList::qSelectTagLabelsFromAllomorphId() const
-{
-    return "SELECT label from " + tableTagMembers() + " LEFT JOIN " + tableTags() + " ON " + tableTags() + "._id=" + tableTagMembers() + ".tag_id WHERE allomorph_id=?;";
-}
-
 QString SqlServerStemList::qInsertAllomorph() const
 {
     return "INSERT INTO " + tableAllomorphs() + " (stem_id,use_in_generations,portmanteau) VALUES (?,?,?);";
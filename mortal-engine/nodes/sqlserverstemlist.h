@@ -25,23 +25,12 @@ protected:
     void openDatabase(const QString & connectionString, const QString & databaseName) const override;
     void cloneDatabase(const QString & databaseName, const QString & newConnectionName) const override;
 
-    QString qSelectStemIds() const override;
-    QString qSelectStemIdsWithTags(const QString & taglist) const override;
-    QString qSelectStemsSingleQuery() const override;
-    QString qSelectStemsSingleQueryWithTags(const QString & taglist) const override;
-
     QString qDeleteFromTagMembers() const override;
     QString qDeleteFromForms() const override;
     QString qDeleteFromGlosses() const override;
     QString qDeleteFromAllomorphs() const override;
     QString qDeleteFromStems() const override;
 
-    QString qSelectAllomorphsFromStemId() const override;
-    QString qSelectGlossesFromStemId() const override;
-
-    QString qSelectFormsFromAllomorphId() const override;
-    QString qSelectTagLabelsFromAllomorphId() const override;
-
     QString qInsertStem() const override;
     QString qReplaceStem() const override;
     QString qInsertAllomorph() const override;
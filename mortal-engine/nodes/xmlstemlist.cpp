@@ -105,6 +105,11 @@ void XmlStemList::readStems(const QHash<QString, WritingSystem> &writingSystems)
     }
 }
 
+QByteArray XmlStemList::sourceFingerprint() const
+{
+    return fingerprintForFile( elementName(), mFilename );
+}
+
 QString XmlStemList::elementName()
 {
     return "stem-list";
@@ -115,6 +120,7 @@ AbstractNode *XmlStemList::readFromXml(QXmlStreamReader &in, MorphologyXmlReader
     Q_ASSERT( in.isStartElement() );
     XmlStemList * node = new XmlStemList(model);
     node->readInitialNodeAttributes(in, morphologyReader);
+    node->readStemListAttributes(in);
 
     if( in.attributes().value("accepts-stems").toString() == "true" )
         morphologyReader->recordStemAcceptingNewStems(node);
@@ -144,7 +150,7 @@ AbstractNode *XmlStemList::readFromXml(QXmlStreamReader &in, MorphologyXmlReader
         }
     }
 
-    node->readStems( morphologyReader->morphology()->writingSystems() );
+    morphologyReader->readStems( node );
 
     Q_ASSERT( in.isEndElement() && in.name() == elementName() );
     return node;
@@ -157,11 +163,22 @@ bool XmlStemList::matchesElement(QXmlStreamReader &in)
 
 void XmlStemList::insertStemIntoDataModel(LexicalStem *stem)
 {
-    stem->generateAllomorphs(mCreateAllomorphs);
+    generateDerivedAllomorphs( stem );
     mStems.insert( stem );
     qWarning() << "An XML stem list does not save new stems added to the model.";
 }
 
+bool XmlStemList::insertStemsIntoDataModel(const QList<LexicalStem *> &stems)
+{
+    foreach( LexicalStem * stem, stems )
+    {
+        generateDerivedAllomorphs( stem );
+        mStems.insert( stem );
+    }
+    qWarning() << "An XML stem list does not save new stems added to the model." << stems.count() << "stem(s) were added in memory.";
+    return true;
+}
+
 void XmlStemList::removeStemFromDataModel(qlonglong id)
 {
     QSetIterator<LexicalStem*> i(mStems);
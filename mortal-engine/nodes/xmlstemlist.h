@@ -9,7 +9,7 @@ namespace ME {
 
 class WritingSystem;
 
-class XmlStemList : public AbstractStemList
+class MORTAL_ENGINE_EXPORT XmlStemList : public AbstractStemList
 {
 public:
     explicit XmlStemList(const MorphologicalModel * model);
@@ -17,6 +17,7 @@ public:
     void setFilename(const QString &filename);
 
     void readStems( const QHash<QString,WritingSystem> &writingSystems ) override;
+    QByteArray sourceFingerprint() const override;
 
     static QString elementName();
     static AbstractNode *readFromXml(QXmlStreamReader &in, MorphologyXmlReader * morphologyReader, const MorphologicalModel * model);
@@ -24,6 +25,8 @@ public:
 
 private:
     void insertStemIntoDataModel( LexicalStem * stem ) override;
+    //! \brief Inserts the stems as insertStemIntoDataModel() does, with one warning for the whole batch
+    bool insertStemsIntoDataModel( const QList<LexicalStem*> & stems ) override;
     void removeStemFromDataModel( qlonglong id ) override;
 
     QString mFilename;
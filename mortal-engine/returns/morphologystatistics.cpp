@@ -0,0 +1,96 @@
+#include "morphologystatistics.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+
+using namespace ME;
+
+MorphologyStatistics::MorphologyStatistics()
+{
+
+}
+
+void MorphologyStatistics::addNode(const QString &identifier, const HotPathCounters &counters)
+{
+    mNodes << Entry{ identifier, counters };
+}
+
+void MorphologyStatistics::addConstraint(const QString &identifier, const HotPathCounters &counters)
+{
+    mConstraints << Entry{ identifier, counters };
+}
+
+QList<MorphologyStatistics::Entry> MorphologyStatistics::nodes() const
+{
+    QList<Entry> entries = mNodes;
+    sortByTime( entries );
+    return entries;
+}
+
+QList<MorphologyStatistics::Entry> MorphologyStatistics::constraints() const
+{
+    QList<Entry> entries = mConstraints;
+    sortByTime( entries );
+    return entries;
+}
+
+bool MorphologyStatistics::isEmpty() const
+{
+    return mNodes.isEmpty() && mConstraints.isEmpty();
+}
+
+QString MorphologyStatistics::summary() const
+{
+    if( isEmpty() )
+    {
+        return QObject::tr("No statistics were collected.");
+    }
+
+    QList<HotPathCounters::Counter> nodeColumns;
+    nodeColumns << HotPathCounters::Visits << HotPathCounters::AllomorphsTested << HotPathCounters::SegmentalMatches << HotPathCounters::ConditionRejections << HotPathCounters::CandidatesProduced;
+
+    QList<HotPathCounters::Counter> constraintColumns;
+    constraintColumns << HotPathCounters::Visits << HotPathCounters::ConditionRejections;
+
+    return table( QObject::tr("Nodes"), nodes(), nodeColumns ) + "\n" + table( QObject::tr("Constraints"), constraints(), constraintColumns );
+}
+
+void MorphologyStatistics::sortByTime(QList<Entry> &entries)
+{
+    std::stable_sort( entries.begin(), entries.end(), [](const Entry & a, const Entry & b) {
+        return a.counters.value(HotPathCounters::Nanoseconds) > b.counters.value(HotPathCounters::Nanoseconds);
+    });
+}
+
+QString MorphologyStatistics::table(const QString &heading, const QList<Entry> &entries, const QList<HotPathCounters::Counter> &columns)
+{
+    QString string;
+    QTextStream out(&string);
+
+    out << heading << "\n";
+
+    QStringList header;
+    header << "ms";
+    foreach( HotPathCounters::Counter c, columns )
+    {
+        header << HotPathCounters::counterName(c);
+    }
+    header << "id";
+    out << header.join("\t") << "\n";
+
+    foreach( Entry e, entries )
+    {
+        QStringList row;
+        row << QString::number( e.counters.value(HotPathCounters::Nanoseconds) / 1000000.0, 'f', 3 );
+        foreach( HotPathCounters::Counter c, columns )
+        {
+            row << QString::number( e.counters.value(c) );
+        }
+        row << e.identifier;
+        out << row.join("\t") << "\n";
+    }
+
+    return string;
+}
@@ -0,0 +1,55 @@
+/*!
+  \class MorphologyStatistics
+  \brief The HotPathCounters of the nodes and constraints of a model, as returned by Morphology::statistics(). Nodes and constraints that were not used are left out.
+*/
+
+#ifndef MORPHOLOGYSTATISTICS_H
+#define MORPHOLOGYSTATISTICS_H
+
+#include <QList>
+#include <QString>
+
+#include "datatypes/hotpathcounters.h"
+#include "mortal-engine_global.h"
+
+namespace ME {
+
+class MORTAL_ENGINE_EXPORT MorphologyStatistics
+{
+public:
+    struct Entry
+    {
+        QString identifier;
+        HotPathCounters counters;
+    };
+
+    MorphologyStatistics();
+
+    void addNode( const QString & identifier, const HotPathCounters & counters );
+    void addConstraint( const QString & identifier, const HotPathCounters & counters );
+
+    //! \brief Returns the counters of each node that was visited, with the most time-consuming first
+    QList<Entry> nodes() const;
+    //! \brief Returns the counters of each constraint that was evaluated, with the most time-consuming first
+    QList<Entry> constraints() const;
+
+    bool isEmpty() const;
+
+    /**
+     * @brief Returns a table of the counters, for printing.
+     *
+     * @return QString The table.
+     */
+    QString summary() const;
+
+private:
+    static void sortByTime( QList<Entry> & entries );
+    static QString table( const QString & heading, const QList<Entry> & entries, const QList<HotPathCounters::Counter> & columns );
+
+    QList<Entry> mNodes;
+    QList<Entry> mConstraints;
+};
+
+} // namespace ME
+
+#endif // MORPHOLOGYSTATISTICS_H